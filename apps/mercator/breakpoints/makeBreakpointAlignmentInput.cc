@@ -29,8 +29,10 @@
 #include "bio/alphabet/Nucleotide.hh"
 #include "util/options.hh"
 #include "util/string.hh"
+#include "util/thread.hh"
 #include "boost/unordered_set.hpp"
 #include "boost/unordered_map.hpp"
+#include "boost/shared_ptr.hpp"
 #include "filesystem.hh"
 using namespace bio;
 using namespace bio::genome;
@@ -56,7 +58,7 @@ struct Edge {
 
 typedef unordered_map<size_t, Segment> SegmentMap;
 typedef std::vector<Edge> EdgeList;
-typedef unordered_map<std::string, SDB::DB> Genomes;
+typedef unordered_map<std::string, boost::shared_ptr<SDB::SharedDB> > Genomes;
 
 std::istream& operator>>(std::istream& stream, Segment& s) {
 	size_t num;
@@ -99,19 +101,27 @@ void openGenomes(Genomes& genomes, SegmentMap& segments, const Path& mapDir) {
 		 seg != segments.end(); ++seg) {
 		std::string genome = seg->second.genome;
 		if (genomes.find(genome) == genomes.end()) {
-			SDB::DB& db = genomes[genome];
-			db.open(mapDir / (genome + ".sdb"));
-			db.readIndex();
+			boost::shared_ptr<SDB::SharedDB> db(new SDB::SharedDB);
+			genomes[genome] = db;
+			db->open(mapDir / (genome + ".sdb"), true);
 		}
 	}
 }
 
-std::string getSeq(Segment& s,
+const Segment& getSegment(const SegmentMap& segments, size_t num) {
+	SegmentMap::const_iterator it = segments.find(num);
+	if (it == segments.end()) {
+		throw std::runtime_error("Unknown segment number: " + toString(num));
+	}
+	return it->second;
+}
+
+std::string getSeq(const Segment& s,
 				   Strand strand,
-				   SDB::DB& db) {
+				   const Genomes& genomes) {
 	BasicInterval interval(s.interval);
 	interval.setStrand(strand);
-	return db.getSeq(interval);
+	return genomes.find(s.genome)->second->getSeq(interval);
 }
 
 std::string underscoresToSpaces(const std::string& s) {
@@ -120,39 +130,56 @@ std::string underscoresToSpaces(const std::string& s) {
 	return str;
 }
 
-void makeEdgeFiles(Edge& e,
-				   SegmentMap& segments,
-				   Genomes& genomes,
-				   phylogenetic::Tree* tree,
+// Write a FASTA record to SOFTMASKEDSTREAM and its hard-masked version
+// to HARDMASKEDSTREAM, masking one line at a time
+void writeRecord(const std::string& title,
+				 const std::string& seq,
+				 std::ostream& softmaskedStream,
+				 std::ostream& hardmaskedStream) {
+	const size_t lineWidth = fasta::Constants::DEFAULT_LINE_WIDTH;
+
+	softmaskedStream << fasta::Constants::TITLE_LINE_PREFIX << title << '\n';
+	hardmaskedStream << fasta::Constants::TITLE_LINE_PREFIX << title << '\n';
+
+	std::vector<char> line(lineWidth + 1);
+	for (size_t start = 0; start < seq.size(); start += lineWidth) {
+		size_t n = std::min(lineWidth, seq.size() - start);
+		softmaskedStream.write(seq.data() + start, n);
+		softmaskedStream << '\n';
+		for (size_t i = 0; i < n; ++i) {
+			line[i] = bio::alphabet::Nucleotide::hardMask(seq[start + i]);
+		}
+		line[n] = '\n';
+		hardmaskedStream.write(&line[0], n + 1);
+	}
+}
+
+void makeEdgeFiles(const Edge& e,
+				   const SegmentMap& segments,
+				   const Genomes& genomes,
+				   const phylogenetic::Tree* tree,
 				   std::ostream& softmaskedStream,
 				   std::ostream& hardmaskedStream,
 				   std::ostream& treeStream) {
 	const std::string SEQ1_TITLE = "seq1";
 	const std::string SEQ2_TITLE = "seq2";
 
-	fasta::OutputStream softFASTAStream(softmaskedStream);
-	fasta::OutputStream hardFASTAStream(hardmaskedStream);
+	const Segment& seg1 = getSegment(segments, e.segNum1);
+	const Segment& seg2 = getSegment(segments, e.segNum2);
 
-	Segment& seg1 = segments[e.segNum1];
-	Segment& seg2 = segments[e.segNum2];
-
-	fasta::Record
-		rec1(SEQ1_TITLE, getSeq(seg1, e.strand1, genomes[seg1.genome])),
-		rec2(SEQ2_TITLE, getSeq(seg2, e.strand2, genomes[seg2.genome]));
-	
 	// Write sequence files
-	softFASTAStream << rec1 << rec2;
-
-	bio::alphabet::Nucleotide::hardMaskInPlace(rec1.sequence);
-	bio::alphabet::Nucleotide::hardMaskInPlace(rec2.sequence);
-	hardFASTAStream << rec1 << rec2;
+	writeRecord(SEQ1_TITLE, getSeq(seg1, e.strand1, genomes),
+				softmaskedStream, hardmaskedStream);
+	writeRecord(SEQ2_TITLE, getSeq(seg2, e.strand2, genomes),
+				softmaskedStream, hardmaskedStream);
 	
 	// Write tree file
 	unordered_set<std::string> includedGenomes;
 	includedGenomes.insert(underscoresToSpaces(seg1.genome));
 	includedGenomes.insert(underscoresToSpaces(seg2.genome));
 	phylogenetic::Tree* subtree = tree->getSubtree(includedGenomes);
-	if (subtree->getNumDescendants() != 2) {
+	if (subtree == NULL or subtree->getNumDescendants() != 2) {
+		delete subtree;
 		throw std::runtime_error("Tree does not contain genomes: " +
 								 seg1.genome + " and/or " + seg2.genome);
 	}
@@ -162,6 +189,59 @@ void makeEdgeFiles(Edge& e,
 	delete subtree;
 }
 
+// Output file names and inputs shared by all edges
+struct EdgeContext {
+	Path outDir;
+	std::string softmaskedName;
+	std::string hardmaskedName;
+	std::string treeName;
+	const EdgeList* edges;
+	const SegmentMap* segments;
+	const Genomes* genomes;
+	const phylogenetic::Tree* tree;
+};
+
+// Creates the files for edges handed out by a counter until none are
+// left
+class EdgeTask : public util::thread::Task {
+public:
+	EdgeTask(const EdgeContext& context, util::thread::Counter& counter)
+		: context(context), counter(counter) {}
+
+	void run() {
+		try {
+			size_t i;
+			while (counter.next(i)) {
+				makeFiles((*context.edges)[i]);
+			}
+		} catch (...) {
+			// Stop the other threads from starting new edges
+			counter.reset(0);
+			throw;
+		}
+	}
+
+private:
+	void makeFiles(const Edge& e) {
+		// Create directory for this edge
+		Path edgeDir = context.outDir / toString(e.num);
+		if (not edgeDir.exists()) {
+			edgeDir.createDirectory();
+		}
+
+		// Construct output files
+		OutputFileStream softmaskedFile(edgeDir / context.softmaskedName);
+		OutputFileStream hardmaskedFile(edgeDir / context.hardmaskedName);
+		OutputFileStream treeFile(edgeDir / context.treeName);
+
+		makeEdgeFiles(e, *context.segments, *context.genomes, context.tree,
+					  softmaskedFile, hardmaskedFile, treeFile);
+	}
+
+	const EdgeContext& context;
+	util::thread::Counter& counter;
+};
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
@@ -176,6 +256,7 @@ int main(int argc, const char* argv[]) {
 	std::string softmaskedName = "seqs.fasta";
 	std::string hardmaskedName = "seqs.fasta.masked";
 	std::string treeName = "treefile";
+	size_t numThreads = 1;
 
 	// Parse options
 	util::options::Parser parser("",
@@ -205,6 +286,10 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt(0, "segments",
 					   "Segments filename",
 					   segmentFilename);
+	parser.addStoreOpt(0, "threads",
+					   "Number of threads for writing edge files "
+					   "(0 for one per processor)",
+					   numThreads, "NUM");
 	parser.parse(argv, argv + argc);
 
 	try {
@@ -244,23 +329,23 @@ int main(int argc, const char* argv[]) {
 		}
 
 		// Create files for each edge
-		for (size_t i = 0; i < edges.size(); ++i) {
-			Edge& e = edges[i];
+		std::cerr << "Writing edge files...\n";
+		EdgeContext context;
+		context.outDir = outDir;
+		context.softmaskedName = softmaskedName;
+		context.hardmaskedName = hardmaskedName;
+		context.treeName = treeName;
+		context.edges = &edges;
+		context.segments = &segments;
+		context.genomes = &genomes;
+		context.tree = tree;
 
-			// Create directory for this edge
-			Path edgeDir = outDir / toString(e.num);
-			if (not edgeDir.exists()) {
-				edgeDir.createDirectory();
-			}
-			
-			// Construct output files
-			OutputFileStream softmaskedFile(edgeDir / softmaskedName);
-			OutputFileStream hardmaskedFile(edgeDir / hardmaskedName);
-			OutputFileStream treeFile(edgeDir / treeName);
-			
-			makeEdgeFiles(e, segments, genomes, tree,
-						  softmaskedFile, hardmaskedFile, treeFile);
+		util::thread::ThreadPool pool(numThreads);
+		util::thread::Counter counter(edges.size());
+		for (size_t t = 0; t < pool.size(); ++t) {
+			pool.add(new EdgeTask(context, counter));
 		}
+		pool.wait();
 
 	} catch (const std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
@@ -19,102 +19,133 @@
 
 #include <iostream>
 #include <vector>
-#include <ctime>
+#include <algorithm>
+#include <cctype>
 
 #include "bio/formats/fasta.hh"
-#include "util/string.hh"
+#include "bio/kmer/KmerCounter.hh"
 #include "util/options.hh"
+#include "util/thread.hh"
 #include "filesystem.hh"
 using namespace filesystem;
 using namespace bio::formats;
+using bio::kmer::Kmer;
+using bio::kmer::KmerCounter;
 
-#include "boost/random/mersenne_twister.hpp"
-#include "boost/random/uniform_int.hpp"
-#include "boost/random/variate_generator.hpp"
-
-typedef std::vector<uint32_t> CountVector;
-typedef boost::mt19937 base_generator_type;
-typedef boost::uniform_int<> distribution_type;
-typedef boost::variate_generator<base_generator_type&,
-								 distribution_type> variate_generator_type;
-
-base_generator_type generator(std::time(0));
-distribution_type uni_dist(0, 3);
-variate_generator_type uni(generator, uni_dist);
-
-int encode(char c) {
-	c = std::toupper(c);
-	switch (c) {
-	case 'A':
-		return 0;
-	case 'C':
-		return 1;
-	case 'G':
-		return 2;
-	case 'T':
-		return 3;
-	default:
-		return uni();
-	}
-}
+// Sequences are split into chunks of this many bases, which are
+// processed in parallel
+const size_t CHUNK_SIZE = 1 << 20;
+
+// Records are read in batches of about this many bases
+const size_t BATCH_SIZE = 1 << 26;
 
-void count_kmers(const std::string& s, CountVector& v, uint32_t k) {
-	if (s.size() < k) { return; }
-	const uint32_t mask = (1 << (k * 2)) - 1;
-	uint32_t kmer = 0;
-	for (size_t i = 0; i < (k - 1); ++i) {
-		kmer <<= 2;
-		kmer |= encode(s[i]);
+class CountTask : public util::thread::Task {
+public:
+	CountTask(KmerCounter& counter, const std::string& s,
+			  size_t start, size_t end)
+		: counter(counter), s(s), start(start), end(end) {}
+
+	// Counts the k-mers ending in (start, end]
+	void run() {
+		size_t k = counter.getK();
+		counter.add(s, start - std::min(start, k - 1), end);
 	}
-	for (size_t i = (k - 1); i < s.size(); ++i) {
-		kmer <<= 2;
-		kmer &= mask;
-		kmer |= encode(s[i]);
-		++v[kmer];
+
+private:
+	KmerCounter& counter;
+	const std::string& s;
+	size_t start;
+	size_t end;
+};
+
+class MaskTask : public util::thread::Task {
+public:
+	MaskTask(const KmerCounter& counter, uint32_t d,
+			 const std::string& s, std::string& masked,
+			 size_t start, size_t end)
+		: counter(counter), d(d), s(s), masked(masked),
+		  start(start), end(end), masked_end(start) {}
+
+	// Masks the bases in [start, end) of any k-mer that occurs at least
+	// d times
+	void run() {
+		size_t k = counter.getK();
+		counter.scan(s, start - std::min(start, k - 1),
+					 std::min(s.size(), end + k - 1), *this);
 	}
-}
 
-void count_kmers(std::istream& stream, CountVector& v, uint32_t k) {
-	fasta::InputStream fasta_stream(stream);
-	fasta::Record rec;
-	while (fasta_stream >> rec) {
-		count_kmers(rec.sequence, v, k);
+	void operator()(size_t kmer_end, Kmer kmer) {
+		if (counter.getCount(kmer) >= d) {
+			size_t i = std::max(kmer_end - counter.getK(), masked_end);
+			size_t stop = std::min(kmer_end, end);
+			for (; i < stop; ++i) {
+				masked[i] = std::tolower(masked[i]);
+			}
+			masked_end = std::max(masked_end, stop);
+		}
 	}
-}
 
-void mask_seq(std::string& s, size_t start, size_t end) {
-	while (start != end) {
-		s[start] = std::tolower(s[start]);
-		++start;
+private:
+	const KmerCounter& counter;
+	uint32_t d;
+	const std::string& s;
+	std::string& masked;
+	size_t start;
+	size_t end;
+	size_t masked_end;
+};
+
+// Reads records until about BATCH_SIZE bases have been read, returning
+// false if there were none left
+bool read_batch(fasta::InputStream& fasta_stream,
+				std::vector<fasta::Record>& batch) {
+	batch.clear();
+	size_t num_bases = 0;
+	fasta::Record rec;
+	while (num_bases < BATCH_SIZE and fasta_stream >> rec) {
+		num_bases += rec.sequence.size();
+		batch.push_back(rec);
 	}
+	return not batch.empty();
 }
 
-void mask_seq(std::string& s, CountVector& v, uint32_t k, uint32_t d) {
-	if (s.size() < k) { return; }
-	const uint32_t mask = (1 << (k * 2)) - 1;
-	uint32_t kmer = 0;
-	for (size_t i = 0; i < (k - 1); ++i) {
-		kmer <<= 2;
-		kmer |= encode(s[i]);
-	}
-	for (size_t i = (k - 1); i < s.size(); ++i) {
-		kmer <<= 2;
-		kmer &= mask;
-		kmer |= encode(s[i]);
-		if (v[kmer] >= d) {
-			mask_seq(s, i - k + 1, i + 1);
+void count_kmers(std::istream& stream, KmerCounter& counter,
+				 util::thread::ThreadPool& pool) {
+	fasta::InputStream fasta_stream(stream);
+	std::vector<fasta::Record> batch;
+	while (read_batch(fasta_stream, batch)) {
+		for (size_t r = 0; r < batch.size(); ++r) {
+			const std::string& s = batch[r].sequence;
+			for (size_t start = 0; start < s.size(); start += CHUNK_SIZE) {
+				pool.add(new CountTask(counter, s, start,
+									   std::min(s.size(), start + CHUNK_SIZE)));
+			}
 		}
+		pool.wait();
 	}
 }
 
 void mask_stream(std::istream& in_stream, std::ostream& out_stream,
-				 CountVector& v, uint32_t k, uint32_t d) {
+				 const KmerCounter& counter, uint32_t d,
+				 util::thread::ThreadPool& pool) {
 	fasta::InputStream in_fasta_stream(in_stream);
 	fasta::OutputStream out_fasta_stream(out_stream);
-	fasta::Record rec;
-	while (in_fasta_stream >> rec) {
-		mask_seq(rec.sequence, v, k, d);
-		out_fasta_stream << rec;
+	std::vector<fasta::Record> batch;
+	while (read_batch(in_fasta_stream, batch)) {
+		std::vector<std::string> masked(batch.size());
+		for (size_t r = 0; r < batch.size(); ++r) {
+			const std::string& s = batch[r].sequence;
+			masked[r] = s;
+			for (size_t start = 0; start < s.size(); start += CHUNK_SIZE) {
+				pool.add(new MaskTask(counter, d, s, masked[r], start,
+									  std::min(s.size(), start + CHUNK_SIZE)));
+			}
+		}
+		pool.wait();
+		for (size_t r = 0; r < batch.size(); ++r) {
+			batch[r].sequence.swap(masked[r]);
+			out_fasta_stream << batch[r];
+		}
 	}
 }
 
@@ -125,29 +156,45 @@ int main(int argc, const char* argv[]) {
 	// Initialize options to defaults
 	size_t k = 14;
 	size_t d = 20;
+	bool skip_n = false;
+	bool single_strand = false;
+	size_t num_threads = 1;
 	std::string seq_filename;
 
 	// Parse command line
 	util::options::Parser parser("",
 								 "Mask k-mers that are overrepresented. "
 								 "Outputs a softmasked sequence file.");
-	parser.addStoreOpt('k', "", "k-mer size", k);
+	parser.addStoreOpt('k', "", "k-mer size (at most 31)", k);
 	parser.addStoreOpt('d', "",
 					   "k-mers with duplicity greater than this value "
 					   "will be masked", d);
+	parser.addStoreTrueOpt(0, "skip-n",
+						   "ignore k-mers containing bases other than A, C, "
+						   "G and T, instead of replacing those bases",
+						   skip_n);
+	parser.addStoreTrueOpt(0, "single-strand",
+						   "count k-mers and their reverse complements "
+						   "separately",
+						   single_strand);
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for counting and masking "
+					   "(0 for one per processor)",
+					   num_threads, "NUM");
 	parser.addStoreArg("fastaFile", "FASTA file containing sequences",
 					   seq_filename);
 	parser.parse(argv, argv + argc);
 
 	try {
-		CountVector counts(1 << (2 * k), 0);
+		KmerCounter counter(k, not single_strand, skip_n);
+		util::thread::ThreadPool pool(num_threads);
 		{
 			InputFileStream seq_stream(seq_filename);
-			count_kmers(seq_stream, counts, k);
+			count_kmers(seq_stream, counter, pool);
 		}
 		{
 			InputFileStream seq_stream(seq_filename);
-			mask_stream(seq_stream, std::cout, counts, k ,d);
+			mask_stream(seq_stream, std::cout, counter, d, pool);
 		}
 	} catch (const std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
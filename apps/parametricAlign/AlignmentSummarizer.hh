@@ -35,7 +35,9 @@ public:
 	std::string getParam(size_t i) const;
 
 	// Returns the lexicographically minimum optimal summary given
-	// values for the alignment model parameters in VALUES
+	// values for the alignment model parameters in VALUES.  Summaries
+	// keep no state between calls, so getSummary may be called from
+	// several threads at once.
 	std::vector<size_t> getSummary(const std::vector<Score>& values) const;
 
 	std::vector<size_t> getSummary(const PairwiseAlignment& alignment) const;
@@ -59,15 +61,14 @@ private:
 	bool isZeroParam;
 	bool lexMin;
 	bool linearMem;
-	mutable AffineGapNWPairwiseSummarizer<Score> summarizer;
+	AffineGapNWPairwiseSummarizer<Score> summarizer;
 };
 
 template<typename Score>
 std::vector<size_t>
 AlignmentSummarizer<Score>::
 getSummary(const std::vector<Score>& values) const {
-	summarizer.setScores(values);
-	return summarizer.summarize(seq1, seq2, lexMin, linearMem);
+	return summarizer.summarize(values, seq1, seq2, lexMin, linearMem);
 }
 
 template<typename Score>
@@ -75,8 +76,7 @@ std::vector<size_t>
 AlignmentSummarizer<Score>::
 getSummary(const PairwiseAlignment& alignment) const {
 	std::vector<Score> values(getNumParams(), 0);
-	summarizer.setScores(values);
-	return summarizer.summarize(alignment);
+	return summarizer.summarize(values, alignment);
 }
 
 template<typename Score>
@@ -0,0 +1,419 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include "polytope/Polytope.hh"
+#include "math/MaxPlus.hh"
+#include "math/LogDouble.hh"
+#include "bio/alphabet/Nucleotide.hh"
+#include "bio/alignment/DNAScoringMatrix.hh"
+#include "bio/alignment/AffineGapNWPairwiseScorer.hh"
+#include "bio/alignment/NeedlemanWunschPairwiseScorer.hh"
+#include "bio/alignment/SmithWatermanPairwiseScorer.hh"
+#include "bio/alignment/AffineGapNWFastPairwiseAligner.hh"
+#include "bio/alignment/AffineGapNWFastPairwiseAligner2.hh"
+#include "bio/alignment/AffineGapNWFastPairwiseAligner3.hh"
+#include "bio/alignment/PairHMM.hh"
+#include "util/options.hh"
+#include "boost/timer.hpp"
+using namespace polytope;
+using namespace bio::alignment;
+using bio::alphabet::DNA;
+using math::MaxPlus;
+using math::LogDouble;
+
+const std::string DESCRIPTION = 
+"Times the pairwise alignment kernels over the max-plus, log-probability "
+"and polytope semirings.  A random sequence of each given length is "
+"aligned against a mutated copy of its prefix of at most --width bases, "
+"so that long sequences can be timed in reasonable time and memory.  "
+"Polytopes are much slower to compute, so the polytope semiring is "
+"timed once on a shorter pair of sequences.  One tab-separated line is "
+"written to standard output per kernel, semiring and length, giving "
+"the number of DP cells per second.  "
+"Kernels that would take more cells than their limit are skipped.";
+
+// Number of parameters of the polytope semiring: mismatch, space, gap
+const size_t NUM_PARAMS = 3;
+
+// Semiring whose zero and one are fixed for each element type, as
+// needed by the scorers that take the multiplicative identity from a
+// static member
+template<typename Element_>
+class SemiRing {
+public:
+	typedef Element_ Element;
+
+	static const Element zero;
+	static const Element multiplicativeIdentity;
+
+	Element getZero() const { return zero; }
+	Element getMultiplicativeIdentity() const { return multiplicativeIdentity; }
+};
+
+template<>
+const MaxPlus<int> SemiRing< MaxPlus<int> >::zero = MaxPlus<int>().getZero();
+template<>
+const MaxPlus<int> SemiRing< MaxPlus<int> >::multiplicativeIdentity = 0;
+template<>
+const MaxPlus<double>
+SemiRing< MaxPlus<double> >::zero = MaxPlus<double>().getZero();
+template<>
+const MaxPlus<double>
+SemiRing< MaxPlus<double> >::multiplicativeIdentity = 0;
+template<>
+const LogDouble SemiRing<LogDouble>::zero = 0;
+template<>
+const LogDouble SemiRing<LogDouble>::multiplicativeIdentity = 1;
+template<>
+const Polytope<int> SemiRing< Polytope<int> >::zero = Polytope<int>();
+template<>
+const Polytope<int>
+SemiRing< Polytope<int> >::multiplicativeIdentity = Vector<int>(NUM_PARAMS);
+
+// Scores of a semiring for the kernels
+template<typename Element>
+struct Scores {
+	Element match, mismatch, space, gap;
+};
+
+Scores< MaxPlus<int> > getScores(MaxPlus<int>) {
+	Scores< MaxPlus<int> > s = { 2, -1, -1, -3 };
+	return s;
+}
+
+Scores< MaxPlus<double> > getScores(MaxPlus<double>) {
+	Scores< MaxPlus<double> > s = { 2, -1, -1, -3 };
+	return s;
+}
+
+Scores<LogDouble> getScores(LogDouble) {
+	Scores<LogDouble> s = { 0.2, 0.02, 0.05, 0.1 };
+	return s;
+}
+
+Scores< Polytope<int> > getScores(Polytope<int>) {
+	enum PARAMS { MISMATCH, SPACE, GAP };
+	Scores< Polytope<int> > s = {
+		Vector<int>(NUM_PARAMS),
+		Vector<int>::unit(NUM_PARAMS, MISMATCH),
+		Vector<int>::unit(NUM_PARAMS, SPACE),
+		Vector<int>::unit(NUM_PARAMS, GAP)
+	};
+	return s;
+}
+
+// Limits on the number of DP cells of a single run, by kind of kernel
+struct Limits {
+	double linear;		// Scorers that keep a single row
+	double quadratic;	// Aligners that keep the whole matrix
+};
+
+std::string randomSequence(size_t length) {
+	static const char BASES[] = "ACGT";
+	std::string seq(length, 'A');
+	for (size_t i = 0; i < length; ++i) {
+		seq[i] = BASES[std::rand() % 4];
+	}
+	return seq;
+}
+
+// Returns the first LENGTH bases of SEQ, with a fraction DIVERGENCE
+// of them substituted at random
+std::string mutatedPrefix(const std::string& seq,
+						  size_t length,
+						  double divergence) {
+	std::string prefix(seq, 0, length);
+	for (size_t i = 0; i < prefix.size(); ++i) {
+		if (std::rand() < divergence * RAND_MAX) {
+			prefix[i] = "ACGT"[std::rand() % 4];
+		}
+	}
+	return prefix;
+}
+
+void printHeader() {
+	std::cout << "#kernel\tsemiring\tlength1\tlength2\treps\tseconds"
+			  << "\tcells_per_sec\n";
+}
+
+// Runs KERNEL on SEQ1 and SEQ2 until at least MIN_TIME seconds have
+// passed and prints a line of results
+template<typename Kernel>
+void timeKernel(const std::string& kernelName,
+				const std::string& semiRingName,
+				Kernel& kernel,
+				const std::string& seq1,
+				const std::string& seq2,
+				double minTime) {
+	boost::timer timer;
+	size_t reps = 0;
+	double seconds;
+	do {
+		kernel(seq1, seq2);
+		++reps;
+		seconds = timer.elapsed();
+	} while (seconds < minTime);
+
+	double cells = double(seq1.size()) * seq2.size() * reps;
+	std::cout << kernelName << '\t' << semiRingName << '\t'
+			  << seq1.size() << '\t' << seq2.size() << '\t'
+			  << reps << '\t'
+			  << std::fixed << std::setprecision(6) << seconds << '\t'
+			  << std::setprecision(0) << (seconds > 0 ? cells / seconds : 0)
+			  << '\n';
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout.flush();
+}
+
+// Adapters giving all kernels the same call interface
+template<typename Scorer>
+struct ScorerKernel {
+	const Scorer& scorer;
+	ScorerKernel(const Scorer& scorer) : scorer(scorer) {}
+	void operator()(const std::string& seq1, const std::string& seq2) {
+		scorer.score(seq1, seq2);
+	}
+};
+
+template<typename Aligner>
+struct AlignerKernel {
+	const Aligner& aligner;
+	AlignerKernel(const Aligner& aligner) : aligner(aligner) {}
+	void operator()(const std::string& seq1, const std::string& seq2) {
+		aligner.align(seq1, seq2);
+	}
+};
+
+struct PairHMMKernel {
+	PairHMM& hmm;
+	PairHMMKernel(PairHMM& hmm) : hmm(hmm) {}
+	void operator()(const std::string& seq1, const std::string& seq2) {
+		hmm.likelihood(seq1, seq2);
+	}
+};
+
+bool isSelected(const std::vector<std::string>& selected,
+				const std::string& name) {
+	return selected.empty() or
+		std::find(selected.begin(), selected.end(), name) != selected.end();
+}
+
+// Times the semiring-generic scorers over ELEMENT
+template<typename Element>
+void timeScorers(const std::string& semiRingName,
+				 const std::vector<std::string>& kernels,
+				 const std::string& seq1,
+				 const std::string& seq2,
+				 double maxCells,
+				 double minTime) {
+	typedef SemiRing<Element> Ring;
+	if (double(seq1.size()) * seq2.size() > maxCells) {
+		return;
+	}
+
+	Scores<Element> s = getScores(Element());
+	DNAScoringMatrix<Element> matrix(s.match, s.mismatch);
+
+	if (isSelected(kernels, "affine-nw")) {
+		AffineGapNWPairwiseScorer<Ring> scorer(Ring(), matrix, s.space, s.gap);
+		ScorerKernel< AffineGapNWPairwiseScorer<Ring> > kernel(scorer);
+		timeKernel("affine-nw", semiRingName, kernel, seq1, seq2, minTime);
+	}
+	if (isSelected(kernels, "nw")) {
+		NeedlemanWunschPairwiseScorer<Ring> scorer(matrix, s.space);
+		ScorerKernel< NeedlemanWunschPairwiseScorer<Ring> > kernel(scorer);
+		timeKernel("nw", semiRingName, kernel, seq1, seq2, minTime);
+	}
+	if (isSelected(kernels, "sw")) {
+		SmithWatermanPairwiseScorer<Ring> scorer(s.match, s.mismatch, s.space);
+		ScorerKernel< SmithWatermanPairwiseScorer<Ring> > kernel(scorer);
+		timeKernel("sw", semiRingName, kernel, seq1, seq2, minTime);
+	}
+}
+
+// Times the aligners that keep the whole DP matrix of NUMTYPE scores
+template<typename NumType>
+void timeFastAligners(const std::string& semiRingName,
+					  const std::vector<std::string>& kernels,
+					  const std::string& seq1,
+					  const std::string& seq2,
+					  double maxCells,
+					  double minTime) {
+	if (double(seq1.size()) * seq2.size() > maxCells) {
+		return;
+	}
+
+	DNAScoringMatrix<NumType> matrix(2, -1);
+	NumType space = -1, gap = -3;
+
+	if (isSelected(kernels, "fast")) {
+		AffineGapNWFastPairwiseAligner<NumType> aligner(matrix, space, gap);
+		AlignerKernel< AffineGapNWFastPairwiseAligner<NumType> >
+			kernel(aligner);
+		timeKernel("fast", semiRingName, kernel, seq1, seq2, minTime);
+	}
+	if (isSelected(kernels, "fast2")) {
+		AffineGapNWFastPairwiseAligner2<NumType> aligner(matrix, space, gap);
+		AlignerKernel< AffineGapNWFastPairwiseAligner2<NumType> >
+			kernel(aligner);
+		timeKernel("fast2", semiRingName, kernel, seq1, seq2, minTime);
+	}
+	if (isSelected(kernels, "fast3")) {
+		AffineGapNWFastPairwiseAligner3<NumType> aligner(matrix, space, gap);
+		AlignerKernel< AffineGapNWFastPairwiseAligner3<NumType> >
+			kernel(aligner);
+		timeKernel("fast3", semiRingName, kernel, seq1, seq2, minTime);
+	}
+}
+
+void timePairHMM(const std::vector<std::string>& kernels,
+				 const std::string& seq1,
+				 const std::string& seq2,
+				 double maxCells,
+				 double minTime) {
+	if (not isSelected(kernels, "pairhmm") or
+		double(seq1.size()) * seq2.size() > maxCells) {
+		return;
+	}
+
+	const size_t NUM_STATES = 3;
+	PairHMM::ProbMatrix hEmissions(4, 4, 0.02);
+	for (size_t c = 0; c < 4; ++c) {
+		hEmissions(c, c) = 0.19;
+	}
+	PairHMM::ProbVector iEmissions(4, 0.25), dEmissions(4, 0.25);
+	PairHMM::ProbVector beginProbs(NUM_STATES), endProbs(NUM_STATES, 0.01);
+	beginProbs[PairHMM::H_STATE] = 0.9;
+	beginProbs[PairHMM::I_STATE] = beginProbs[PairHMM::D_STATE] = 0.05;
+	PairHMM::ProbMatrix transitions(NUM_STATES, NUM_STATES, 0.04);
+	for (size_t s = 0; s < NUM_STATES; ++s) {
+		transitions(s, s) = 0.91;
+	}
+	PairHMM hmm(hEmissions, iEmissions, dEmissions,
+				beginProbs, endProbs, transitions);
+
+	// The pair HMM indexes its emissions by encoded character
+	const bio::alphabet::Alphabet& alphabet = DNA;
+	PairHMMKernel kernel(hmm);
+	timeKernel("pairhmm", "LogDouble", kernel,
+			   alphabet.encode(seq1), alphabet.encode(seq2), minTime);
+}
+
+int main(int argc, const char* argv[]) {
+	// Set up options and arguments
+	std::vector<size_t> lengths;
+	size_t width = 100;
+	double divergence = 0.1;
+	unsigned int seed = 1;
+	double minTime = 0.5;
+	size_t polytopeLength = 40;
+	Limits limits = { 1e8, 1e7 };
+	std::vector<std::string> kernels;
+	std::vector<std::string> semiRings;
+	
+	// Set up option parser
+	util::options::Parser parser("", DESCRIPTION);
+	parser.addAppendOpt('l', "length",
+						"length of the first sequence (default 1000, "
+						"10000, 100000 and 1000000)",
+						lengths, "LENGTH");
+	parser.addStoreOpt('w', "width", "maximum length of the second sequence",
+					   width, "LENGTH");
+	parser.addStoreOpt(0, "divergence",
+					   "fraction of substituted bases in the second sequence",
+					   divergence, "FRACTION");
+	parser.addStoreOpt(0, "seed", "random number seed", seed, "SEED");
+	parser.addStoreOpt(0, "min-time",
+					   "minimum number of seconds to repeat each kernel for",
+					   minTime, "SECONDS");
+	parser.addStoreOpt(0, "max-cells",
+					   "most cells for the linear-space scorers",
+					   limits.linear, "NUM");
+	parser.addStoreOpt(0, "max-matrix-cells",
+					   "most cells for the aligners that keep the whole matrix",
+					   limits.quadratic, "NUM");
+	parser.addStoreOpt(0, "polytope-length",
+					   "length of both sequences for the polytope semiring",
+					   polytopeLength, "LENGTH");
+	parser.addAppendOpt('k', "kernel",
+						"kernel to time: affine-nw, nw, sw, pairhmm, fast, "
+						"fast2 or fast3 (default all)",
+						kernels, "NAME");
+	parser.addAppendOpt('r', "semiring",
+						"semiring to time: maxplus-int, maxplus-double, "
+						"logdouble or polytope (default all)",
+						semiRings, "NAME");
+	parser.parse(argv, argv + argc);
+
+	try {
+		if (lengths.empty()) {
+			lengths.push_back(1000);
+			lengths.push_back(10000);
+			lengths.push_back(100000);
+			lengths.push_back(1000000);
+		}
+		std::srand(seed);
+
+		printHeader();
+		for (size_t i = 0; i < lengths.size(); ++i) {
+			std::string seq1 = randomSequence(lengths[i]);
+			std::string seq2 = mutatedPrefix(seq1, width, divergence);
+
+			if (isSelected(semiRings, "maxplus-int")) {
+				timeScorers< MaxPlus<int> >("MaxPlus<int>", kernels,
+											seq1, seq2, limits.linear,
+											minTime);
+				timeFastAligners<int>("MaxPlus<int>", kernels,
+									  seq1, seq2, limits.quadratic, minTime);
+			}
+			if (isSelected(semiRings, "maxplus-double")) {
+				timeScorers< MaxPlus<double> >("MaxPlus<double>", kernels,
+											   seq1, seq2, limits.linear,
+											   minTime);
+				timeFastAligners<double>("MaxPlus<double>", kernels,
+										 seq1, seq2, limits.quadratic,
+										 minTime);
+			}
+			if (isSelected(semiRings, "logdouble")) {
+				timeScorers<LogDouble>("LogDouble", kernels,
+									   seq1, seq2, limits.linear, minTime);
+				timePairHMM(kernels, seq1, seq2, limits.linear, minTime);
+			}
+		}
+		if (isSelected(semiRings, "polytope")) {
+			std::string seq1 = randomSequence(polytopeLength);
+			std::string seq2 = mutatedPrefix(seq1, polytopeLength, divergence);
+			timeScorers< Polytope<int> >("Polytope<int>", kernels,
+										 seq1, seq2, limits.linear, minTime);
+		}
+
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
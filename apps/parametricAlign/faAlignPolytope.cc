@@ -60,6 +60,7 @@ int main(int argc, const char* argv[]) {
 	std::string gap = "g";
 	std::string scoringMatrixFilename;
 	std::string qhullLogFile = "qhull.log";
+	size_t numThreads = 1;
 	
 	// Set up option parser
 	util::options::Parser parser("< fastaInput > polymakeOutput",
@@ -73,6 +74,10 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt(0, "qhull-log",
 					   "File for qhull warning/error messages",
 					   qhullLogFile, "FILE");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to fill in the alignment matrix "
+					   "with (0 for one per processor)",
+					   numThreads, "NUM");
 	parser.parse(argv, argv + argc);
 
 	try {
@@ -110,7 +115,8 @@ int main(int argc, const char* argv[]) {
 											  matrix,
 											  varMap[space],
 											  varMap[gap],
-											  numVars);
+											  numVars,
+											  numThreads);
 
 		formats::polymake::OutputStream polymakeOutputStream(std::cout);
 
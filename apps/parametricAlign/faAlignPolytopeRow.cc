@@ -62,6 +62,8 @@ int main(int argc, const char* argv[]) {
 	// Set up options and arguments
 	size_t numParams = 2;
 	std::string qhullLogFile = "qhull.log";
+	size_t numThreads = 1;
+	bool stats = false;
 	
 	// Set up option parser
 	util::options::Parser parser("< fastaInput > polymakeOutput",
@@ -72,6 +74,14 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt(0, "qhull-log",
 					   "File for qhull warning/error messages",
 					   qhullLogFile, "FILE");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to fill in the alignment matrix "
+					   "with (0 for one per processor)",
+					   numThreads, "NUM");
+	parser.addStoreTrueOpt(0, "stats",
+						   "Print statistics on the reduction of point "
+						   "sets to their vertices to stderr",
+						   stats);
 	parser.parse(argv, argv + argc);
 
 	try {
@@ -100,7 +110,8 @@ int main(int argc, const char* argv[]) {
 							   forwardGap2,
 							   backwardMatch,
 							   backwardGap1,
-							   backwardGap2);
+							   backwardGap2,
+							   numThreads);
 		outputPolytopeRow(forwardMatch, "fh");
 		outputPolytopeRow(forwardGap1, "fd");
 		outputPolytopeRow(forwardGap2, "fi");
@@ -108,6 +119,15 @@ int main(int argc, const char* argv[]) {
 		outputPolytopeRow(backwardGap1, "bd");
 		outputPolytopeRow(backwardGap2, "bi");
 
+		if (stats) {
+			Polytope<int>::ReductionStats s = Polytope<int>::getReductionStats();
+			std::cerr << "Reductions: " << s.numReductions << '\n'
+					  << "Points before reduction: " << s.pointsIn << '\n'
+					  << "Points after reduction: " << s.pointsOut << '\n'
+					  << "Peak points: " << s.peakNumPoints << '\n'
+					  << "Hull time (s): " << s.hullTime << '\n';
+		}
+
 	} catch (const std::exception& e) {
 		std::cerr << "Error: " << e.what() << '\n';
 		return EXIT_FAILURE;
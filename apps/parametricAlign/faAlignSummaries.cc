@@ -0,0 +1,301 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+
+#include "util/string.hh"
+#include "util/options.hh"
+#include "util/thread.hh"
+#include "util/timer.hh"
+#include "filesystem.hh"
+#include "bio/formats/fasta.hh"
+#include "bio/alignment/DNAScoringMatrix.hh"
+#include "boost/lexical_cast.hpp"
+
+#include "AlignmentSummarizer.hh"
+
+using bio::alphabet::DNA;
+using namespace bio::alignment;
+using namespace bio::formats::fasta;
+using namespace filesystem;
+
+typedef int Score;
+typedef std::vector<Score> Point;
+typedef std::vector<size_t> Summary;
+
+const std::string DESCRIPTION =
+	"Computes optimal alignment summaries of two sequences at many "
+	"parameter points, given either in a file (one point per line) or as "
+	"a grid with one MIN:MAX:STEP range per parameter.  Points that are "
+	"positive multiples of each other have the same optimal alignments, "
+	"so each is only aligned once.  Summaries are output in the order of "
+	"the points, and statistics including the throughput are written to "
+	"standard error.";
+
+// Check to make sure the sequence in REC contains only DNA characters
+void checkSeq(const bio::formats::fasta::Record& rec) {
+	if (!bio::alphabet::DNA.isOn(rec.sequence)) {
+		throw std::runtime_error("Sequence has characters other than "
+								 "A, T, C, G: " + rec.title);
+	}
+}				   
+
+// Returns P divided by the greatest common divisor of its entries
+Point reduce(const Point& p) {
+	Score d = 0;
+	for (size_t i = 0; i < p.size(); ++i) {
+		Score a = std::abs(p[i]);
+		while (a != 0) {
+			Score r = d % a;
+			d = a;
+			a = r;
+		}
+	}
+	if (d <= 1) {
+		return p;
+	}
+	Point reduced(p);
+	for (size_t i = 0; i < reduced.size(); ++i) {
+		reduced[i] /= d;
+	}
+	return reduced;
+}
+
+void readPoints(std::istream& strm, size_t numParams,
+				std::vector<Point>& points) {
+	Point p(numParams);
+	while (true) {
+		for (size_t i = 0; i < numParams; ++i) {
+			if (not (strm >> p[i])) {
+				if (i == 0 and strm.eof()) {
+					return;
+				}
+				throw std::runtime_error("Invalid or incomplete point in "
+										 "points file");
+			}
+		}
+		points.push_back(p);
+	}
+}
+
+// Adds the points of the grid given by RANGES, one MIN:MAX:STEP range
+// per parameter, to POINTS.  A single range is used for every parameter.
+void makeGrid(const std::vector<std::string>& ranges, size_t numParams,
+			  std::vector<Point>& points) {
+	if (ranges.size() != 1 and ranges.size() != numParams) {
+		throw std::runtime_error("Need one grid range, or one for each of the "
+								 + util::string::toString(numParams)
+								 + " parameters");
+	}
+
+	Point mins, maxs, steps;
+	for (size_t i = 0; i < numParams; ++i) {
+		const std::string& range = ranges[ranges.size() == 1 ? 0 : i];
+		std::vector<std::string> fields;
+		util::string::split(range, std::back_inserter(fields), ":");
+		try {
+			if (fields.size() != 3) { throw boost::bad_lexical_cast(); }
+			mins.push_back(boost::lexical_cast<Score>(fields[0]));
+			maxs.push_back(boost::lexical_cast<Score>(fields[1]));
+			steps.push_back(boost::lexical_cast<Score>(fields[2]));
+		} catch (const boost::bad_lexical_cast&) {
+			throw std::runtime_error("Invalid grid range: " + range);
+		}
+		if (steps.back() <= 0 or maxs.back() < mins.back()) {
+			throw std::runtime_error("Invalid grid range: " + range);
+		}
+	}
+
+	// Step through the grid like an odometer, last parameter fastest
+	Point p(mins);
+	while (true) {
+		points.push_back(p);
+		size_t i = numParams;
+		while (i > 0) {
+			--i;
+			p[i] += steps[i];
+			if (p[i] <= maxs[i]) { break; }
+			p[i] = mins[i];
+			if (i == 0) { return; }
+		}
+		if (numParams == 0) { return; }
+	}
+}
+
+class SummaryTask : public util::thread::Task {
+public:
+	SummaryTask(const AlignmentSummarizer<Score>& summarizer,
+				const Point& point,
+				Summary& summary)
+		: summarizer(summarizer), point(point), summary(summary) {
+	}
+
+	void run() { summary = summarizer.getSummary(point); }
+
+private:
+	const AlignmentSummarizer<Score>& summarizer;
+	Point point;
+	Summary& summary;
+};
+
+int main(int argc, const char* argv[]) {
+	// Increase speed of input/output to standard streams
+	std::ios::sync_with_stdio(false);
+
+	// Initialize options to defaults
+	std::string match = "0";
+	std::string mismatch = "x";
+	std::string space = "s";
+	std::string gap = "g";
+	std::string scoringMatrixFilename;
+	std::string pointsFilename;
+	std::vector<std::string> gridRanges;
+	bool lexMin = false;
+	bool linearMem = false;
+	size_t maxMem = 500;
+	size_t numThreads = 1;
+
+	// Parse command line
+	util::options::Parser parser("< fastaInput", DESCRIPTION);
+	parser.addStoreTrueOpt(0, "lex-min", "Give lexicographically minimum summary", lexMin);
+	parser.addStoreTrueOpt(0, "linear-mem", "Use linear space alignment algorithm", linearMem);
+	parser.addStoreOpt(0, "max-mem", "Maximum memory (MB) to use, shared by all threads", maxMem);
+	parser.addStoreOpt('m', "match", "match variable", match, "SYMBOL");
+	parser.addStoreOpt('x', "mismatch", "mismatch variable", mismatch, "SYMBOL");
+	parser.addStoreOpt('s', "space", "space variable", space, "SYMBOL");
+	parser.addStoreOpt('g', "gap", "gap variable", gap, "SYMBOL");
+	parser.addStoreOpt(0, "matrix", "symbolic scoring matrix filename",
+					   scoringMatrixFilename, "FILENAME");
+	parser.addStoreOpt('p', "points",
+					   "file of parameter points, with values in "
+					   "alphabetical order of the parameter names",
+					   pointsFilename, "FILENAME");
+	parser.addAppendOpt(0, "grid",
+						"range of a parameter for a grid of points, given "
+						"once for all parameters or once per parameter in "
+						"alphabetical order",
+						gridRanges, "MIN:MAX:STEP");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for computing summaries "
+					   "(0 for one per processor)",
+					   numThreads, "NUM");
+	parser.parse(argv, argv + argc);
+
+	try {
+		if (pointsFilename.empty() == gridRanges.empty()) {
+			throw std::runtime_error("Give either a points file or a grid");
+		}
+
+		// Construct FASTA stream for fast reading
+		InputStream fastaStream(std::cin);
+
+		// Get first two records
+		Record rec1, rec2;
+		fastaStream >> rec1 >> rec2;
+		if (not fastaStream) {
+			throw std::runtime_error("Alignment requires two FASTA records");
+		}
+
+		// Check to make sure sequences only contain A, T, C, G
+		checkSeq(rec1.sequence);
+		checkSeq(rec2.sequence);
+		
+		DNAScoringMatrix<std::string> paramMatrix;
+		if (not scoringMatrixFilename.empty()) {
+			InputFileStream scoringMatrixFile(scoringMatrixFilename);
+			paramMatrix.readMatrix(scoringMatrixFile);
+		} else {
+			paramMatrix.setMatchScore(match);
+			paramMatrix.setMismatchScore(mismatch);
+		}
+
+		// Each thread fills its own matrix, so the memory limit is split
+		// between them
+		util::thread::ThreadPool pool(numThreads);
+		AlignmentSummarizer<Score> summarizer(rec1.sequence, rec2.sequence,
+											  paramMatrix, space, gap,
+											  lexMin, linearMem,
+											  (maxMem << 20) / pool.size());
+		const size_t numParams = summarizer.getNumParams();
+
+		std::vector<Point> points;
+		if (not pointsFilename.empty()) {
+			InputFileStream pointsFile(pointsFilename);
+			readPoints(pointsFile, numParams, points);
+		} else {
+			makeGrid(gridRanges, numParams, points);
+		}
+
+		// Only align once for each distinct reduced point
+		std::map<Point, size_t> reducedIndices;
+		std::vector<Point> reducedPoints;
+		std::vector<size_t> pointIndices;
+		for (size_t i = 0; i < points.size(); ++i) {
+			Point r = reduce(points[i]);
+			std::pair<std::map<Point, size_t>::iterator, bool> inserted =
+				reducedIndices.insert(std::make_pair(r, reducedPoints.size()));
+			if (inserted.second) {
+				reducedPoints.push_back(r);
+			}
+			pointIndices.push_back(inserted.first->second);
+		}
+
+		util::WallTimer timer;
+		std::vector<Summary> summaries(reducedPoints.size());
+		for (size_t i = 0; i < reducedPoints.size(); ++i) {
+			pool.add(new SummaryTask(summarizer, reducedPoints[i],
+									 summaries[i]));
+		}
+		pool.wait();
+		double elapsed = timer.elapsed();
+
+		for (size_t i = 0; i < points.size(); ++i) {
+			const Summary& s = summaries[pointIndices[i]];
+			std::cout << util::string::join(points[i].begin(),
+											points[i].end(), " ");
+			for (size_t j = 0; j < s.size(); ++j) {
+				std::cout << '\t' << summarizer.getParam(j) << ": " << s[j];
+			}
+			std::cout << '\n';
+		}
+
+		std::map<Summary, size_t> distinctSummaries;
+		for (size_t i = 0; i < summaries.size(); ++i) {
+			++distinctSummaries[summaries[i]];
+		}
+
+		std::cerr << "points\t" << points.size() << '\n'
+				  << "alignments\t" << reducedPoints.size() << '\n'
+				  << "summaries\t" << distinctSummaries.size() << '\n'
+				  << "threads\t" << pool.size() << '\n'
+				  << "time\t" << elapsed << '\n'
+				  << "alignments per second\t"
+				  << (elapsed > 0 ? reducedPoints.size() / elapsed : 0) << '\n';
+
+	} catch (const std::runtime_error& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
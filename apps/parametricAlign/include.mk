@@ -1,10 +1,15 @@
 DIR := apps/parametricAlign
 LOCAL_SRCS := $(wildcard $(DIR)/*.cc)
 LOCAL_HEADERS := $(wildcard $(DIR)/*.hh)
-LOCAL_MAINS := faAlignPolytope lengthEffect vertexAlignments vertexParams faAlignPolytopeRow faAlignSummary faAlignSummarySpeedTest normalFan facetNormals points2polytope minkowskiSum processAlignmentPolytope findMaxIdentityAlignments maxIdentityAlign checkPointsInFacets summarizeAlignment
-LOCAL_BINS := $(foreach bin,$(LOCAL_MAINS),$(DIR)/$(bin)$(E))
+LOCAL_MAINS := faAlignPolytope lengthEffect vertexAlignments vertexParams faAlignPolytopeRow faAlignSummary faAlignSummarySpeedTest normalFan facetNormals points2polytope minkowskiSum processAlignmentPolytope findMaxIdentityAlignments maxIdentityAlign checkPointsInFacets summarizeAlignment polytopeSpeedTest faAlignSummaries alignmentSpeedTest
+# Programs that use only the polytope library, which can be built with
+# the native backend
+LOCAL_NATIVE_MAINS := faAlignPolytope lengthEffect vertexAlignments vertexParams faAlignPolytopeRow faAlignSummary faAlignSummarySpeedTest normalFan facetNormals points2polytope minkowskiSum maxIdentityAlign summarizeAlignment polytopeSpeedTest faAlignSummaries alignmentSpeedTest
 
 DIST_FILES += $(LOCAL_SRCS) $(LOCAL_HEADERS) $(DIR)/include.mk
+
+ifeq ($(POLYTOPE_BACKEND),polymake)
+LOCAL_BINS := $(foreach bin,$(LOCAL_MAINS),$(DIR)/$(bin)$(E))
 $(LOCAL_BINS): $(DIR)/polyalign$(O) \
                $(DIR)/VectorMultiSet$(O) \
                $(DIR)/AnnotatedPolytope$(O)
@@ -19,3 +24,11 @@ $(LOCAL_SRCS:.cc=$(D)): USE_QHULL = 1
 else
 $(warning parametricAlign will not be built because POLYMAKE_PATH environment variable is not set)
 endif
+else
+LOCAL_BINS := $(foreach bin,$(LOCAL_NATIVE_MAINS),$(DIR)/$(bin)$(E))
+$(LOCAL_BINS): $(DIR)/polyalign$(O)
+$(LOCAL_BINS): USE_NATIVE_POLYTOPE = 1
+
+SRCS += $(foreach src,$(LOCAL_NATIVE_MAINS) polyalign,$(DIR)/$(src).cc)
+BINS += $(LOCAL_BINS)
+endif
@@ -18,112 +18,122 @@
 */
 
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-#include "util/options.hh"
+#include "polytope/Polytope.hh"
+#include "polytope/formats/polymake/InputStream.hh"
 #include "util/io/line/InputStream.hh"
-#include "filesystem.hh"
-using namespace filesystem;
-
-#include "AnnotatedPolytope.hh"
+#include "util/options.hh"
+using namespace polytope;
 
-#include <linalg.h>
-#include <Rational.h>
-#include <Matrix.h>
-#include <ListMatrix.h>
-#include <Vector.h>
-#include <Set.h>
-#include <cdd_interface.h>
-#include <ostream_wrapper.h>
+typedef int T;
 
-using polymake::ListMatrix;
-using polymake::Matrix;
-using polymake::Vector;
-using polymake::Set;
-using polymake::convert_to;
-using polymake::wrap;
-using pm::rank;
+// The lines of each section of a polymake file, by section title
+typedef std::map<std::string, std::vector<std::string> > SectionMap;
 
-Rational dot_product(const Vector<Rational>& v1, const Vector<Rational>& v2) {
-	Rational r = 0;
-	for (int i = 0; i < v1.size(); ++i) {
-		r += v1[i] * v2[i];
+void readSections(std::istream& strm, SectionMap& sections) {
+	util::io::line::InputStream lineStream(strm);
+	std::string line;
+	while (lineStream >> line) {
+		if (line.empty() or line[0] == '_') { continue; }
+		std::vector<std::string>& lines = sections[line];
+		while (lineStream >> line and not line.empty()) {
+			lines.push_back(line);
+		}
 	}
-	return r;
 }
 
-Vector<Integer> integerize(const Vector<Rational>& v) {
-	Integer scale = 1;
-	Vector<Integer> iv(v.size());
-	for (int i = 0; i < v.size(); ++i) {
-		scale *= abs(denominator(v[i]));
-	}
-	for (int i = 0; i < v.size(); ++i) {
-		iv[i] = numerator(v[i]) * (scale / denominator(v[i]));
-	}
-	scale = gcd(iv[1], iv[2]);
-	for (int i = 3; i < iv.size(); ++i) {
-		scale = gcd(scale, iv[i]);
+void outputCone(Cone& cone) {
+	for (size_t j = 0; j < cone.getNumFacets(); ++j) {
+		Cone::Facet ineq = cone.getFacet(j);
+		for (size_t k = 0; k < ineq.size(); ++k) {
+			std::cout << ineq[k] << ' ';
+		}
 	}
-	scale = abs(scale);
-	iv /= scale;
-
-	return iv;
+	std::cout << '\n';
 }
 
-Matrix<Integer> getFacetNormals(const Matrix<Integer>& facetNormals,
-								 const Set<int>& indices) {
-	ListMatrix< Vector<Integer> > f;
-	for (Set<int>::const_iterator it = indices.begin();
-		 it != indices.end(); ++it) {
-		f /= facetNormals.row(*it);
+// Outputs the normal fan of a polytope given by its FACET_NORMALS and
+// FACETS_THRU_VERTICES sections, as written by earlier versions of
+// polymake: the cone of each vertex is generated by the normals of the
+// facets through it.
+void outputNormalFan(const std::vector<std::string>& normalLines,
+					 const std::vector<std::string>& facetLines) {
+	Cone::RayList normals;
+	for (size_t i = 0; i < normalLines.size(); ++i) {
+		std::istringstream lineStream(normalLines[i]);
+		std::vector<Integer> coords((std::istream_iterator<Integer>(lineStream)),
+									std::istream_iterator<Integer>());
+		Cone::Ray normal(coords.size());
+		for (size_t j = 0; j < coords.size(); ++j) {
+			normal[j] = coords[j];
+		}
+		normals.push_back(normal);
 	}
-	return f;
-}
 
-Matrix<Rational> computeFacets(const Matrix<Rational>& points) {
-	polymake::polytope::cdd_interface::solver<Rational> solver;
-	return solver.enumerate_facets(points).first;
+	for (size_t i = 0; i < facetLines.size(); ++i) {
+		const std::string& line = facetLines[i];
+		if (line.size() < 2 or line[0] != '{' or line[line.size() - 1] != '}') {
+			throw std::runtime_error("Bad FACETS_THRU_VERTICES line: " + line);
+		}
+		std::istringstream lineStream(line.substr(1, line.size() - 2));
+		Cone::RayList rays;
+		size_t facet;
+		while (lineStream >> facet) {
+			if (facet >= normals.size()) {
+				throw std::runtime_error("Facet index out of range: " + line);
+			}
+			rays.push_back(normals[facet]);
+		}
+		Cone cone(rays);
+		outputCone(cone);
+	}
 }
 
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
 
-	// Set up options and arguments
-
 	// Set up option parser
-	util::options::Parser parser("", "");
+	util::options::Parser parser("< polymakeInput",
+								 "Outputs for each vertex of the input "
+								 "polytope the facet inequalities of its "
+								 "cone in the normal fan, on one line.  "
+								 "The polytope is read from its VERTICES "
+								 "section, or, if it has none, from its "
+								 "FACET_NORMALS and FACETS_THRU_VERTICES "
+								 "sections.");
 	parser.parse(argv, argv + argc);
 
 	try {
-		AnnotatedPolytope polytope;
-		std::cin >> polytope;
-		
-		MatrixSection<Integer>* facetNormalsSection;
-		polytope.getSection("FACET_NORMALS", facetNormalsSection);
-		Matrix<Integer> facetNormals = facetNormalsSection->matrix;
-		
-		SetListSection* facetsThruVerticesSection;
-		polytope.getSection("FACETS_THRU_VERTICES", facetsThruVerticesSection);
-		std::vector< Set<int> > facetsThruVertices = 
-			dynamic_cast<SetListSection*>(facetsThruVerticesSection)->sets;
-		
-		for (size_t i = 0; i < facetsThruVertices.size(); ++i) {
-			Matrix<Integer> rays = getFacetNormals(facetNormals,
-												   facetsThruVertices[i]);
+		// The input is read twice, to find its format and then to parse it
+		std::ostringstream input;
+		input << std::cin.rdbuf();
+		std::istringstream sectionStream(input.str());
+		SectionMap sections;
+		readSections(sectionStream, sections);
 
-			Matrix<Rational> ratRays = convert_to<Rational>(rays);
-			Matrix<Rational> cone = computeFacets(ratRays);
-			
-			for (int j = 0; j < cone.rows(); ++j) {
-				Vector<Rational> ineqRat = cone.row(j);
-				Vector<Integer> ineq = integerize(ineqRat);
-				for (int k = 0; k < ineq.size(); ++k) {
-					std::cout << ineq[k] << ' ';
-				}
-			}
-			
-			std::cout << '\n';
+		if (sections.find("VERTICES") == sections.end() and
+			sections.find("FACET_NORMALS") != sections.end() and
+			sections.find("FACETS_THRU_VERTICES") != sections.end()) {
+			outputNormalFan(sections["FACET_NORMALS"],
+							sections["FACETS_THRU_VERTICES"]);
+			return EXIT_SUCCESS;
+		}
+
+		std::istringstream polytopeStream(input.str());
+		formats::polymake::InputStream polymakeInputStream(polytopeStream);
+		Polytope<T> p;
+		polymakeInputStream >> p;
+
+		Polytope<T>::NormalFan normalFan = p.getNormalFan();
+		for (size_t i = 0; i < normalFan.size(); ++i) {
+			outputCone(normalFan[i]);
 		}
 		
 	} catch (const std::runtime_error& e) {
@@ -23,6 +23,7 @@
 
 #include "bio/alignment/NeedlemanWunschPairwiseScorer.hh"
 #include "bio/alignment/AffineGapNWPairwiseScorer.hh"
+#include "bio/alignment/WavefrontAffineGapNWPairwiseScorer.hh"
 #include "bio/alphabet/Nucleotide.hh"
 #include "bio/alignment/DNAScoringMatrix.hh"
 #include "util/string.hh"
@@ -44,16 +45,28 @@ private:
 	size_t dims;
 };
 
+typedef WavefrontAffineGapNWPairwiseScorer<PolytopeSemiRing> PolytopeScorer;
+
+// The polymake backend shares its solvers between all polytopes, so
+// polytopes may only be computed in several threads with the native one
+static size_t getNumPolytopeThreads(size_t numThreads) {
+#ifdef POLYTOPE_NATIVE
+	return numThreads;
+#else
+	return 1;
+#endif
+}
+
 IntegerPolytope calculatePolytope(const std::string& s1,
 								  const std::string& s2,
 								  PolytopeMatrix& matrix,
 								  IntegerPolytope& space,
 								  IntegerPolytope& gap,
-								  size_t numVars) {
-	typedef PolytopeSemiRing SemiRing;
-	SemiRing semiRing(numVars);
-	AffineGapNWPairwiseScorer<SemiRing>
-		scorer(semiRing, matrix, space, gap);
+								  size_t numVars,
+								  size_t numThreads) {
+	PolytopeSemiRing semiRing(numVars);
+	PolytopeScorer scorer(semiRing, matrix, space, gap,
+						  getNumPolytopeThreads(numThreads));
 	return scorer.score(s1, s2);
 }	
 
@@ -65,7 +78,8 @@ calcMiddleRowPolytopesGlobal4(const std::string& seq1,
 							  PolytopeList& forwardGap2,
 							  PolytopeList& backwardMatch,
 							  PolytopeList& backwardGap1,
-							  PolytopeList& backwardGap2) {
+							  PolytopeList& backwardGap2,
+							  size_t numThreads) {
 	enum PARAMS {MISMATCH, SPACE, GAP, NUM_PARAMS};
 	Polytope<int>
 		match = Vector<int>(NUM_PARAMS),
@@ -73,11 +87,10 @@ calcMiddleRowPolytopesGlobal4(const std::string& seq1,
 		space = Vector<int>::unit(NUM_PARAMS, SPACE),
 		gap = Vector<int>::unit(NUM_PARAMS, GAP);
 
-	typedef PolytopeSemiRing SemiRing;
-	SemiRing semiRing(NUM_PARAMS);
+	PolytopeSemiRing semiRing(NUM_PARAMS);
 	DNAScoringMatrix< Polytope<int> > matrix(match, mismatch);
-	AffineGapNWPairwiseScorer<SemiRing>
-		scorer(semiRing, matrix, space, gap);
+	PolytopeScorer scorer(semiRing, matrix, space, gap,
+						  getNumPolytopeThreads(numThreads));
 	size_t seq1MiddlePos = seq1.size() / 2;
 	std::string seq1Prefix = seq1.substr(0, seq1MiddlePos);
 	std::string seq1Suffix = seq1.substr(seq1MiddlePos);
@@ -101,7 +114,8 @@ calcMiddleRowPolytopesGlobal5(const std::string& seq1,
 							  PolytopeList& forwardGap2,
 							  PolytopeList& backwardMatch,
 							  PolytopeList& backwardGap1,
-							  PolytopeList& backwardGap2) {
+							  PolytopeList& backwardGap2,
+							  size_t numThreads) {
 	enum PARAMS {TRANSITION, TRANSVERSION, SPACE, GAP, NUM_PARAMS};
 	Polytope<int>
 		match = Vector<int>(NUM_PARAMS),
@@ -110,11 +124,10 @@ calcMiddleRowPolytopesGlobal5(const std::string& seq1,
 		space = Vector<int>::unit(NUM_PARAMS, SPACE),
 		gap = Vector<int>::unit(NUM_PARAMS, GAP);
 
-	typedef PolytopeSemiRing SemiRing;
-	SemiRing semiRing(NUM_PARAMS);
+	PolytopeSemiRing semiRing(NUM_PARAMS);
 	DNAScoringMatrix< Polytope<int> > matrix(match, transition, transversion);
-	AffineGapNWPairwiseScorer<SemiRing>
-		scorer(semiRing, matrix, space, gap);
+	PolytopeScorer scorer(semiRing, matrix, space, gap,
+						  getNumPolytopeThreads(numThreads));
 	size_t seq1MiddlePos = seq1.size() / 2;
 	std::string seq1Prefix = seq1.substr(0, seq1MiddlePos);
 	std::string seq1Suffix = seq1.substr(seq1MiddlePos);
@@ -139,7 +152,8 @@ calcMiddleRowPolytopes(const std::string& seq1,
 					   PolytopeList& forwardGap2,
 					   PolytopeList& backwardMatch,
 					   PolytopeList& backwardGap1,
-					   PolytopeList& backwardGap2) {
+					   PolytopeList& backwardGap2,
+					   size_t numThreads) {
 	if (num_params == 4) {
 		return calcMiddleRowPolytopesGlobal4(seq1,
 											 seq2,
@@ -148,7 +162,8 @@ calcMiddleRowPolytopes(const std::string& seq1,
 											 forwardGap2,
 											 backwardMatch,
 											 backwardGap1,
-											 backwardGap2);
+											 backwardGap2,
+											 numThreads);
 	} else if (num_params == 5) {
 		return calcMiddleRowPolytopesGlobal5(seq1,
 											 seq2,
@@ -157,7 +172,8 @@ calcMiddleRowPolytopes(const std::string& seq1,
 											 forwardGap2,
 											 backwardMatch,
 											 backwardGap1,
-											 backwardGap2);
+											 backwardGap2,
+											 numThreads);
 	} else {
 		throw std::runtime_error("Bad number of parameters: " +
 								 toString(num_params));
@@ -252,11 +268,11 @@ setParameters(IntegerMatrix& scoreMatrix, int& spaceScore, int& gapScore,
 	for (size_t i = 0; i < DNA.getSize(); ++i) {
 		for (size_t j = 0; j < DNA.getSize(); ++j) {
 			size_t dim = varDimMap[varMatrix.getScore(i, j)];
-			scoreMatrix.setScore(i, j, paramRay[dim]);
+			scoreMatrix.setScore(i, j, toInt(paramRay[dim]));
 		}
 	}
 
 	// Set gap and space scores
-	spaceScore = paramRay[varDimMap[space]];
-	gapScore = paramRay[varDimMap[gap]];
+	spaceScore = toInt(paramRay[varDimMap[space]]);
+	gapScore = toInt(paramRay[varDimMap[gap]]);
 }
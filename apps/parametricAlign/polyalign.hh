@@ -44,7 +44,8 @@ IntegerPolytope calculatePolytope(const std::string& seq1,
 								  PolytopeMatrix& matrix,
 								  IntegerPolytope& space,
 								  IntegerPolytope& gap,
-								  size_t numVars);
+								  size_t numVars,
+								  size_t numThreads = 1);
 
 void calcMiddleRowPolytopes(const std::string& seq1,
 							const std::string& seq2,
@@ -54,7 +55,8 @@ void calcMiddleRowPolytopes(const std::string& seq1,
 							PolytopeList& forwardGap2,
 							PolytopeList& backwardMatch,
 							PolytopeList& backwardGap1,
-							PolytopeList& backwardGap2);
+							PolytopeList& backwardGap2,
+							size_t numThreads = 1);
 
 extern const std::string ZERO;
 
@@ -0,0 +1,177 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "polytope/Polytope.hh"
+#include "bio/alignment/DNAScoringMatrix.hh"
+#include "util/options.hh"
+#include "util/timer.hh"
+#ifndef POLYTOPE_NATIVE
+// Polymake includes
+#include <Matrix.h>
+#include <lrs_interface.h>
+#include <cdd_interface.h>
+#endif // POLYTOPE_NATIVE
+using namespace polytope;
+using bio::alignment::DNAScoringMatrix;
+
+#include "polyalign.hh"
+
+const std::string DESCRIPTION = 
+"Times the computation of alignment polytopes for random pairs of DNA "
+"sequences, and of their facets and normal fans.  Wall clock timings in "
+"seconds are written to standard error.  With the polymake backend, facet "
+"enumeration by cdd and by lrs on the same vertices is also timed.";
+
+#ifdef POLYTOPE_NATIVE
+const char* BACKEND = "native";
+#else
+const char* BACKEND = "polymake";
+#endif
+
+std::string randomSequence(size_t length) {
+	static const char BASES[] = "ACGT";
+	std::string seq(length, 'A');
+	for (size_t i = 0; i < length; ++i) {
+		seq[i] = BASES[std::rand() % 4];
+	}
+	return seq;
+}
+
+#ifndef POLYTOPE_NATIVE
+// Returns the time taken by the given polymake solver to enumerate the
+// facets of the vertices of p
+template<typename Solver>
+double solverFacetTime(const IntegerPolytope& p, Solver& s) {
+	const IntegerPolytope::VectorList& vertices = p.getVertices();
+	polymake::Matrix<Rational> points(vertices.size(),
+									  p.getAmbientDim() + 1);
+	for (int i = 0; i < points.rows(); ++i) {
+		points(i, 0) = 1;
+		for (int j = 1; j < points.cols(); ++j) {
+			points(i, j) = vertices[i][j - 1];
+		}
+	}
+
+	util::WallTimer timer;
+	s.enumerate_facets(points);
+	return timer.elapsed();
+}
+#endif // POLYTOPE_NATIVE
+
+int main(int argc, const char* argv[]) {
+	// Set up options and arguments
+	size_t length = 40;
+	size_t numPairs = 10;
+	unsigned int seed = 1;
+	std::string match = "0";
+	std::string mismatch = "x";
+	std::string space = "s";
+	std::string gap = "g";
+	std::string qhullLogFile = "qhull.log";
+	size_t numThreads = 1;
+	
+	// Set up option parser
+	util::options::Parser parser("", DESCRIPTION);
+	parser.addStoreOpt('l', "length", "length of random sequences",
+					   length, "LENGTH");
+	parser.addStoreOpt('n', "pairs", "number of sequence pairs",
+					   numPairs, "NUM");
+	parser.addStoreOpt(0, "seed", "random number seed", seed, "SEED");
+	parser.addStoreOpt('m', "match", "match variable", match, "SCORE");
+	parser.addStoreOpt('x', "mismatch", "mismatch variable", mismatch, "SCORE");
+	parser.addStoreOpt('s', "space", "space variable", space, "SCORE");
+	parser.addStoreOpt('g', "gap", "gap variable", gap, "SCORE");
+	parser.addStoreOpt(0, "qhull-log",
+					   "File for qhull warning/error messages",
+					   qhullLogFile, "FILE");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to fill in the alignment matrix "
+					   "with (0 for one per processor)",
+					   numThreads, "NUM");
+	parser.parse(argv, argv + argc);
+
+	try {
+		Polytope<int>::setQhullLogFile(qhullLogFile);
+		std::srand(seed);
+
+		VariableMatrix varMatrix;
+		varMatrix.setMatchScore(match);
+		varMatrix.setMismatchScore(mismatch);
+		VariableSet varSet = makeVariableSet(varMatrix, space, gap);
+		VariablePolytopeMap varMap = makeVariablePolytopeMap(varSet);
+		PolytopeMatrix matrix = makePolytopeMatrix(varMatrix, varMap);
+		size_t numVars = getNumVars(varSet);
+
+		double alignTime = 0, facetTime = 0, fanTime = 0;
+#ifndef POLYTOPE_NATIVE
+		double cddTime = 0, lrsTime = 0;
+		polymake::polytope::cdd_interface::solver<Rational> cdd;
+		polymake::polytope::lrs_interface::solver lrs;
+#endif
+		size_t numVertices = 0, numFacets = 0;
+		util::WallTimer timer;
+		for (size_t i = 0; i < numPairs; ++i) {
+			std::string seq1 = randomSequence(length);
+			std::string seq2 = randomSequence(length);
+
+			timer.restart();
+			IntegerPolytope p = calculatePolytope(seq1, seq2, matrix,
+												  varMap[space], varMap[gap],
+												  numVars, numThreads);
+			alignTime += timer.elapsed();
+			numVertices += p.getVertices().size();
+
+			timer.restart();
+			numFacets += p.getFacets().size();
+			facetTime += timer.elapsed();
+
+#ifndef POLYTOPE_NATIVE
+			// Time each of the polymake solvers on the same vertices
+			cddTime += solverFacetTime(p, cdd);
+			lrsTime += solverFacetTime(p, lrs);
+#endif
+
+			timer.restart();
+			p.getNormalFan();
+			fanTime += timer.elapsed();
+		}
+
+		std::cerr << "backend\t" << BACKEND << '\n'
+				  << "threads\t" << numThreads << '\n'
+				  << "pairs\t" << numPairs << '\n'
+				  << "vertices\t" << numVertices << '\n'
+				  << "facets\t" << numFacets << '\n'
+				  << "align time\t" << alignTime << '\n'
+				  << "facet time\t" << facetTime << '\n'
+				  << "fan time\t" << fanTime << '\n';
+#ifndef POLYTOPE_NATIVE
+		std::cerr << "cdd facet time\t" << cddTime << '\n'
+				  << "lrs facet time\t" << lrsTime << '\n';
+#endif
+
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
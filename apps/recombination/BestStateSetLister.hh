@@ -22,6 +22,10 @@ public:
 							 size_t recombinant,
 							 StateSetList& stateSetList);
 
+	void getBestStateSetList(const ColumnPatterns& patterns,
+							 size_t recombinant,
+							 StateSetList& stateSetList);
+
 	void setScores(Score matchScore,
 				   Score mismatchScore,
 				   Score recombinationScore,
@@ -66,33 +70,40 @@ BestStateSetLister::
 getBestStateSetList(const MultipleAlignment& ma,
 					size_t recombinant,
 					StateSetList& stateSetList) {
+	getBestStateSetList(ColumnPatterns(ma), recombinant, stateSetList);
+}
+
+void
+BestStateSetLister::
+getBestStateSetList(const ColumnPatterns& patterns,
+					size_t recombinant,
+					StateSetList& stateSetList) {
+	const size_t numSeqs = patterns.getNumSeqs();
 	typedef BestStateSetListSemiRing< math::MaxPlus<Score> > SemiRing;
 	typedef SemiRing::Element Element;
 	math::MaxPlus<Score> scoringSemiRing;
-	SemiRing semiRing(scoringSemiRing, ma.getNumSeqs());
-	StateSet emptySet(ma.getNumSeqs());
+	SemiRing semiRing(scoringSemiRing, numSeqs);
+	StateSet emptySet(numSeqs);
 	StateSetList emptySetList(1, emptySet);
 	Element match(matchScore, emptySetList);
 	Element mismatch(mismatchScore, emptySetList);
-	std::vector<Element> initialScores(ma.getNumSeqs(),
+	std::vector<Element> initialScores(numSeqs,
 									   semiRing.getMultiplicativeIdentity());
 	AlphabetScoringMatrix<Element> emissionScores(GAPPED_DNA, match, mismatch);
-	util::Matrix<Element> transitionScores(ma.getNumSeqs(),
-										   ma.getNumSeqs());
-	for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
-		for (size_t j = 0; j < ma.getNumSeqs(); ++j) {
-			StateSet s(ma.getNumSeqs());
-			s.set(j);
-			StateSetList stateSetList(1, s);
-			Score score = (i == j ? norecombinationScore : recombinationScore);
-			transitionScores(i, j) = Element(score, stateSetList);
-		}
+	std::vector<Element> stayScores, switchScores;
+	for (size_t i = 0; i < numSeqs; ++i) {
+		StateSet s(numSeqs);
+		s.set(i);
+		StateSetList stateSetList(1, s);
+		stayScores.push_back(Element(norecombinationScore, stateSetList));
+		switchScores.push_back(Element(recombinationScore, stateSetList));
 	}
 
 	RecombinationScorer<SemiRing>
-		scorer(semiRing, initialScores, emissionScores, transitionScores);
+		scorer(semiRing, initialScores, emissionScores,
+			   stayScores, switchScores);
 
-	Element best = scorer.score(ma, recombinant);
+	Element best = scorer.score(patterns, recombinant);
 	stateSetList = best.stateSetList;
 }
 
@@ -0,0 +1,231 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __FIXEDVECTOR_HH__
+#define __FIXEDVECTOR_HH__
+
+#include <cassert>
+#include <iosfwd>
+
+// A vector of N coordinates stored inline, with the same interface as
+// Vector.  Copies and arithmetic never allocate, which matters for the
+// 2D points created in every cell of the recombination recursions.
+template<typename T, size_t N>
+class FixedVector {
+public:
+	static FixedVector unit(size_t dims, size_t dim);
+
+	// The dimension is fixed; the argument is accepted so that code
+	// written for Vector works unchanged
+	FixedVector(size_t dims = N);
+
+	FixedVector& operator+=(const FixedVector& x);
+	FixedVector& operator+=(const T x);
+	FixedVector& operator-=(const FixedVector& x);
+	FixedVector& operator-=(const T x);
+	FixedVector& operator*=(const FixedVector& x);
+	FixedVector& operator*=(const T x);
+	FixedVector& operator/=(const FixedVector& x);
+	FixedVector& operator/=(const T x);
+
+	FixedVector operator+(const FixedVector& x) const;
+	FixedVector operator+(const T x) const;
+	FixedVector operator-(const FixedVector& x) const;
+	FixedVector operator-(const T x) const;
+	FixedVector operator*(const FixedVector& x) const;
+	FixedVector operator*(const T x) const;
+	FixedVector operator/(const FixedVector& x) const;
+	FixedVector operator/(const T x) const;
+
+	bool operator<(const FixedVector& x) const;
+	bool operator==(const FixedVector& x) const;
+
+	T& operator[](size_t i);
+	const T& operator[](size_t i) const;
+
+	size_t size() const;
+
+	template<typename S, size_t M>
+	friend std::ostream& operator<<(std::ostream& stream,
+									const FixedVector<S, M>& v);
+
+	template<typename S, size_t M>
+	friend std::istream& operator>>(std::istream& stream,
+									FixedVector<S, M>& v);
+	
+protected:
+	T v[N];
+};
+
+template<typename T, size_t N>
+FixedVector<T, N> FixedVector<T, N>::unit(size_t dims, size_t dim) {
+	FixedVector<T, N> v(dims);
+	v[dim] = 1;
+	return v;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N>::FixedVector(size_t dims) {
+	assert(dims == N);
+	for (size_t i = 0; i < N; ++i) { v[i] = 0; }
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator+=(const FixedVector& x) {
+	for (size_t i = 0; i < N; ++i) { v[i] += x.v[i]; }
+	return *this;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator+=(const T x) {
+	for (size_t i = 0; i < N; ++i) { v[i] += x; }
+	return *this;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator-=(const FixedVector& x) {
+	for (size_t i = 0; i < N; ++i) { v[i] -= x.v[i]; }
+	return *this;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator-=(const T x) {
+	for (size_t i = 0; i < N; ++i) { v[i] -= x; }
+	return *this;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator*=(const FixedVector& x) {
+	for (size_t i = 0; i < N; ++i) { v[i] *= x.v[i]; }
+	return *this;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator*=(const T x) {
+	for (size_t i = 0; i < N; ++i) { v[i] *= x; }
+	return *this;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator/=(const FixedVector& x) {
+	for (size_t i = 0; i < N; ++i) { v[i] /= x.v[i]; }
+	return *this;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>& FixedVector<T, N>::operator/=(const T x) {
+	for (size_t i = 0; i < N; ++i) { v[i] /= x; }
+	return *this;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>
+FixedVector<T, N>::operator+(const FixedVector& x) const {
+	return FixedVector<T, N>(*this) += x;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N> FixedVector<T, N>::operator+(const T x) const {
+	return FixedVector<T, N>(*this) += x;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>
+FixedVector<T, N>::operator-(const FixedVector& x) const {
+	return FixedVector<T, N>(*this) -= x;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N> FixedVector<T, N>::operator-(const T x) const {
+	return FixedVector<T, N>(*this) -= x;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>
+FixedVector<T, N>::operator*(const FixedVector& x) const {
+	return FixedVector<T, N>(*this) *= x;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N> FixedVector<T, N>::operator*(const T x) const {
+	return FixedVector<T, N>(*this) *= x;
+}
+
+template<typename T, size_t N>
+inline FixedVector<T, N>
+FixedVector<T, N>::operator/(const FixedVector& x) const {
+	return FixedVector<T, N>(*this) /= x;
+}
+	
+template<typename T, size_t N>
+inline FixedVector<T, N> FixedVector<T, N>::operator/(const T x) const {
+	return FixedVector<T, N>(*this) /= x;
+}
+
+template<typename T, size_t N>
+inline bool
+FixedVector<T, N>::operator<(const FixedVector& x) const {
+	for (size_t i = 0; i < N; ++i) {
+		if (v[i] < x.v[i]) {
+			return true;
+		} else if (x.v[i] < v[i]) {
+			return false;
+		}
+	}
+	return false;
+}
+
+template<typename T, size_t N>
+inline bool
+FixedVector<T, N>::operator==(const FixedVector& x) const {
+	for (size_t i = 0; i < N; ++i) {
+		if (v[i] != x.v[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+	
+template<typename T, size_t N>
+inline T& FixedVector<T, N>::operator[](size_t i) { return v[i]; }
+	
+template<typename T, size_t N>
+inline const T& FixedVector<T, N>::operator[](size_t i) const { return v[i]; }
+
+template<typename T, size_t N>
+inline size_t FixedVector<T, N>::size() const { return N; }
+
+template<typename T, size_t N>
+std::ostream& operator<<(std::ostream& stream, const FixedVector<T, N>& v) {
+	for (size_t i = 0; i < N; ++i) {
+		if (i > 0) { stream << '\t'; }
+		stream << v.v[i];
+	}
+	return stream;
+}
+
+template<typename T, size_t N>
+std::istream& operator>>(std::istream& stream, FixedVector<T, N>& v) {
+	for (size_t i = 0; i < N; ++i) {
+		stream >> v.v[i];
+	}
+	return stream;
+}
+
+#endif // __FIXEDVECTOR_HH__
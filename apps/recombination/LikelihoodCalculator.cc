@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 #include "bio/alignment/AlphabetScoringMatrix.hh"
 
 #include "LikelihoodCalculator.hh"
@@ -8,6 +12,8 @@ const bio::alphabet::Nucleotide
 LikelihoodCalculator::GAPPED_DNA("ACGTNMRWSYKVHDB-",
 								 "TGCANKYWSRMBDHV-");
 
+const size_t LikelihoodCalculator::LANES;
+
 LogDouble LikelihoodCalculator::likelihood(const MultipleAlignment& ma,
 										   size_t recombinant,
 										   double matchProb,
@@ -28,15 +34,128 @@ LogDouble LikelihoodCalculator::likelihood(const MultipleAlignment& ma,
 
 	std::vector<Element> initialScores(N + 1, initial);
 	AlphabetScoringMatrix<Element> emissionScores(GAPPED_DNA, match, mismatch);
-	util::Matrix<Element> transitionScores(N + 1, N + 1);
-	for (int i = 0; i <= N; ++i) {
-		for (int j = 0; j <= N; ++j) {
-			transitionScores(i, j) = i == j ? norecombination : recombination;
-		}
-	}
+	std::vector<Element> stayScores(N + 1, norecombination);
+	std::vector<Element> switchScores(N + 1, recombination);
 
 	RecombinationScorer<SemiRing>
-		scorer(semiRing, initialScores, emissionScores, transitionScores);
+		scorer(semiRing, initialScores, emissionScores,
+			   stayScores, switchScores);
 
 	return scorer.score(ma, recombinant);
 }
+
+void LikelihoodCalculator::rescale(std::vector<double>& forward,
+								   double total[],
+								   double logScale[]) {
+	double sum[LANES];
+	std::fill(sum, sum + LANES, 0.0);
+	for (size_t s = 0; s < forward.size(); s += LANES) {
+		for (size_t k = 0; k < LANES; ++k) {
+			sum[k] += forward[s + k];
+		}
+	}
+
+	double scale[LANES];
+	for (size_t k = 0; k < LANES; ++k) {
+		if (sum[k] > 0) {
+			scale[k] = 1.0 / sum[k];
+			logScale[k] += std::log(sum[k]);
+		} else {
+			// The likelihood is zero: keep the lane at zero from now on
+			scale[k] = 0.0;
+			total[k] = 0.0;
+		}
+	}
+
+	for (size_t s = 0; s < forward.size(); s += LANES) {
+		for (size_t k = 0; k < LANES; ++k) {
+			forward[s + k] *= scale[k];
+		}
+	}
+}
+
+void LikelihoodCalculator::likelihoods(const MultipleAlignment& ma,
+									   size_t recombinant,
+									   const std::vector<double>& matchProbs,
+									   const std::vector<double>&
+									   norecombinationProbs,
+									   std::vector<LogDouble>& likelihoods) {
+	assert(matchProbs.size() == norecombinationProbs.size());
+
+	const size_t numPoints = matchProbs.size();
+	const size_t numCols = ma.getNumCols();
+
+	likelihoods.assign(numPoints, LogDouble(0.0));
+	if (numPoints == 0 or numCols == 0) {
+		return;
+	}
+
+	// Record for each column whether each non-recombinant sequence matches
+	// the recombinant.  This is all that the emissions depend on.
+	std::vector<size_t> seqs;
+	for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
+		if (i != recombinant) {
+			seqs.push_back(i);
+		}
+	}
+	const size_t N = seqs.size();
+	std::vector<bool> matches(numCols * N);
+	for (size_t t = 0; t < numCols; ++t) {
+		unsigned char r = GAPPED_DNA.encode(ma.getChar(recombinant, t));
+		for (size_t s = 0; s < N; ++s) {
+			matches[t * N + s] = GAPPED_DNA.encode(ma.getChar(seqs[s], t)) == r;
+		}
+	}
+
+	// Forward values of sequence s for point k are at forward[s * LANES + k]
+	std::vector<double> forward(N * LANES);
+	const double initial = 1.0 / N;
+
+	for (size_t p = 0; p < numPoints; p += LANES) {
+		const size_t numLanes = std::min(LANES, numPoints - p);
+
+		// Pad a short last block by repeating its last point
+		double match[LANES], mismatch[LANES], stay[LANES], change[LANES];
+		double total[LANES], logScale[LANES];
+		for (size_t k = 0; k < LANES; ++k) {
+			size_t point = p + std::min(k, numLanes - 1);
+			match[k] = matchProbs[point];
+			mismatch[k] = (1.0 - matchProbs[point]) / 4;
+			stay[k] = norecombinationProbs[point];
+			change[k] = N > 1 ? (1.0 - norecombinationProbs[point]) / (N - 1) : 0;
+			total[k] = 1.0;
+			logScale[k] = 0.0;
+		}
+
+		// First column
+		for (size_t s = 0; s < N; ++s) {
+			const double* emission = matches[s] ? match : mismatch;
+			double* f = &forward[s * LANES];
+			for (size_t k = 0; k < LANES; ++k) {
+				f[k] = emission[k] * initial;
+			}
+		}
+		rescale(forward, total, logScale);
+
+		// Rest of the columns.  After rescaling, the previous column sums
+		// to total[k], so the sum over all source sequences of a uniform
+		// switch matrix reduces to stay * f + change * (total - f).
+		for (size_t t = 1; t < numCols; ++t) {
+			for (size_t s = 0; s < N; ++s) {
+				const double* emission = matches[t * N + s] ? match : mismatch;
+				double* f = &forward[s * LANES];
+				for (size_t k = 0; k < LANES; ++k) {
+					f[k] = (stay[k] * f[k] + change[k] * (total[k] - f[k]))
+						* emission[k];
+				}
+			}
+			rescale(forward, total, logScale);
+		}
+
+		for (size_t k = 0; k < numLanes; ++k) {
+			if (total[k] > 0) {
+				likelihoods[p + k].value = logScale[k];
+			}
+		}
+	}
+}
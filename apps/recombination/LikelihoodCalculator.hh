@@ -1,6 +1,8 @@
 #ifndef __LIKELIHOODCALCULATOR_HH__
 #define __LIKELIHOODCALCULATOR_HH__
 
+#include <vector>
+
 #include "bio/alphabet/Nucleotide.hh"
 #include "bio/alignment/MultipleAlignment.hh"
 #include "math/LogDouble.hh"
@@ -17,7 +19,26 @@ public:
 								double matchProb,
 								double norecombinationProb);
 
+	// Calculates the likelihoods at many parameter points in a single pass
+	// over the alignment.  Point k is (matchProbs[k],
+	// norecombinationProbs[k]).  The forward recursion is run in scaled
+	// linear space for a block of points at a time, renormalising each
+	// column, so the inner loops run across points rather than through
+	// LogDouble additions.
+	static void likelihoods(const MultipleAlignment& ma,
+							size_t recombinant,
+							const std::vector<double>& matchProbs,
+							const std::vector<double>& norecombinationProbs,
+							std::vector<LogDouble>& likelihoods);
+
 private:
+	// Number of points evaluated together by likelihoods()
+	static const size_t LANES = 8;
+
+	static void rescale(std::vector<double>& forward,
+						double total[],
+						double logScale[]);
+
 	static const bio::alphabet::Nucleotide GAPPED_DNA;
 };
 
@@ -28,7 +28,8 @@
 template<typename T>
 class OrderedPolygon {
 public:
-	typedef typename std::vector< Vector<T> > VectorList;
+	typedef typename Polygon<T>::Point Point;
+	typedef typename std::vector<Point> VectorList;
 
 	OrderedPolygon() {
 	}
@@ -46,43 +47,42 @@ public:
 		return vertices.size();
 	}
 	
-	template<typename coord_type>
-	size_t getVertexNum(const Vector<coord_type>& ray) const {
+	template<typename Ray>
+	size_t getVertexNum(const Ray& ray) const {
 		double angle = rayToAngle(ray);
 		std::vector<double>::const_iterator it =
 			std::lower_bound(rays.begin(), rays.end(), angle);
 		return std::distance(rays.begin(), it);
 	}
 
-	Vector<T> ccwRay(size_t i) const {
+	Point ccwRay(size_t i) const {
 		size_t j = (i == vertices.size() - 1 ? 0 : i + 1);
-		Vector<T> halfspace = vertices[i] - vertices[j];
+		Point halfspace = vertices[i] - vertices[j];
 		return makeRay(-halfspace[1], halfspace[0]);
 	}
 
-	Vector<T> cwRay(size_t i) const {
+	Point cwRay(size_t i) const {
 		return ccwRay(i == 0 ? vertices.size() - 1 : i - 1);
 	}
 
-	Vector<T> vertexNormal(size_t i) const {
+	Point vertexNormal(size_t i) const {
 		return ccwRay(i) + cwRay(i);
 	}
 	
-	std::pair< Vector<T>, Vector<T> >getCone(size_t i) {
+	std::pair<Point, Point> getCone(size_t i) {
 		return std::make_pair(ccwRay(i), cwRay(i));
 	}
 
-	template<typename coord_type>
-	static double rayToAngle(const Vector<coord_type>& v) {
+	template<typename Ray>
+	static double rayToAngle(const Ray& v) {
 		double angle = std::atan2(static_cast<double>(v[1]),
 								  static_cast<double>(v[0]));
 		if (angle <= 0.0) { angle += 2 * M_PI; }
 		return angle;
 	}
 
-	template<typename coord_type>
-	static Vector<coord_type> makeRay(coord_type x, coord_type y) {
-		Vector<coord_type> ray(2);
+	static Point makeRay(T x, T y) {
+		Point ray;
 		ray[0] = x;
 		ray[1] = y;
 		return ray;
@@ -99,7 +99,7 @@ public:
 	friend std::istream& operator>>(std::istream& stream,
 									OrderedPolygon<T>& p) {
 		p.vertices.clear();
-		Vector<T> v(2);
+		Point v;
 		while (stream >> v) {
 			p.vertices.push_back(v);
 		}
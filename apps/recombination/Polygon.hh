@@ -24,15 +24,20 @@
 #include <algorithm>
 #include <iosfwd>
 
-#include "Vector.hh"
+#include "FixedVector.hh"
 
+// A convex polygon with integer vertices.  The vertices are kept in
+// counterclockwise order, starting from the lexicographically smallest
+// one, with no three consecutive vertices collinear.  This lets sums and
+// unions be computed by merging, in time linear in the number of vertices.
 template<typename T>
 class Polygon {
 public:
-	typedef typename std::vector< Vector<T> > VectorList;
+	typedef FixedVector<T, 2> Point;
+	typedef typename std::vector<Point> VectorList;
 
 	Polygon();
-	Polygon(const Vector<T>& v);
+	Polygon(const Point& v);
 		
 	Polygon& operator+=(const Polygon& other);
 	Polygon& operator*=(const Polygon& other);
@@ -45,22 +50,37 @@ public:
 	const VectorList& getVertices() const;
 	const size_t getNumVertices() const;
 
+	// Gets the vertex indices in counterclockwise order, starting from
+	// the lexicographically largest vertex
 	void getCCWIndices(std::vector<size_t>& indices) const;
+
+	// Sets the vertices to the convex hull of the given points
+	void setPoints(const VectorList& points);
 	
 	VectorList vertices;
 
 protected:
 
-	void topHull(std::vector<size_t>& hull) const;
-	void bottomHull(std::vector<size_t>& hull) const;
+	typedef std::vector<const Point*> PointerList;
+
+	size_t getMaxIndex() const;
+	void getSortedVertices(PointerList& sorted) const;
+	void makeHull(const PointerList& sorted);
 	
-	static bool isRightTurn2D(const Vector<T>& v1,
-							  const Vector<T>& v2,
-							  const Vector<T>& v3);
-		
-	void combineDuplicatePoints();
-	void removeRedundantPoints();
-	void removeRedundantPoints(const std::vector<bool>& redundant);
+	static bool isRightTurn2D(const Point& v1,
+							  const Point& v2,
+							  const Point& v3);
+
+	static bool isLeftTurn2D(const Point& v1,
+							 const Point& v2,
+							 const Point& v3);
+
+	static int getHalf(T dx, T dy);
+	static bool isBefore(const Point& v1, const Point& w1,
+						 const Point& v2, const Point& w2);
+
+	static bool lessThan(const Point* v1, const Point* v2);
+	static bool equalTo(const Point* v1, const Point* v2);
 };
 
 template<typename T>
@@ -72,7 +92,7 @@ Polygon<T>::Polygon()
 }
 
 template<typename T>
-Polygon<T>::Polygon(const Vector<T>& v)
+Polygon<T>::Polygon(const Point& v)
 	: vertices(1, v) {
 }
 
@@ -108,31 +128,22 @@ Polygon<T>& Polygon<T>::operator+=(const Polygon& p) {
 		return *this;
 	} else if (p.vertices.empty()) {
 		return *this;
-	} else if (p.vertices.size() == 1) {
-		Vector<T> v(p.vertices.front());
-
-		typename VectorList::iterator vertexPos =
-			std::lower_bound(vertices.begin(), vertices.end(), v);
-
-		if (vertexPos != vertices.end() and *vertexPos == v) {
-			return *this;
-		} else {
-			vertices.insert(vertexPos, v);
-		}
-	} else {
-		typedef typename VectorList::iterator VertexIterator;
+	}
 
-		VectorList new_vertices(vertices.size() + p.vertices.size(),
-								Vector<T>(2));
-		std::merge(vertices.begin(), vertices.end(),
-				   p.vertices.begin(), p.vertices.end(),
-				   new_vertices.begin());
+	// Both vertex lists can be put in sorted order in linear time, and
+	// the hull of their merge is the hull of the union
+	PointerList sorted1, sorted2;
+	getSortedVertices(sorted1);
+	p.getSortedVertices(sorted2);
 
-		vertices.swap(new_vertices);
-		combineDuplicatePoints();
-	}
+	PointerList merged(sorted1.size() + sorted2.size());
+	std::merge(sorted1.begin(), sorted1.end(),
+			   sorted2.begin(), sorted2.end(),
+			   merged.begin(), lessThan);
+	merged.erase(std::unique(merged.begin(), merged.end(), equalTo),
+				 merged.end());
 
-	removeRedundantPoints();
+	makeHull(merged);
 	return *this;
 }
 
@@ -142,29 +153,53 @@ Polygon<T>& Polygon<T>::operator*=(const Polygon& p) {
 		vertices.clear();
 		return *this;
 	} else if (p.vertices.size() == 1) {
-		Vector<T> v(p.vertices.front());
+		Point v(p.vertices.front());
 		for (size_t i = 0; i < vertices.size(); ++i) {
 			vertices[i] += v;
 		}
 		return *this;
-	} else {
-		VectorList newVertices;
-
-		newVertices.reserve(vertices.size() * p.vertices.size());
-
+	} else if (vertices.size() == 1) {
+		Point v(vertices.front());
+		vertices = p.vertices;
 		for (size_t i = 0; i < vertices.size(); ++i) {
-			for (size_t j = 0; j < p.vertices.size(); ++j) {
-				newVertices.push_back(vertices[i] + p.vertices[j]);
-			}
+			vertices[i] += v;
 		}
-
-		vertices.swap(newVertices);
-			
-		std::sort(vertices.begin(), vertices.end());
-		combineDuplicatePoints();
-		removeRedundantPoints();
 		return *this;
 	}
+
+	// The Minkowski sum starts at the sum of the lexicographically
+	// smallest vertices, and its edges are those of both polygons
+	// merged in order of angle
+	size_t n = vertices.size(), m = p.vertices.size();
+	VectorList newVertices;
+	newVertices.reserve(n + m);
+
+	size_t i = 0, j = 0;
+	while (i < n or j < m) {
+		newVertices.push_back(vertices[i % n] + p.vertices[j % m]);
+		if (j == m) {
+			++i;
+		} else if (i == n) {
+			++j;
+		} else {
+			const Point& v1 = vertices[i];
+			const Point& w1 = vertices[(i + 1) % n];
+			const Point& v2 = p.vertices[j];
+			const Point& w2 = p.vertices[(j + 1) % m];
+			if (isBefore(v1, w1, v2, w2)) {
+				++i;
+			} else if (isBefore(v2, w2, v1, w1)) {
+				++j;
+			} else {
+				// Parallel edges make a single edge of the sum
+				++i;
+				++j;
+			}
+		}
+	}
+
+	vertices.swap(newVertices);
+	return *this;
 }
 	
 template<typename T>
@@ -175,116 +210,161 @@ Polygon<T>& Polygon<T>::operator^=(const T e) {
 	}
 	if (not vertices.empty() and e == 0) {
 		vertices.resize(1);
+	} else if (e < 0) {
+		// Reflection through the origin keeps the orientation, but the
+		// largest vertex becomes the smallest
+		std::rotate(vertices.begin(),
+					std::min_element(vertices.begin(), vertices.end()),
+					vertices.end());
 	}
 	return *this;
 }
 
 template<typename T>
-void 
-Polygon<T>::combineDuplicatePoints() {
-	vertices.erase(std::unique(vertices.begin(), vertices.end()),
-				   vertices.end());
+void Polygon<T>::setPoints(const VectorList& points) {
+	PointerList sorted;
+	for (size_t i = 0; i < points.size(); ++i) {
+		sorted.push_back(&points[i]);
+	}
+	std::sort(sorted.begin(), sorted.end(), lessThan);
+	sorted.erase(std::unique(sorted.begin(), sorted.end(), equalTo),
+				 sorted.end());
+	makeHull(sorted);
 }
 
 template<typename T>
 bool
-Polygon<T>::isRightTurn2D(const Vector<T>& v1,
-						  const Vector<T>& v2,
-						  const Vector<T>& v3) {
+Polygon<T>::isRightTurn2D(const Point& v1,
+						  const Point& v2,
+						  const Point& v3) {
 	return ((v1[0] - v2[0]) * (v3[1] - v2[1]) -
 			(v3[0] - v2[0]) * (v1[1] - v2[1])) > 0;
 }
 
 template<typename T>
-void
-Polygon<T>::getCCWIndices(std::vector<size_t>& indices) const {
-	bottomHull(indices);
-	indices.pop_back();
-	topHull(indices);
-	std::reverse(indices.begin(), indices.end());
-	indices.pop_back();
+inline bool
+Polygon<T>::isLeftTurn2D(const Point& v1,
+						 const Point& v2,
+						 const Point& v3) {
+	return isRightTurn2D(v3, v2, v1);
 }
 
+// Edges leaving the smallest vertex have angles in (-pi/2, pi/2], and
+// the angles of successive edges increase up to at most 3pi/2.  The
+// half of that range in which an edge lies is 0 or 1.
 template<typename T>
-void
-Polygon<T>::topHull(std::vector<size_t>& hull) const {
-	int n = vertices.size();
-	hull.push_back(0);
-	hull.push_back(1);
-	for (int i = 2; i < n; ++i) {
-		hull.push_back(i);
-		while (hull.size() > 2 and
-			   not isRightTurn2D(vertices[hull[hull.size() - 3]],
-								 vertices[hull[hull.size() - 2]],
-								 vertices[hull[hull.size() - 1]])) {
-			hull.erase(hull.end() - 2);
-		}
-	}
+inline int
+Polygon<T>::getHalf(T dx, T dy) {
+	return (dx > 0 or (dx == 0 and dy > 0)) ? 0 : 1;
 }
 
+// Whether the edge from v1 to w1 comes before the edge from v2 to w2 in
+// counterclockwise order
 template<typename T>
-void
-Polygon<T>::bottomHull(std::vector<size_t>& hull) const {
-	int n = vertices.size();
-	hull.push_back(n - 1);
-	hull.push_back(n - 2);
-	for (int i = n - 3; i >= 0; --i) {
-		hull.push_back(i);
-		while (hull.size() > 2 and
-			   not isRightTurn2D(vertices[hull[hull.size() - 3]],
-								 vertices[hull[hull.size() - 2]],
-								 vertices[hull[hull.size() - 1]])) {
-			hull.erase(hull.end() - 2);
-		}
+inline bool
+Polygon<T>::isBefore(const Point& v1, const Point& w1,
+					 const Point& v2, const Point& w2) {
+	T dx1 = w1[0] - v1[0], dy1 = w1[1] - v1[1];
+	T dx2 = w2[0] - v2[0], dy2 = w2[1] - v2[1];
+	int half1 = getHalf(dx1, dy1), half2 = getHalf(dx2, dy2);
+	if (half1 != half2) {
+		return half1 < half2;
 	}
+	return dx1 * dy2 - dy1 * dx2 > 0;
 }
 
 template<typename T>
-void 
-Polygon<T>::removeRedundantPoints() {
-	int n = vertices.size();
-		
-	if (n <= 2) { return; }
+inline bool
+Polygon<T>::lessThan(const Point* v1, const Point* v2) {
+	return *v1 < *v2;
+}
 
-	std::vector<bool> redundant(n, true);
+template<typename T>
+inline bool
+Polygon<T>::equalTo(const Point* v1, const Point* v2) {
+	return *v1 == *v2;
+}
 
-	std::vector<size_t> side;
-	side.reserve(n);
+template<typename T>
+size_t
+Polygon<T>::getMaxIndex() const {
+	return std::max_element(vertices.begin(), vertices.end())
+		- vertices.begin();
+}
 
-	topHull(side);
-	for (size_t i = 0; i < side.size(); ++i) {
-		redundant[side[i]] = false;
+template<typename T>
+void
+Polygon<T>::getCCWIndices(std::vector<size_t>& indices) const {
+	size_t n = vertices.size();
+	size_t start = getMaxIndex();
+	for (size_t i = 0; i < n; ++i) {
+		indices.push_back((start + i) % n);
 	}
-	
-	side.clear();
+}
 
-	bottomHull(side);
-	for (size_t i = 0; i < side.size(); ++i) {
-		redundant[side[i]] = false;
+// The vertices from the smallest to the largest form the lower hull and
+// the rest the upper hull, so sorting is a merge of the two
+template<typename T>
+void
+Polygon<T>::getSortedVertices(PointerList& sorted) const {
+	size_t n = vertices.size();
+	size_t max = getMaxIndex();
+	sorted.reserve(n);
+	size_t lower = 0, upper = n - 1;
+	while (lower <= max and upper > max) {
+		if (vertices[upper] < vertices[lower]) {
+			sorted.push_back(&vertices[upper--]);
+		} else {
+			sorted.push_back(&vertices[lower++]);
+		}
+	}
+	while (lower <= max) {
+		sorted.push_back(&vertices[lower++]);
+	}
+	while (upper > max) {
+		sorted.push_back(&vertices[upper--]);
 	}
-
-	Polygon<T>::removeRedundantPoints(redundant);
 }
-	
-template<typename T>
-void 
-Polygon<T>::removeRedundantPoints(const std::vector<bool>& redundant) {
-	typedef typename VectorList::iterator VertexIterator;
-	typedef std::vector<bool>::const_iterator RedundantIterator;
-		
-	VertexIterator insertV = vertices.begin(), currV = vertices.begin();
-	RedundantIterator currR = redundant.begin();
 
-	while (currV != vertices.end()) {
-		if (not *currR) {
-			*insertV = *currV;
-			++insertV;
+template<typename T>
+void
+Polygon<T>::makeHull(const PointerList& sorted) {
+	int n = sorted.size();
+
+	// Lower hull from left to right, then upper hull from right to left,
+	// turning left at every vertex
+	PointerList hull;
+	hull.reserve(n + 1);
+	for (int i = 0; i < n; ++i) {
+		while (hull.size() >= 2 and
+			   not isLeftTurn2D(*hull[hull.size() - 2],
+								*hull[hull.size() - 1],
+								*sorted[i])) {
+			hull.pop_back();
 		}
-		++currV;
-		++currR;
+		hull.push_back(sorted[i]);
 	}
-		
-	vertices.erase(insertV, vertices.end());
+	size_t lowerSize = hull.size();
+	for (int i = n - 2; i >= 0; --i) {
+		while (hull.size() > lowerSize and
+			   not isLeftTurn2D(*hull[hull.size() - 2],
+								*hull[hull.size() - 1],
+								*sorted[i])) {
+			hull.pop_back();
+		}
+		hull.push_back(sorted[i]);
+	}
+	if (hull.size() > 1) {
+		hull.pop_back();
+	}
+
+	// The points may be our own vertices, so build the list separately
+	VectorList newVertices;
+	newVertices.reserve(hull.size());
+	for (size_t i = 0; i < hull.size(); ++i) {
+		newVertices.push_back(*hull[i]);
+	}
+	vertices.swap(newVertices);
 }
 		
 template<typename T>
@@ -299,10 +379,12 @@ std::ostream& operator<<(std::ostream& stream, const Polygon<T>& p) {
 template<typename T>
 std::istream& operator>>(std::istream& stream, Polygon<T>& p) {
 	p.vertices.clear();
-	Vector<T> v(2);
+	typename Polygon<T>::VectorList points;
+	typename Polygon<T>::Point v;
 	while (stream >> v) {
-		p.vertices.push_back(v);
+		points.push_back(v);
 	}
+	p.setPoints(points);
 	return stream;
 }
 
@@ -1,7 +1,7 @@
 #include "Polygon.hh"
 
 typedef Polygon<int> IntegerPolygon;
-typedef Vector<int> IntegerVector;
+typedef IntegerPolygon::Point IntegerVector;
 
 class PolygonSemiRing {
 public:
@@ -22,8 +22,10 @@
 #include "util/matrix.hh"
 #include "bio/alignment/AlphabetScoringMatrix.hh"
 #include "bio/alignment/MultipleAlignment.hh"
+#include "bio/alignment/ColumnPatterns.hh"
 using bio::alignment::AlphabetScoringMatrix;
 using bio::alignment::MultipleAlignment;
+using bio::alignment::ColumnPatterns;
 
 template<typename SemiRing>
 class RecombinationScorer {
@@ -35,14 +37,42 @@ public:
 						const AlphabetScoringMatrix<Score>& emissionScores,
 						const util::Matrix<Score>& transitionScores);
 
+	// Scorer for transitions with uniform switch rates: a transition into
+	// state i scores stayScores[i] from i itself and switchScores[i] from
+	// every other state.  Each column then takes O(N) rather than O(N^2)
+	// semiring operations.
+	RecombinationScorer(const SemiRing& semiRing,
+						const std::vector<Score>& initialScores,
+						const AlphabetScoringMatrix<Score>& emissionScores,
+						const std::vector<Score>& stayScores,
+						const std::vector<Score>& switchScores);
+
 	Score score(const MultipleAlignment& ma,
 				size_t recombinant = 0) const;
 
+	// Scores an alignment given as its column patterns, looking up the
+	// emission scores once per pattern
+	Score score(const ColumnPatterns& patterns,
+				size_t recombinant = 0) const;
+
 private:
 	SemiRing semiRing;
 	std::vector<Score> initialScores;
 	AlphabetScoringMatrix<Score> emissionScores;
 	util::Matrix<Score> transitionScores;
+	bool uniformSwitching;
+	std::vector<Score> stayScores;
+	std::vector<Score> switchScores;
+
+	void transit(const std::vector<Score>& prev,
+				 std::vector<Score>& next,
+				 size_t recombinant) const;
+
+	void transitUniform(const std::vector<Score>& prev,
+						std::vector<Score>& next,
+						std::vector<Score>& after,
+						std::vector<size_t>& followingStates,
+						size_t recombinant) const;
 };
 
 template<typename SemiRing>
@@ -54,7 +84,102 @@ RecombinationScorer(const SemiRing& semiRing,
 	: semiRing(semiRing),
 	  initialScores(initialScores),
 	  emissionScores(emissionScores),
-	  transitionScores(transitionScores) {
+	  transitionScores(transitionScores),
+	  uniformSwitching(false) {
+}
+
+template<typename SemiRing>
+RecombinationScorer<SemiRing>::
+RecombinationScorer(const SemiRing& semiRing,
+					const std::vector<Score>& initialScores,
+					const AlphabetScoringMatrix<Score>& emissionScores,
+					const std::vector<Score>& stayScores,
+					const std::vector<Score>& switchScores)
+	: semiRing(semiRing),
+	  initialScores(initialScores),
+	  emissionScores(emissionScores),
+	  uniformSwitching(true),
+	  stayScores(stayScores),
+	  switchScores(switchScores) {
+}
+
+template<typename SemiRing>
+void
+RecombinationScorer<SemiRing>::
+transit(const std::vector<Score>& prev,
+		std::vector<Score>& next,
+		size_t recombinant) const {
+	for (size_t i = 0; i < prev.size(); ++i) {
+		if (i == recombinant) { continue; }
+
+		next[i] = semiRing.getZero();
+			
+		for (size_t j = 0; j < prev.size(); ++j) {
+			if (j == recombinant) { continue; }
+			Score term = prev[j];
+			term *= transitionScores(j, i);
+			next[i] += term;
+		}
+	}
+}
+
+// Since every state is entered with the same score from all other states,
+// next[i] = prev[i] * stay[i] + (sum of prev[j] for j != i) * switch[i].
+// The sums over the other states are formed from running sums before and
+// after i, which needs no subtraction and so works in any semiring.  The
+// terms are added in increasing order of j, as in transit(), so that
+// semirings that break ties by order pick the same paths.
+template<typename SemiRing>
+void
+RecombinationScorer<SemiRing>::
+transitUniform(const std::vector<Score>& prev,
+			   std::vector<Score>& next,
+			   std::vector<Score>& after,
+			   std::vector<size_t>& followingStates,
+			   size_t recombinant) const {
+	const size_t n = prev.size();
+
+	// after[i] is the sum of prev[j] over the states j >= i, and
+	// following[i] is the first state after i (n if there is none)
+	size_t following = n;
+	for (size_t i = n; i-- > 0; ) {
+		if (i == recombinant) { continue; }
+		after[i] = prev[i];
+		if (following != n) {
+			after[i] += after[following];
+		}
+		followingStates[i] = following;
+		following = i;
+	}
+
+	Score before = semiRing.getZero();
+	bool anyBefore = false;
+	for (size_t i = 0; i < n; ++i) {
+		if (i == recombinant) { continue; }
+
+		Score stay = prev[i];
+		stay *= stayScores[i];
+		if (anyBefore) {
+			next[i] = before;
+			next[i] *= switchScores[i];
+			next[i] += stay;
+		} else {
+			next[i] = stay;
+		}
+
+		if (followingStates[i] != n) {
+			Score rest = after[followingStates[i]];
+			rest *= switchScores[i];
+			next[i] += rest;
+		}
+
+		if (anyBefore) {
+			before += prev[i];
+		} else {
+			before = prev[i];
+			anyBefore = true;
+		}
+	}
 }
 	
 template<typename SemiRing>
@@ -62,46 +187,67 @@ typename SemiRing::Element
 RecombinationScorer<SemiRing>::
 score(const MultipleAlignment& ma,
 	  size_t recombinant) const {
+	return score(ColumnPatterns(ma), recombinant);
+}
+
+template<typename SemiRing>
+typename SemiRing::Element
+RecombinationScorer<SemiRing>::
+score(const ColumnPatterns& patterns,
+	  size_t recombinant) const {
 	const Score zero = semiRing.getZero();
-	const Score one = semiRing.getMultiplicativeIdentity();
+	const size_t numSeqs = patterns.getNumSeqs();
 
-	if (ma.getNumCols() == 0) {
+	if (patterns.getNumCols() == 0) {
 		return zero;
 	}
 
-	std::vector<Score> prev(ma.getNumSeqs(), zero);
-	std::vector<Score> next(ma.getNumSeqs(), zero);
+	// Emission scores of each column pattern
+	util::Matrix<Score> emissions(patterns.getNumPatterns(), numSeqs);
+	for (size_t p = 0; p < patterns.getNumPatterns(); ++p) {
+		for (size_t i = 0; i < numSeqs; ++i) {
+			if (i == recombinant) { continue; }
+			emissions(p, i) =
+				emissionScores.getCharScore(patterns.getChar(recombinant, p),
+											patterns.getChar(i, p));
+		}
+	}
+
+	std::vector<Score> prev(numSeqs, zero);
+	std::vector<Score> next(numSeqs, zero);
+	// Scratch space for transitUniform
+	std::vector<Score> after(uniformSwitching ? numSeqs : 0, zero);
+	std::vector<size_t> followingStates(after.size());
 
 	// Calculate first column
-	for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
+	size_t p = patterns.getPatternIndex(0);
+	for (size_t i = 0; i < numSeqs; ++i) {
 		if (i == recombinant) { continue; }
-		next[i] = emissionScores.getCharScore(ma.getChar(recombinant, 0),
-											  ma.getChar(i, 0));
+		next[i] = emissions(p, i);
 		next[i] *= initialScores[i];
 	}
 	
 	// Calculate the rest of the columns
-	for (size_t t = 1; t < ma.getNumCols(); ++t) {
+	for (size_t t = 1; t < patterns.getNumCols(); ++t) {
 		
 		next.swap(prev);
-		
-		for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
-			if (i == recombinant) { continue; }
 
-			next[i] = zero;
-			
-			for (size_t j = 0; j < ma.getNumSeqs(); ++j) {
-				if (j == recombinant) { continue; }
-				next[i] += (prev[j] * transitionScores(j, i));
-			}
-			
-			next[i] *= emissionScores.getCharScore(ma.getChar(recombinant, t),
-												   ma.getChar(i, t));
+		if (uniformSwitching) {
+			transitUniform(prev, next, after, followingStates,
+						   recombinant);
+		} else {
+			transit(prev, next, recombinant);
+		}
+
+		p = patterns.getPatternIndex(t);
+		for (size_t i = 0; i < numSeqs; ++i) {
+			if (i == recombinant) { continue; }
+			next[i] *= emissions(p, i);
 		}
 	}
 	
 	Score result = zero;
-	for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
+	for (size_t i = 0; i < numSeqs; ++i) {
 		if (i == recombinant) { continue; }
 		result += next[i];
 	}
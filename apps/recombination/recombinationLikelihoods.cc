@@ -74,17 +74,25 @@ int main(int argc, const char* argv[]) {
 		AlignmentReader reader(alignment_file,
 							   recombinant_name, recombinant_num);
 
+		// Read in all of the points so that they can be evaluated together
 		InputFileStream points_file(points_filename);
-		LikelihoodCalculator lc;
-
 		std::vector<double> point(2);
-		std::cout << std::setprecision(20);
+		std::vector<double> matchProbs, norecombinationProbs;
 		while (points_file >> point) {
-			std::cout << lc.likelihood(reader.getAlignment(),
-									   reader.getRecombinantNum(),
-									   point[0],
-									   point[1])
-					  << '\n';
+			matchProbs.push_back(point[0]);
+			norecombinationProbs.push_back(point[1]);
+		}
+
+		std::vector<LogDouble> likelihoods;
+		LikelihoodCalculator::likelihoods(reader.getAlignment(),
+										  reader.getRecombinantNum(),
+										  matchProbs,
+										  norecombinationProbs,
+										  likelihoods);
+
+		std::cout << std::setprecision(20);
+		for (size_t i = 0; i < likelihoods.size(); ++i) {
+			std::cout << likelihoods[i] << '\n';
 		}
 
 	} catch (const std::runtime_error& e) {
@@ -49,19 +49,16 @@ void findBestPath(const MultipleAlignment& ma,
 	std::vector<Element> initialScores(ma.getNumSeqs(),
 									   semiRing.getMultiplicativeIdentity());
 	AlphabetScoringMatrix<Element> emissionScores(GAPPED_DNA, match, mismatch);
-	util::Matrix<Element> transitionScores(ma.getNumSeqs(),
-										   ma.getNumSeqs());
+	std::vector<Element> stayScores, switchScores;
 	for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
-		for (size_t j = 0; j < ma.getNumSeqs(); ++j) {
-			PathPtr p(new Path(j));
-			transitionScores(i, j) = (i == j ? 
-									  Element(norecombinationScore, p) :
-									  Element(recombinationScore, p));
-		}
+		PathPtr p(new Path(i));
+		stayScores.push_back(Element(norecombinationScore, p));
+		switchScores.push_back(Element(recombinationScore, p));
 	}
 
 	RecombinationScorer<SemiRing>
-		scorer(semiRing, initialScores, emissionScores, transitionScores);
+		scorer(semiRing, initialScores, emissionScores,
+			   stayScores, switchScores);
 
 	Element best = scorer.score(ma, recombinant);
 	bestPath.clear();
@@ -50,15 +50,12 @@ IntegerPolygon calculatePolygon(const MultipleAlignment& ma,
 	
 	AlphabetScoringMatrix<Element> emissionScores(GAPPED_DNA, match, mismatch);
 	
-	util::Matrix<IntegerPolygon> transitionScores(n, n);
-	for (size_t i = 0; i < n; ++i) {
-		for (size_t j = 0; j < n; ++j) {
-			transitionScores(i, j) = (i == j ? norecombination : recombination);
-		}
-	}
+	std::vector<Element> stayScores(n, norecombination);
+	std::vector<Element> switchScores(n, recombination);
 
 	RecombinationScorer<PolygonSemiRing>
-		scorer(semiRing, initialScores, emissionScores, transitionScores);
+		scorer(semiRing, initialScores, emissionScores,
+			   stayScores, switchScores);
 
 	return scorer.score(ma, recombinant);
 }
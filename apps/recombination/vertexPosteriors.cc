@@ -42,14 +42,15 @@ void read_logdoubles(std::istream& stream, std::vector<LogDouble>& lhs) {
 	}
 }
 
-void read_points(std::istream& stream, std::vector< Vector<double> >& points) {
-	Vector<double> point(2);
+void read_points(std::istream& stream,
+				 std::vector< FixedVector<double, 2> >& points) {
+	FixedVector<double, 2> point;
 	while (stream >> point) {
 		points.push_back(point);
 	}
 }
 
-Vector<double> fan_ray(Vector<double> point, size_t n) {
+FixedVector<double, 2> fan_ray(FixedVector<double, 2> point, size_t n) {
 	point[0] = std::log(4.0f) + std::log(point[0] / (1.0 - point[0]));
 	point[1] = std::log(static_cast<double>(n - 1)) +
 		std::log(point[1] / (1.0 - point[1]));
@@ -94,7 +95,7 @@ int main(int argc, const char* argv[]) {
 		polygon_file >> p;
 
 		// Read in points
-		std::vector< Vector<double> > points;
+		std::vector< FixedVector<double, 2> > points;
 		InputFileStream points_file(points_filename);
 		read_points(points_file, points);
 
@@ -74,11 +74,14 @@ int main(int argc, const char* argv[]) {
 		OrderedPolygon<int> p;
 		polygon_file >> p;
 
+		// Every vertex is scored against the same alignment columns
+		ColumnPatterns patterns(reader.getAlignment());
+
 		for (size_t i = 0; i < p.getNumVertices(); ++i) {
-			Vector<int> normal = p.vertexNormal(i);
+			OrderedPolygon<int>::Point normal = p.vertexNormal(i);
 			BestStateSetLister lister(normal[0],  0, 0, normal[1]);
 			StateSetList bestStateSetList;
-			lister.getBestStateSetList(reader.getAlignment(),
+			lister.getBestStateSetList(patterns,
 									   reader.getRecombinantNum(),
 									   bestStateSetList);
 
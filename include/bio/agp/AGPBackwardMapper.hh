@@ -21,12 +21,12 @@
 #define __AGP_BACKWARD_MAPPER_HH__
 
 #include <vector>
-#include <list>
 #include <istream>
 
 #include "bio/formats/agp/Record.hh"
+#include "bio/agp/AGPIndex.hh"
 #include "bio/genome/IntervalMapper.hh"
-#include "util/stl.hh"
+#include "boost/unordered_map.hpp"
 
 namespace bio { namespace agp {
 
@@ -37,11 +37,9 @@ namespace bio { namespace agp {
 				 std::vector<genome::BasicInterval>& mapped);
 
 	private:
-		static bool overlap(const formats::agp::Record& x,
-							const genome::Interval& i);
-		
-		typedef std::vector<formats::agp::Record> AGPVector;
-		AGPVector agpRecs;
+		typedef boost::unordered_map<std::string,
+									 AGPIndex<ContigCoords> > AGPMap;
+		AGPMap chromMap;
 	};
 
 } }
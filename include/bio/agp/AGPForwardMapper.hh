@@ -21,10 +21,10 @@
 #define __BIO_GENOME_AGPFORWARDMAPPER_HH__
 
 #include <vector>
-#include <list>
 #include <istream>
 
 #include "bio/formats/agp/Record.hh"
+#include "bio/agp/AGPIndex.hh"
 #include "bio/genome/IntervalMapper.hh"
 #include "boost/unordered_map.hpp"
 
@@ -38,11 +38,8 @@ namespace bio { namespace agp {
 		genome::Distance getChromSize(const std::string& chrom) const;
 
 	private:
-		bool overlap(const genome::Interval& i,
-					 const formats::agp::Record& rec);
-		
-		typedef std::list<formats::agp::Record> AGPList;
-		typedef boost::unordered_map<std::string, AGPList> AGPMap;
+		typedef boost::unordered_map<std::string,
+									 AGPIndex<SourceCoords> > AGPMap;
 		typedef boost::unordered_map<std::string, genome::Distance> LengthMap;
 		AGPMap contigMap;
 		LengthMap chromSizes;
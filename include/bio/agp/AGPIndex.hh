@@ -0,0 +1,131 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_AGP_AGPINDEX_HH__
+#define __BIO_AGP_AGPINDEX_HH__
+
+#include <vector>
+#include <algorithm>
+
+#include "bio/formats/agp/Record.hh"
+
+namespace bio { namespace agp {
+
+	// Coordinates of the source (contig) side of an AGP record
+	struct SourceCoords {
+		static genome::Position start(const formats::agp::Record& r) {
+			return r.getSourceStart();
+		}
+		static genome::Position end(const formats::agp::Record& r) {
+			return r.getSourceEnd();
+		}
+	};
+
+	// Coordinates of the assembled (chromosome) side of an AGP record
+	struct ContigCoords {
+		static genome::Position start(const formats::agp::Record& r) {
+			return r.getContigStart();
+		}
+		static genome::Position end(const formats::agp::Record& r) {
+			return r.getContigEnd();
+		}
+	};
+
+	// Index over the AGP records of one sequence for overlap queries.
+	// Records are kept sorted by start, together with the running
+	// maximum of their ends, so that the first record that can overlap
+	// a query is found by binary search even when records overlap each
+	// other.  Record coordinates are parsed once, when the index is
+	// built.
+	template<typename Coords>
+	class AGPIndex {
+	public:
+		AGPIndex() : recs(), entries(), maxEnds() {}
+
+		void add(const formats::agp::Record& rec) {
+			recs.push_back(rec);
+		}
+
+		// Must be called after all records have been added and before
+		// any query
+		void build();
+
+		// Appends the records that overlap the zero-based, half-open
+		// interval [start, end), ordered by start
+		void getOverlapping(genome::Position start,
+							genome::Position end,
+							std::vector<const formats::agp::Record*>& overlapping) const;
+
+		size_t size() const { return recs.size(); }
+
+	private:
+		struct Entry {
+			genome::Position start;
+			genome::Position end;
+			size_t rec;
+
+			bool operator<(const Entry& other) const {
+				return start < other.start
+					or (start == other.start and end < other.end);
+			}
+		};
+
+		std::vector<formats::agp::Record> recs;
+		std::vector<Entry> entries;
+		std::vector<genome::Position> maxEnds;
+	};
+
+	template<typename Coords>
+	void AGPIndex<Coords>::build() {
+		entries.resize(recs.size());
+		for (size_t r = 0; r < recs.size(); ++r) {
+			entries[r].start = Coords::start(recs[r]);
+			entries[r].end = Coords::end(recs[r]);
+			entries[r].rec = r;
+		}
+		std::stable_sort(entries.begin(), entries.end());
+
+		maxEnds.resize(entries.size());
+		for (size_t e = 0; e < entries.size(); ++e) {
+			maxEnds[e] = (e == 0
+						  ? entries[e].end
+						  : std::max(maxEnds[e - 1], entries[e].end));
+		}
+	}
+
+	template<typename Coords>
+	void AGPIndex<Coords>::getOverlapping(genome::Position start,
+										  genome::Position end,
+										  std::vector<const formats::agp::Record*>& overlapping) const {
+		// Record coordinates are one-based and closed, so a record
+		// overlaps [start, end) if its end is greater than start and its
+		// start is at most end.  All records before the first one whose
+		// running maximum end exceeds start end before the query.
+		size_t e = std::upper_bound(maxEnds.begin(), maxEnds.end(), start)
+			- maxEnds.begin();
+		for (; e < entries.size() and entries[e].start <= end; ++e) {
+			if (entries[e].end > start) {
+				overlapping.push_back(&recs[entries[e].rec]);
+			}
+		}
+	}
+
+} }
+
+#endif // __BIO_AGP_AGPINDEX_HH__
@@ -126,7 +126,7 @@ namespace bio { namespace alignment {
 	align(const std::string& seq1,
 		  const std::string& seq2) const {
 		std::vector<ScoreMatrix> states(3);
-		scorer.scoreMatrixForward(seq1, seq1, states[H], states[D], states[I]);
+		scorer.scoreMatrixForward(seq1, seq2, states[H], states[D], states[I]);
 
 		std::vector<int> traceback;
 
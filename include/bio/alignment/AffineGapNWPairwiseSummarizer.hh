@@ -207,15 +207,30 @@ namespace bio { namespace alignment {
 						  bool linearMem = false) const;
 
 		Summary summarize(const PairwiseAlignment& alignment) const;
+
+		// As above, but with the variable values given by SCORES rather
+		// than those set by setScores().  These keep all of their working
+		// state local to the call, so several threads may call them at
+		// once.
+		Summary summarize(const std::vector<NumType>& scores,
+						  const std::string& seq1,
+						  const std::string& seq2,
+						  bool lexMin = false,
+						  bool linearMem = false) const;
+
+		Summary summarize(const std::vector<NumType>& scores,
+						  const PairwiseAlignment& alignment) const;
 		
 		void setScores(const std::vector<NumType>& scores);
 		
 	protected:
-		Summary summarizeAny(const std::string& seq1,
+		Summary summarizeAny(const std::vector<NumType>& scores,
+							 const std::string& seq1,
 							 const std::string& seq2,
 							 bool linearMem) const;
 		
-		Summary summarizeLexMin(const std::string& seq1,
+		Summary summarizeLexMin(const std::vector<NumType>& scores,
+								const std::string& seq1,
 								const std::string& seq2) const;
 
 		AlphabetScoringMatrix<size_t> matrixVars;
@@ -223,7 +238,6 @@ namespace bio { namespace alignment {
 		size_t gapVar;
 		bool isLastVarZero;
 		std::vector<NumType> scores;
-		mutable AffineGapNWFastPairwiseAligner<NumType> fastAligner;		
 	};
 	
 	template<typename NumType>
@@ -236,15 +250,13 @@ namespace bio { namespace alignment {
 		  spaceVar(spaceVar),
 		  gapVar(gapVar),
 		  isLastVarZero(isLastVarZero),
-		  scores(),
-		  fastAligner(matrixVars.getAlphabet()) {
+		  scores() {
 	}
 
 	template<typename NumType>
 	AffineGapNWPairwiseSummarizer<NumType>::
 	AffineGapNWPairwiseSummarizer(const alphabet::Alphabet& alphabet)
-		: matrixVars(alphabet),
-		  fastAligner(alphabet) {
+		: matrixVars(alphabet) {
 	}
 	
 	template<typename NumType>
@@ -267,17 +279,29 @@ namespace bio { namespace alignment {
 			  const std::string& seq2,
 			  bool lexMin,
 			  bool linearMem) const {
+		return summarize(scores, seq1, seq2, lexMin, linearMem);
+	}
+
+	template<typename NumType>
+	typename AffineGapNWPairwiseSummarizer<NumType>::Summary
+	AffineGapNWPairwiseSummarizer<NumType>::
+	summarize(const std::vector<NumType>& scores,
+			  const std::string& seq1,
+			  const std::string& seq2,
+			  bool lexMin,
+			  bool linearMem) const {
 		if (lexMin) {
-			return summarizeLexMin(seq1, seq2);
+			return summarizeLexMin(scores, seq1, seq2);
 		} else {
-			return summarizeAny(seq1, seq2, linearMem);
+			return summarizeAny(scores, seq1, seq2, linearMem);
 		}
 	}
 
 	template<typename NumType>
 	typename AffineGapNWPairwiseSummarizer<NumType>::Summary
 	AffineGapNWPairwiseSummarizer<NumType>::
-	summarizeAny(const std::string& seq1,
+	summarizeAny(const std::vector<NumType>& scores,
+				 const std::string& seq1,
 				 const std::string& seq2,
 				 bool linearMem) const {
 		std::vector<NumType> eltScores(scores);
@@ -289,17 +313,19 @@ namespace bio { namespace alignment {
 			AffineGapNWPairwiseAligner<NumType> aligner(matrix,
 														eltScores[spaceVar],
 														eltScores[gapVar]);
-			return summarize(aligner.align(seq1, seq2));
+			return summarize(scores, aligner.align(seq1, seq2));
 		} else {
-			fastAligner.setScores(matrix, eltScores[spaceVar], eltScores[gapVar]);
-			return summarize(fastAligner.align(seq1, seq2));
+			AffineGapNWFastPairwiseAligner<NumType>
+				aligner(matrix, eltScores[spaceVar], eltScores[gapVar]);
+			return summarize(scores, aligner.align(seq1, seq2));
 		}
 	}
 		
 	template<typename NumType>
 	typename AffineGapNWPairwiseSummarizer<NumType>::Summary
 	AffineGapNWPairwiseSummarizer<NumType>::
-	summarizeLexMin(const std::string& seq1,
+	summarizeLexMin(const std::vector<NumType>& scores,
+					const std::string& seq1,
 					const std::string& seq2) const {
 		ScoringSemiRing scoringSemiRing;
 		SemiRing summarySemiRing(scoringSemiRing, scores.size());
@@ -323,6 +349,14 @@ namespace bio { namespace alignment {
 	typename AffineGapNWPairwiseSummarizer<NumType>::Summary
 	AffineGapNWPairwiseSummarizer<NumType>::
 	summarize(const PairwiseAlignment& alignment) const {
+		return summarize(scores, alignment);
+	}
+
+	template<typename NumType>
+	typename AffineGapNWPairwiseSummarizer<NumType>::Summary
+	AffineGapNWPairwiseSummarizer<NumType>::
+	summarize(const std::vector<NumType>& scores,
+			  const PairwiseAlignment& alignment) const {
 		ScoringSemiRing scoringSemiRing;
 		SemiRing summarySemiRing(scoringSemiRing, scores.size());
 		std::vector<Element> eltScores;
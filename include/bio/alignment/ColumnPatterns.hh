@@ -0,0 +1,65 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_ALIGNMENT_COLUMNPATTERNS_HH__
+#define __BIO_ALIGNMENT_COLUMNPATTERNS_HH__
+
+#include <string>
+#include <vector>
+
+#include "bio/alignment/MultipleAlignment.hh"
+
+namespace bio { namespace alignment {
+
+	// A multiple alignment compressed into its distinct column patterns.
+	// Column t of the alignment is pattern getPatternIndex(t), so scores
+	// that depend only on a column's characters need to be computed once
+	// per pattern rather than once per column.  Patterns are numbered in
+	// order of their first occurrence.
+	class ColumnPatterns {
+	public:
+		ColumnPatterns(const MultipleAlignment& ma);
+
+		size_t getNumSeqs() const { return numSeqs; }
+		size_t getNumCols() const { return indices.size(); }
+		size_t getNumPatterns() const { return patterns.size(); }
+
+		// Characters of pattern p, one per sequence
+		const std::string& getPattern(size_t p) const { return patterns[p]; }
+
+		char getChar(size_t seqNum, size_t p) const {
+			return patterns[p][seqNum];
+		}
+
+		// Index of the pattern of column colNum
+		size_t getPatternIndex(size_t colNum) const { return indices[colNum]; }
+
+		// Number of columns having pattern p
+		size_t getCount(size_t p) const { return counts[p]; }
+
+	private:
+		size_t numSeqs;
+		std::vector<std::string> patterns;
+		std::vector<size_t> counts;
+		std::vector<size_t> indices;
+	};
+
+} }
+
+#endif // __BIO_ALIGNMENT_COLUMNPATTERNS_HH__
@@ -21,9 +21,12 @@
 #define __BIO_ALIGNMENT_PAIRHMM_HH__
 
 #include <vector>
+#include <string>
+#include <utility>
 
 #include "util/matrix.hh"
 #include "math/LogDouble.hh"
+#include "bio/alignment/PairwiseAlignment.hh"
 
 namespace bio { namespace alignment {
 
@@ -44,9 +47,47 @@ namespace bio { namespace alignment {
 		Prob likelihood(const Seq& s1,
 						const Seq& s2);
 
+		// The first and last column of each row of the DP matrix, from
+		// row 0 to row s1.size(), that alignments are restricted to
+		typedef std::vector< std::pair<size_t, size_t> > Band;
+
+		static Band getFullBand(size_t length1, size_t length2);
+
+		// Band of the cells within WIDTH columns of those that SEED
+		// passes through
+		static Band getSeedBand(const PairwiseAlignment& seed, size_t width);
+
+		// Receives the posterior probabilities that s1[i - 1] is aligned
+		// to s2[j - 1], for j from FIRSTCOL to the end of the band, one
+		// row at a time from the last row to row 1
+		class PosteriorVisitor {
+		public:
+			virtual ~PosteriorVisitor() {}
+			virtual void visitRow(size_t i,
+								  size_t firstCol,
+								  const std::vector<double>& probs) = 0;
+		};
+
+		// Computes match posteriors by the forward-backward algorithm in
+		// rescaled arithmetic, keeping only every sqrt(s1.size())th
+		// forward row and recomputing the others from it.  Returns the
+		// likelihood of the sequences within the band.
+		Prob posteriors(const Seq& s1,
+						const Seq& s2,
+						const Band& band,
+						PosteriorVisitor& visitor) const;
+
+		// Returns the alignment within the band with the greatest
+		// expected number of correctly aligned pairs of characters
+		PairwiseAlignment posteriorDecode(const Seq& s1,
+										  const Seq& s2,
+										  const Band& band) const;
+
 		enum State { H_STATE, I_STATE, D_STATE };
 		
 	private:
+		class ScaledModel;
+
 		const ProbMatrix hEmissions;
 		const ProbVector iEmissions;
 		const ProbVector dEmissions;
@@ -20,41 +20,242 @@
 #ifndef __BIO_ALIGNMENT_SUMOFPAIRSSCORER_HH__
 #define __BIO_ALIGNMENT_SUMOFPAIRSSCORER_HH__
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "bio/alignment/MultipleAlignmentScorer.hh"
+#include "bio/alignment/PairwiseAlignmentScorer.hh"
+#include "bio/alignment/ScoringMatrix.hh"
+#include "bio/alignment/ColumnPatterns.hh"
 
 namespace bio { namespace alignment {
 
 	template<typename Score>
 	class SumOfPairsScorer : public MultipleAlignmentScorer<Score> {
 	private:
-		const PairwiseAlignmentScorer<Score>& pairwiseScorer;
+		const PairwiseAlignmentScorer<Score>* pairwiseScorer;
+		const ScoringMatrix<Score>* matrix;
+		Score space;
+		Score gap;
+
+		typedef unsigned long Word;
+		static const size_t WORD_BITS = sizeof(Word) * 8;
+
+		Score scorePairwise(const ColumnPatterns& patterns) const;
+		Score scoreAffine(const ColumnPatterns& patterns) const;
+		Score scoreSubstitutions(const std::string& column) const;
+
+		static size_t countBits(Word w);
 		
 	public:
 		SumOfPairsScorer(const PairwiseAlignmentScorer<Score>& pairwiseScorer);
+
+		// Scores each pair as AffineGapPairwiseAlignmentScorer would, but
+		// scores all pairs together in one pass over the columns.
+		// Substitutions are scored once per column pattern from the counts
+		// of each character pair, and gap opens are found with bitsets of
+		// the pairs that are currently in a gap.
+		SumOfPairsScorer(const ScoringMatrix<Score>& matrix,
+						 const Score& space,
+						 const Score& gap);
 		
 		Score score(const MultipleAlignment& pa) const;
+
+		Score score(const ColumnPatterns& patterns) const;
 	};
 
 	template<typename Score>
 	SumOfPairsScorer<Score>::
     SumOfPairsScorer(const PairwiseAlignmentScorer<Score>& pairwiseScorer)
-		: pairwiseScorer(pairwiseScorer) {
+		: pairwiseScorer(&pairwiseScorer), matrix(NULL), space(), gap() {
+	}
+
+	template<typename Score>
+	SumOfPairsScorer<Score>::
+    SumOfPairsScorer(const ScoringMatrix<Score>& matrix,
+					 const Score& space,
+					 const Score& gap)
+		: pairwiseScorer(NULL), matrix(&matrix), space(space), gap(gap) {
 	}
 	
 	template<typename Score>
 	Score
 	SumOfPairsScorer<Score>::
     score(const MultipleAlignment& ma) const {
+		if (matrix != NULL) {
+			return scoreAffine(ColumnPatterns(ma));
+		}
+
 		Score sum = 0;
 		for (size_t i = 0; i < ma.getNumSeqs(); ++i) {
 			for (size_t j = i + 1; j < ma.getNumSeqs(); ++j) {
 				PairwiseAlignment pa(ma.getSeq(i), ma.getSeq(j));
-				sum += pairwiseScorer.score(pa);
+				sum += pairwiseScorer->score(pa);
+			}
+		}
+		return sum;
+	}
+
+	template<typename Score>
+	Score
+	SumOfPairsScorer<Score>::
+    score(const ColumnPatterns& patterns) const {
+		return matrix != NULL ? scoreAffine(patterns) : scorePairwise(patterns);
+	}
+
+	template<typename Score>
+	Score
+	SumOfPairsScorer<Score>::
+    scorePairwise(const ColumnPatterns& patterns) const {
+		// Expand the patterns back into rows for the pairwise scorer
+		std::vector<std::string> rows(patterns.getNumSeqs(),
+									  std::string(patterns.getNumCols(), ' '));
+		for (size_t t = 0; t < patterns.getNumCols(); ++t) {
+			const std::string& column =
+				patterns.getPattern(patterns.getPatternIndex(t));
+			for (size_t i = 0; i < rows.size(); ++i) {
+				rows[i][t] = column[i];
+			}
+		}
+
+		Score sum = 0;
+		for (size_t i = 0; i < rows.size(); ++i) {
+			for (size_t j = i + 1; j < rows.size(); ++j) {
+				PairwiseAlignment pa(rows[i], rows[j]);
+				sum += pairwiseScorer->score(pa);
 			}
 		}
 		return sum;
 	}
 
+	template<typename Score>
+	inline size_t
+	SumOfPairsScorer<Score>::
+	countBits(Word w) {
+#ifdef __GNUC__
+		return __builtin_popcountl(w);
+#else
+		size_t n = 0;
+		for (; w != 0; w &= w - 1) { ++n; }
+		return n;
+#endif
+	}
+
+	template<typename Score>
+	Score
+	SumOfPairsScorer<Score>::
+    scoreSubstitutions(const std::string& column) const {
+		// Number the distinct characters of the column
+		int index[256];
+		std::fill(index, index + 256, -1);
+		std::string chars;
+		for (size_t i = 0; i < column.size(); ++i) {
+			unsigned char c = column[i];
+			if (c == '-') { continue; }
+			if (index[c] == -1) {
+				index[c] = chars.size();
+				chars.push_back(c);
+			}
+		}
+
+		// Count the pairs i < j with each (column[i], column[j]), so that
+		// asymmetric matrices are scored as they are pairwise
+		const size_t k = chars.size();
+		std::vector<size_t> seen(k, 0);
+		std::vector<size_t> pairs(k * k, 0);
+		for (size_t i = 0; i < column.size(); ++i) {
+			unsigned char c = column[i];
+			if (c == '-') { continue; }
+			size_t b = index[c];
+			for (size_t a = 0; a < k; ++a) {
+				pairs[a * k + b] += seen[a];
+			}
+			++seen[b];
+		}
+
+		Score result = 0;
+		for (size_t a = 0; a < k; ++a) {
+			for (size_t b = 0; b < k; ++b) {
+				if (pairs[a * k + b] == 0) { continue; }
+				result += (matrix->getCharScore(chars[a], chars[b]) *
+						   static_cast<Score>(pairs[a * k + b]));
+			}
+		}
+		return result;
+	}
+
+	template<typename Score>
+	Score
+	SumOfPairsScorer<Score>::
+    scoreAffine(const ColumnPatterns& patterns) const {
+		const size_t numSeqs = patterns.getNumSeqs();
+		const size_t numPatterns = patterns.getNumPatterns();
+		const size_t numWords = (numSeqs + WORD_BITS - 1) / WORD_BITS;
+
+		// Substitutions and spaces depend only on the column, so they are
+		// counted once per pattern.  Each pattern also gets a bitset of
+		// its gapped sequences.
+		Score sum = 0;
+		Score numSpaces = 0;
+		std::vector<Word> gapMasks(numPatterns * numWords, 0);
+		std::vector< std::vector<size_t> > gapped(numPatterns);
+		for (size_t p = 0; p < numPatterns; ++p) {
+			const std::string& column = patterns.getPattern(p);
+			Score count = static_cast<Score>(patterns.getCount(p));
+			sum += scoreSubstitutions(column) * count;
+			for (size_t i = 0; i < numSeqs; ++i) {
+				if (column[i] == '-') {
+					gapMasks[p * numWords + i / WORD_BITS] |=
+						Word(1) << (i % WORD_BITS);
+					gapped[p].push_back(i);
+				}
+			}
+			Score numGaps = static_cast<Score>(gapped[p].size());
+			numSpaces +=
+				numGaps * (static_cast<Score>(numSeqs) - numGaps) * count;
+		}
+		sum += numSpaces * space;
+
+		// Bit j of open[i] is set when the pair (i, j) is in a run of
+		// columns where i is gapped and j is not.  Only sequences gapped
+		// in the last column can have bits set, since an ungapped column
+		// ends all of a sequence's gaps.  Columns gapped in both sequences
+		// of a pair leave its state unchanged.
+		Word lastMask = numSeqs % WORD_BITS == 0 ? ~Word(0) :
+			(Word(1) << (numSeqs % WORD_BITS)) - 1;
+		std::vector<Word> open(numSeqs * numWords, 0);
+		Score numOpens = 0;
+		const std::vector<size_t>* prevGapped = NULL;
+		for (size_t t = 0; t < patterns.getNumCols(); ++t) {
+			size_t p = patterns.getPatternIndex(t);
+			const Word* gaps = &gapMasks[p * numWords];
+
+			if (prevGapped != NULL) {
+				for (size_t n = 0; n < prevGapped->size(); ++n) {
+					size_t i = (*prevGapped)[n];
+					if ((gaps[i / WORD_BITS] >> (i % WORD_BITS) & 1) == 0) {
+						std::fill(&open[i * numWords],
+								  &open[i * numWords] + numWords, Word(0));
+					}
+				}
+			}
+
+			for (size_t n = 0; n < gapped[p].size(); ++n) {
+				Word* o = &open[gapped[p][n] * numWords];
+				for (size_t w = 0; w < numWords; ++w) {
+					Word mask = w + 1 == numWords ? lastMask : ~Word(0);
+					numOpens += countBits(~gaps[w] & ~o[w] & mask);
+					o[w] = (o[w] & gaps[w]) | (~gaps[w] & mask);
+				}
+			}
+			prevGapped = &gapped[p];
+		}
+		sum += numOpens * gap;
+
+		return sum;
+	}
+
 } }
 
 #endif // __BIO_ALIGNMENT_SUMOFPAIRSSCORER_HH__
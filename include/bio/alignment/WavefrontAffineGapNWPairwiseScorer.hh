@@ -0,0 +1,439 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_ALIGNMENT_WAVEFRONTAFFINEGAPNWPAIRWISESCORER_HH__
+#define __BIO_ALIGNMENT_WAVEFRONTAFFINEGAPNWPAIRWISESCORER_HH__
+
+#include <vector>
+#include <algorithm>
+
+#include "bio/alignment/AffineGapNWPairwiseScorer.hh"
+#include "util/thread.hh"
+
+namespace bio { namespace alignment {
+
+	// An AffineGapNWPairwiseScorer that fills in the dynamic programming
+	// matrix with several threads, for semirings such as polytopes whose
+	// operations are expensive.  The matrix is cut into square tiles.  A
+	// tile can be scored once the tiles above it and to its left are
+	// done, so the tiles along each anti-diagonal run at the same time.
+	// Every cell is computed with the same operations, in the same
+	// order, as in the serial scorer, so the results are identical.  Only
+	// the rows and columns on tile boundaries are kept, so memory use
+	// stays linear in the sequence lengths.
+	//
+	// The semiring operations must be safe to call from several threads
+	// at once on different elements.
+	template<typename SemiRing>
+	class WavefrontAffineGapNWPairwiseScorer
+		: public AffineGapNWPairwiseScorer<SemiRing> {
+	public:
+		typedef AffineGapNWPairwiseScorer<SemiRing> Base;
+		typedef typename Base::Score Score;
+		typedef typename Base::ScoreList ScoreList;
+
+		// Uses numThreads threads, or one per processor if numThreads is
+		// zero.  With one thread, this is the same as the serial scorer.
+		WavefrontAffineGapNWPairwiseScorer(const SemiRing& semiRing,
+										   const ScoringMatrix<Score>& matrix,
+										   const Score& space,
+										   const Score& gap,
+										   size_t numThreads = 0,
+										   size_t tileSize =
+										   DEFAULT_TILE_SIZE);
+
+		Score score(const std::string& seq1,
+					const std::string& seq2) const;
+
+		void scoreLastRow(const std::string& seq1,
+						  const std::string& seq2,
+						  ScoreList& matchRow,
+						  ScoreList& gap1Row,
+						  ScoreList& gap2Row,
+						  size_t startState = Base::MATCH) const;
+
+		void scoreFirstRow(const std::string& seq1,
+						   const std::string& seq2,
+						   ScoreList& matchRow,
+						   ScoreList& gap1Row,
+						   ScoreList& gap2Row,
+						   size_t endState = (Base::MATCH |
+											  Base::GAP1 |
+											  Base::GAP2)) const;
+
+		static const size_t DEFAULT_TILE_SIZE = 16;
+
+	private:
+		struct Cell {
+			Score match;
+			Score deletion;
+			Score insertion;
+		};
+
+		typedef std::vector<Cell> CellList;
+
+		class Wavefront;
+		class TileTask;
+
+		// Scores row r, column c of the matrix from the cells above,
+		// diagonally before and before it in the same row.  The
+		// backward recursion is done on the matrix reversed in both
+		// directions, which gives it the same shape as the forward one.
+		void scoreCell(bool forward,
+					   const std::string& seq1,
+					   const std::string& seq2,
+					   size_t r, size_t c,
+					   const Cell& up, const Cell* diag, const Cell* left,
+					   Cell& out) const;
+
+		// Replaces row with the last row of the matrix whose first row
+		// it holds
+		void scoreRows(bool forward,
+					   const std::string& seq1,
+					   const std::string& seq2,
+					   CellList& row) const;
+
+		size_t numThreads;
+		size_t tileSize;
+	};
+
+	// The state shared by the tiles of one matrix
+	template<typename SemiRing>
+	class WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront {
+	public:
+		Wavefront(const WavefrontAffineGapNWPairwiseScorer& scorer,
+				  bool forward,
+				  const std::string& seq1,
+				  const std::string& seq2,
+				  size_t tileSize,
+				  CellList& firstRow,
+				  util::thread::ThreadPool& pool)
+			: scorer(scorer), forward(forward), seq1(seq1), seq2(seq2),
+			  tileSize(tileSize),
+			  numRows(seq1.size()), numCols(firstRow.size()),
+			  numRowTiles((numRows + tileSize - 1) / tileSize),
+			  numColTiles((numCols + tileSize - 1) / tileSize),
+			  bottoms(numColTiles), rights(numRowTiles),
+			  numWaiting(numRowTiles * numColTiles), pool(pool), m() {
+			for (size_t bj = 0; bj < numColTiles; ++bj) {
+				size_t c0 = bj * tileSize;
+				size_t c1 = std::min(numCols, c0 + tileSize);
+				bottoms[bj].assign(firstRow.begin() + c0,
+								   firstRow.begin() + c1);
+			}
+			for (size_t bi = 0; bi < numRowTiles; ++bi) {
+				for (size_t bj = 0; bj < numColTiles; ++bj) {
+					numWaiting[bi * numColTiles + bj] =
+						(bi > 0 ? 1 : 0) + (bj > 0 ? 1 : 0);
+				}
+			}
+		}
+
+		void start();
+		void scoreTile(size_t bi, size_t bj);
+		void finishTile(size_t bi, size_t bj);
+		void getLastRow(CellList& row) const;
+
+	private:
+		void release(size_t bi, size_t bj);
+
+		const WavefrontAffineGapNWPairwiseScorer& scorer;
+		bool forward;
+		const std::string& seq1;
+		const std::string& seq2;
+		size_t tileSize;
+		size_t numRows;
+		size_t numCols;
+		size_t numRowTiles;
+		size_t numColTiles;
+		// The last row scored in each column of tiles
+		std::vector<CellList> bottoms;
+		// The last column scored in each row of tiles, preceded by the
+		// cell above it
+		std::vector<CellList> rights;
+		// The number of unfinished tiles that each tile depends on
+		std::vector<size_t> numWaiting;
+		util::thread::ThreadPool& pool;
+		util::thread::Mutex m;
+	};
+
+	template<typename SemiRing>
+	class WavefrontAffineGapNWPairwiseScorer<SemiRing>::TileTask
+		: public util::thread::Task {
+	public:
+		TileTask(Wavefront& wavefront, size_t bi, size_t bj)
+			: wavefront(wavefront), bi(bi), bj(bj) {}
+
+		void run() {
+			wavefront.scoreTile(bi, bj);
+			wavefront.finishTile(bi, bj);
+		}
+
+	private:
+		Wavefront& wavefront;
+		size_t bi;
+		size_t bj;
+	};
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront::start() {
+		if (numRowTiles > 0) {
+			pool.add(new TileTask(*this, 0, 0));
+		}
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront::
+	scoreTile(size_t bi, size_t bj) {
+		// Rows are numbered from 1, as row 0 is the first row
+		size_t r0 = bi * tileSize + 1;
+		size_t r1 = std::min(numRows + 1, r0 + tileSize);
+		size_t c0 = bj * tileSize;
+		size_t w = bottoms[bj].size();
+
+		// Element k of a row holds column c0 + k - 1
+		CellList up(w + 1), curr(w + 1);
+		std::copy(bottoms[bj].begin(), bottoms[bj].end(), up.begin() + 1);
+		if (bj > 0) {
+			up[0] = rights[bi][0];
+		}
+
+		CellList right(r1 - r0 + 1);
+		right[0] = up[w];
+		for (size_t r = r0; r < r1; ++r) {
+			if (bj > 0) {
+				curr[0] = rights[bi][r - r0 + 1];
+			}
+			for (size_t k = 1; k <= w; ++k) {
+				size_t c = c0 + k - 1;
+				scorer.scoreCell(forward, seq1, seq2, r, c, up[k],
+								 c > 0 ? &up[k - 1] : 0,
+								 c > 0 ? &curr[k - 1] : 0,
+								 curr[k]);
+			}
+			right[r - r0 + 1] = curr[w];
+			up.swap(curr);
+		}
+
+		bottoms[bj].assign(up.begin() + 1, up.end());
+		rights[bi].swap(right);
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront::
+	release(size_t bi, size_t bj) {
+		if (--numWaiting[bi * numColTiles + bj] == 0) {
+			pool.add(new TileTask(*this, bi, bj));
+		}
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront::
+	finishTile(size_t bi, size_t bj) {
+		util::thread::Lock lock(m);
+		if (bi + 1 < numRowTiles) {
+			release(bi + 1, bj);
+		}
+		if (bj + 1 < numColTiles) {
+			release(bi, bj + 1);
+		}
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::Wavefront::
+	getLastRow(CellList& row) const {
+		row.clear();
+		for (size_t bj = 0; bj < numColTiles; ++bj) {
+			row.insert(row.end(), bottoms[bj].begin(), bottoms[bj].end());
+		}
+	}
+
+	template<typename SemiRing>
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	WavefrontAffineGapNWPairwiseScorer(const SemiRing& semiRing,
+									   const ScoringMatrix<Score>& matrix,
+									   const Score& space,
+									   const Score& gap,
+									   size_t numThreads,
+									   size_t tileSize)
+		: Base(semiRing, matrix, space, gap),
+		  numThreads(numThreads == 0 ? util::thread::numProcessors() : numThreads),
+		  tileSize(std::max(tileSize, size_t(1))) {
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	scoreCell(bool forward,
+			  const std::string& seq1,
+			  const std::string& seq2,
+			  size_t r, size_t c,
+			  const Cell& up, const Cell* diag, const Cell* left,
+			  Cell& out) const {
+		if (forward) {
+			if (c == 0) {
+				out.match = out.insertion = this->semiRing.getZero();
+			} else {
+				out.match = diag->match;
+				out.match += diag->deletion;
+				out.match += diag->insertion;
+				out.match *= this->matrix.getCharScore(seq1[r - 1],
+													   seq2[c - 1]);
+
+				out.insertion = left->match;
+				out.insertion += left->deletion;
+				out.insertion *= this->insertionGap;
+				out.insertion += left->insertion;
+				out.insertion *= this->insertionSpace;
+			}
+
+			out.deletion = up.match;
+			out.deletion += up.insertion;
+			out.deletion *= this->deletionGap;
+			out.deletion += up.deletion;
+			out.deletion *= this->deletionSpace;
+		} else {
+			size_t tRow = seq1.size() - r;
+			size_t tCol = seq2.size() - c;
+
+			out.deletion = up.deletion;
+			out.deletion *= this->deletionSpace;
+			out.match = out.insertion = out.deletion * this->deletionGap;
+
+			if (c > 0) {
+				Score diagScore =
+					diag->match * this->matrix.getCharScore(seq1[tRow],
+															seq2[tCol]);
+				out.match = out.insertion += diagScore;
+				out.deletion += diagScore;
+
+				out.match += (left->insertion * this->insertionGap *
+							  this->insertionSpace);
+				out.deletion += (left->insertion * this->insertionGap *
+								 this->insertionSpace);
+				out.insertion += left->insertion * this->insertionSpace;
+			}
+		}
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	scoreRows(bool forward,
+			  const std::string& seq1,
+			  const std::string& seq2,
+			  CellList& row) const {
+		util::thread::ThreadPool pool(numThreads);
+		Wavefront wavefront(*this, forward, seq1, seq2, tileSize, row, pool);
+		wavefront.start();
+		pool.wait();
+		wavefront.getLastRow(row);
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	scoreLastRow(const std::string& seq1,
+				 const std::string& seq2,
+				 ScoreList& fromMatch,
+				 ScoreList& fromDeletion,
+				 ScoreList& fromInsertion,
+				 size_t startState) const {
+		if (numThreads == 1 or seq1.empty()) {
+			Base::scoreLastRow(seq1, seq2, fromMatch, fromDeletion,
+							   fromInsertion, startState);
+			return;
+		}
+
+		// Score the first row, then the rest in parallel
+		Base::scoreLastRow("", seq2, fromMatch, fromDeletion, fromInsertion,
+						   startState);
+
+		CellList row(fromMatch.size());
+		for (size_t j = 0; j < row.size(); ++j) {
+			row[j].match = fromMatch[j];
+			row[j].deletion = fromDeletion[j];
+			row[j].insertion = fromInsertion[j];
+		}
+
+		scoreRows(true, seq1, seq2, row);
+
+		for (size_t j = 0; j < row.size(); ++j) {
+			fromMatch[j] = row[j].match;
+			fromDeletion[j] = row[j].deletion;
+			fromInsertion[j] = row[j].insertion;
+		}
+	}
+
+	template<typename SemiRing>
+	void
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	scoreFirstRow(const std::string& seq1,
+				  const std::string& seq2,
+				  ScoreList& fromMatch,
+				  ScoreList& fromDeletion,
+				  ScoreList& fromInsertion,
+				  size_t endState) const {
+		if (numThreads == 1 or seq1.empty()) {
+			Base::scoreFirstRow(seq1, seq2, fromMatch, fromDeletion,
+								fromInsertion, endState);
+			return;
+		}
+
+		// Score the last row, then the rest in parallel on the reversed
+		// matrix
+		Base::scoreFirstRow("", seq2, fromMatch, fromDeletion, fromInsertion,
+							endState);
+
+		size_t m = seq2.size();
+		CellList row(m + 1);
+		for (size_t j = 0; j <= m; ++j) {
+			row[m - j].match = fromMatch[j];
+			row[m - j].deletion = fromDeletion[j];
+			row[m - j].insertion = fromInsertion[j];
+		}
+
+		scoreRows(false, seq1, seq2, row);
+
+		for (size_t j = 0; j <= m; ++j) {
+			fromMatch[j] = row[m - j].match;
+			fromDeletion[j] = row[m - j].deletion;
+			fromInsertion[j] = row[m - j].insertion;
+		}
+	}
+
+	template<typename SemiRing>
+	typename WavefrontAffineGapNWPairwiseScorer<SemiRing>::Score
+	WavefrontAffineGapNWPairwiseScorer<SemiRing>::
+	score(const std::string& seq1,
+		  const std::string& seq2) const {
+		ScoreList fromMatch, fromDeletion, fromInsertion;
+		scoreLastRow(seq1, seq2, fromMatch, fromDeletion, fromInsertion,
+					 Base::MATCH);
+		return fromMatch.back() + fromDeletion.back() + fromInsertion.back();
+	}
+
+} }
+
+#endif // __BIO_ALIGNMENT_WAVEFRONTAFFINEGAPNWPAIRWISESCORER_HH__
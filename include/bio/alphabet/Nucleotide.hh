@@ -78,6 +78,7 @@ namespace bio { namespace alphabet {
 
 		static void hardMaskInPlace(std::string& seq);
 		static std::string hardMask(std::string seq);
+		static char hardMask(const char base);
 
 		static void unMaskInPlace(std::string& seq);
 		static std::string unMask(std::string seq);
@@ -92,6 +93,10 @@ namespace bio { namespace alphabet {
 	inline char Nucleotide::complement(const char base) const {
 		return complementer(base);
 	}
+
+	inline char Nucleotide::hardMask(const char base) {
+		return hardMasker(base);
+	}
 		
 	inline unsigned char Nucleotide::getSize() const {
 		return decoder.decoding.size();
@@ -0,0 +1,148 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_FORMATS_AGP_ASSEMBLER_HH__
+#define __BIO_FORMATS_AGP_ASSEMBLER_HH__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <iosfwd>
+
+#include "bio/formats/agp/Record.hh"
+#include "bio/formats/fasta/Constants.hh"
+#include "bio/formats/fasta/IndexedFile.hh"
+#include "bio/sdb.hh"
+
+namespace bio { namespace formats { namespace agp {
+
+	// Builds the sequences described by a set of AGP records.  Each
+	// assembled sequence is produced in chunks whose components are
+	// read from a Source only when the chunk is filled, so neither the
+	// source sequences nor a whole assembled sequence need to be held
+	// in memory.  Chunks are filled by a pool of threads and handed
+	// to a Sink in order.  Positions not covered by a component are
+	// filled with 'N'.
+	class Assembler {
+	public:
+		static const size_t DEFAULT_CHUNK_SIZE;
+
+		// Supplies component sequences.  getSeq may be called from
+		// several threads at once.
+		class Source {
+		public:
+			virtual ~Source() {}
+			// Return bases [START, END) of sequence NAME, reverse
+			// complemented if STRAND is '-'
+			virtual std::string getSeq(const std::string& name,
+									   const size_t start,
+									   const size_t end,
+									   const char strand) = 0;
+		};
+
+		// Receives assembled sequences: beginSeq, then the sequence in
+		// one or more appendSeq calls, then endSeq.  Called from one
+		// thread only.
+		class Sink {
+		public:
+			virtual ~Sink() {}
+			virtual void beginSeq(const std::string& name,
+								  const size_t length) = 0;
+			virtual void appendSeq(const std::string& seq) = 0;
+			virtual void endSeq() = 0;
+		};
+
+		// Reads components from an SDB database
+		class SDBSource : public Source {
+		public:
+			explicit SDBSource(SDB::SharedDB& db) : db(db) {}
+			std::string getSeq(const std::string& name,
+							   const size_t start,
+							   const size_t end,
+							   const char strand);
+		private:
+			SDB::SharedDB& db;
+		};
+
+		// Reads components from an indexed FASTA file
+		class FastaSource : public Source {
+		public:
+			explicit FastaSource(fasta::IndexedFile& file) : file(file) {}
+			std::string getSeq(const std::string& name,
+							   const size_t start,
+							   const size_t end,
+							   const char strand);
+		private:
+			fasta::IndexedFile& file;
+		};
+
+		// Writes assembled sequences as FASTA records
+		class FastaSink : public Sink {
+		public:
+			explicit FastaSink(std::ostream& strm,
+							   const size_t lineWidth=fasta::Constants::DEFAULT_LINE_WIDTH);
+			void beginSeq(const std::string& name, const size_t length);
+			void appendSeq(const std::string& seq);
+			void endSeq();
+		private:
+			std::ostream& strm;
+			size_t lineWidth;
+			size_t column;
+		};
+
+		// Writes assembled sequences as records of an SDB database
+		class SDBSink : public Sink {
+		public:
+			explicit SDBSink(SDB::DB& db, const bool compressed=false)
+				: db(db), compressed(compressed) {}
+			void beginSeq(const std::string& name, const size_t length);
+			void appendSeq(const std::string& seq);
+			void endSeq();
+		private:
+			SDB::DB& db;
+			bool compressed;
+		};
+
+		void addRecord(const Record& rec);
+
+		// Store in NAMES the source sequences used by the records
+		void getSourceNames(std::set<std::string>& names) const;
+
+		// Assemble every sequence, in order of name, using NUMTHREADS
+		// threads (0 for one per processor)
+		void assemble(Source& source,
+					  Sink& sink,
+					  const size_t numThreads=1,
+					  const size_t chunkSize=DEFAULT_CHUNK_SIZE);
+
+	private:
+		struct Chrom;
+		struct Chunk;
+		class FillTask;
+
+		static void prepare(Chrom& chrom);
+		static void fill(Source& source, Chunk& chunk);
+
+		std::map<std::string, std::vector<Record> > chromRecs;
+	};
+
+} } }
+
+#endif // __BIO_FORMATS_AGP_ASSEMBLER_HH__
@@ -0,0 +1,83 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_FORMATS_FASTA_INDEXEDFILE_HH__
+#define __BIO_FORMATS_FASTA_INDEXEDFILE_HH__
+
+#include <cstdio>
+#include <string>
+#include <sys/types.h>
+
+#include "boost/unordered_map.hpp"
+
+#include "bio/alphabet/AmbiguousNucleotide.hh"
+#include "filesystem/Path.hh"
+#include "util/thread.hh"
+
+namespace bio { namespace formats { namespace fasta {
+
+	// Random access to the records of a FASTA file on disk.  Every
+	// sequence line of a record except the last must have the same
+	// length, as for samtools faidx.  Records are looked up by name,
+	// which is the first word of the title, whether the index is read
+	// from a FILE.fai written by samtools or built by scanning the
+	// file.  getLength and getSeq may be called from several threads
+	// at once.
+	class IndexedFile {
+	public:
+		IndexedFile();
+		~IndexedFile();
+
+		void open(const filesystem::Path& filename);
+		void close();
+
+		bool hasSeq(const std::string& title) const;
+		size_t getLength(const std::string& title) const;
+
+		// Return the bases in [START, END) of a record, reverse
+		// complemented if STRAND is '-'
+		std::string getSeq(const std::string& title,
+						   const size_t start,
+						   const size_t end,
+						   const char strand='+',
+						   const alphabet::Nucleotide& alphabet=alphabet::AmbiguousDNA);
+
+	private:
+		struct Entry {
+			size_t length;
+			off_t offset;
+			size_t lineBases;
+			size_t lineBytes;
+		};
+
+		void readIndex(const filesystem::Path& indexFilename);
+		void buildIndex(const filesystem::Path& filename);
+		const Entry& lookup(const std::string& title) const;
+
+		FILE* strm;
+		util::thread::Mutex mutex;
+		boost::unordered_map<std::string, Entry> entries;
+
+		IndexedFile(const IndexedFile&);
+		IndexedFile& operator=(const IndexedFile&);
+	};
+
+} } }
+
+#endif // __BIO_FORMATS_FASTA_INDEXEDFILE_HH__
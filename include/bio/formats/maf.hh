@@ -25,6 +25,8 @@
 #include "bio/formats/maf/Header.hh"
 #include "bio/formats/maf/InputStream.hh"
 #include "bio/formats/maf/OutputStream.hh"
+#include "bio/formats/maf/Index.hh"
+#include "bio/formats/maf/Pipeline.hh"
 #include "bio/formats/maf/Constants.hh"
 
 #endif // __BIO_FORMATS_MAF_HH__
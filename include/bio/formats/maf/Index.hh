@@ -0,0 +1,120 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_FORMATS_MAF_INDEX_HH__
+#define __BIO_FORMATS_MAF_INDEX_HH__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "boost/unordered_map.hpp"
+
+#include "bio/genome/Interval.hh"
+#include "bio/formats/maf/types.hh"
+
+namespace bio { namespace formats { namespace maf {
+
+	// An index of the alignment blocks of a MAF file by the intervals
+	// of their sequences.  For each src, the intervals of the blocks
+	// are kept sorted by start, with the file offsets of the blocks, so
+	// that the blocks overlapping a region of any src can be found
+	// without reading the file.
+	//
+	// The index is written as text: a "#mafindex" line followed by one
+	// "src start end offset" line per sequence of each block, with
+	// forward strand, zero-based, half-open coordinates.
+	class Index {
+	public:
+		Index();
+
+		// Indexes the blocks of the MAF read from strm.  Offsets are
+		// counted from the current position of strm.
+		void build(std::istream& strm);
+
+		void read(std::istream& strm);
+		void write(std::ostream& strm) const;
+
+		// Adds a block with a sequence covering interval i.  sort()
+		// must be called after adding blocks and before querying.
+		void add(const genome::Interval& i, std::streamoff offset);
+		void sort();
+
+		// Appends the offsets of the blocks with a sequence overlapping
+		// region to offsets, in order of sequence start
+		void getOffsets(const genome::Interval& region,
+						std::vector<std::streamoff>& offsets) const;
+
+		bool hasSrc(const std::string& src) const;
+
+	private:
+		struct Entry {
+			genome::Position start;
+			genome::Position end;
+			std::streamoff offset;
+			bool operator<(const Entry& e) const { return start < e.start; }
+		};
+
+		// Entries of one src, sorted by start, with the running maximum
+		// of their ends
+		struct SrcIndex {
+			std::vector<Entry> entries;
+			std::vector<genome::Position> maxEnds;
+		};
+
+		typedef boost::unordered_map<std::string, SrcIndex> SrcMap;
+
+		static const std::string HEADER;
+
+		SrcMap srcs;
+		bool sorted;
+	};
+
+	// Reads the blocks of a MAF file that overlap a set of regions
+	// through an Index.  Each block is read once, in file order, even
+	// if it overlaps several regions.
+	class IndexedReader {
+	public:
+		IndexedReader(std::istream& strm,
+					  const Index& index,
+					  bool lazyText = false);
+		~IndexedReader();
+
+		const Header& getHeader() const;
+
+		void addRegion(const genome::Interval& region);
+
+		// Reads the next overlapping block into rec, returning false
+		// when there are no more
+		bool next(Record& rec);
+
+	private:
+		IndexedReader(const IndexedReader&);
+		IndexedReader& operator=(const IndexedReader&);
+
+		const Index& index;
+		InputStream* input;
+		std::vector<std::streamoff> offsets;
+		size_t nextOffset;
+		bool sorted;
+	};
+
+} } }
+
+#endif // __BIO_FORMATS_MAF_INDEX_HH__
@@ -21,6 +21,8 @@
 #define __BIO_FORMATS_MAF_INPUTSTREAM_HH__
 
 #include <iosfwd>
+#include <string>
+#include <deque>
 
 #include "bio/formats/maf/types.hh"
 #include "bio/formats/maf/Header.hh"
@@ -29,9 +31,22 @@
 
 namespace bio { namespace formats { namespace maf {
 
+	// Reads MAF records.  Sequence lines are tokenized in place, and the
+	// sequences of the record being read into are reused, so that
+	// reading records of similar shape does not allocate.
+	//
+	// With lazyText set, the alignment text of each sequence is not
+	// copied but left as a view into the stream's line buffers (see
+	// Sequence::getText), which is cheaper when most text is never
+	// examined or is written out unchanged.
 	class InputStream : private Constants {
 	public:
-		InputStream(std::istream& strm);
+		InputStream(std::istream& strm, bool lazyText = false);
+
+		// Reads records from input that has no header of its own, such
+		// as a run of paragraphs taken from a stream with the given header
+		InputStream(std::istream& strm, const Header& header,
+					bool lazyText = false);
 		
 		const Header& getHeader() const;
 
@@ -39,15 +54,36 @@ namespace bio { namespace formats { namespace maf {
 		operator bool() const;
 		bool operator!() const;
 
+		// Offset in the input of the alignment line of the last record
+		// read
+		std::streamoff getRecordOffset() const;
+
+		// Continues reading at the given offset of the input (which
+		// must be seekable), such as one returned by getRecordOffset
+		void seek(std::streamoff offset);
+
+		// Appends the lines of the next paragraph, unparsed and each
+		// terminated by a newline, followed by a blank line to text.
+		// Returns false if there are no more paragraphs.
+		bool readParagraph(std::string& text);
+
 	private:
 		void readHeader();
 		void skipToNextParagraph();
+		bool readLine();
 		static void parseVariables(const std::string& s, VariableMap& m);
+		void parseSequence(Sequence& seq, size_t seqNum);
 		
 		util::io::line::InputStream strm;
 		std::string line;
 		Header header;
 		bool hasNewRecord;
+		bool lazyText;
+		std::streamoff lineOffset;
+		std::streamoff recordOffset;
+		// Sequence lines of the last record read in lazy mode (a deque,
+		// so that adding lines does not move those already viewed)
+		std::deque<std::string> seqLines;
 	};
 
 } } }
@@ -32,6 +32,9 @@ namespace bio { namespace formats { namespace maf {
     class OutputStream : private Constants {
 	public:
 		OutputStream(std::ostream& strm, const Header& header = Header());
+		// Writes records only, as after a header written by another
+		// OutputStream
+		explicit OutputStream(std::ostream& strm, bool writeHeader);
 		OutputStream& operator<<(const Record& rec);
 		OutputStream& operator<<(const std::string& s);
 		operator bool() const;
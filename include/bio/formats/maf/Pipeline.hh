@@ -0,0 +1,69 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_FORMATS_MAF_PIPELINE_HH__
+#define __BIO_FORMATS_MAF_PIPELINE_HH__
+
+#include <iosfwd>
+#include <cstddef>
+
+#include "bio/formats/maf/types.hh"
+
+namespace bio { namespace formats { namespace maf {
+
+	// Applies a transform to each alignment block of a MAF stream,
+	// writing the blocks it keeps in input order.  Blocks are
+	// independent, so the input is split into chunks of whole blocks
+	// that are parsed, transformed and formatted by a pool of threads;
+	// only the splitting into paragraphs and the writing of finished
+	// chunks is done serially.
+	class Pipeline {
+	public:
+		// Called on each block, possibly from several threads at once.
+		// Returns false if the block should be dropped.
+		class Transform {
+		public:
+			virtual ~Transform() {}
+			virtual bool operator()(Record& rec) const = 0;
+		};
+
+		// Uses numThreads threads, or one per processor if numThreads
+		// is zero.  With one thread, blocks are processed in the
+		// calling thread without chunking.
+		explicit Pipeline(size_t numThreads = 0,
+						  bool lazyText = false,
+						  size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+		void run(std::istream& in, std::ostream& out,
+				 const Transform& transform) const;
+
+		static const size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+	private:
+		void runSerial(std::istream& in, std::ostream& out,
+					   const Transform& transform) const;
+
+		size_t numThreads;
+		bool lazyText;
+		size_t chunkSize;
+	};
+
+} } }
+
+#endif // __BIO_FORMATS_MAF_PIPELINE_HH__
@@ -21,6 +21,7 @@
 #define __BIO_FORMATS_MAF_SEQUENCE_HH__
 
 #include <string>
+#include <cstddef>
 
 #include "bio/genome/MutableInterval.hh"
 
@@ -32,7 +33,23 @@ namespace bio { namespace formats { namespace maf {
 		size_t size;
 		genome::Strand strand;
 		genome::Distance srcSize;
-		std::string text;
+
+		Sequence();
+
+		// Copies hold their own text, even if the original is a view
+		Sequence(const Sequence& other);
+		Sequence& operator=(const Sequence& other);
+
+		// A sequence read by a lazy InputStream holds its alignment text
+		// as a view into the stream's buffers, which is valid until the
+		// next record is read.  getText() copies the view into a string
+		// owned by the sequence the first time it is called; the
+		// non-const version returns that string for editing.
+		const std::string& getText() const;
+		std::string& getText();
+		size_t getTextSize() const;
+		const char* getTextData() const;
+		void setTextView(const char* data, size_t size);
 		
 		std::string getChrom() const;
 		genome::Position getStart() const;
@@ -48,9 +65,39 @@ namespace bio { namespace formats { namespace maf {
 		void setStart(const genome::Position start);
 		void setEnd(const genome::Position end);
 		void setStrand(const genome::Strand strand);
-		
+
+	private:
+		mutable std::string text;
+		mutable const char* textView;
+		size_t textViewSize;
 	};
 
+	inline const std::string& Sequence::getText() const {
+		if (textView != NULL) {
+			text.assign(textView, textViewSize);
+			textView = NULL;
+		}
+		return text;
+	}
+
+	inline std::string& Sequence::getText() {
+		static_cast<const Sequence&>(*this).getText();
+		return text;
+	}
+
+	inline size_t Sequence::getTextSize() const {
+		return textView != NULL ? textViewSize : text.size();
+	}
+
+	inline const char* Sequence::getTextData() const {
+		return textView != NULL ? textView : text.data();
+	}
+
+	inline void Sequence::setTextView(const char* data, size_t size) {
+		textView = data;
+		textViewSize = size;
+	}
+
 } } }
 
 #endif // __BIO_FORMATS_MAF_SEQUENCE_HH__
@@ -27,6 +27,7 @@ namespace bio { namespace formats { namespace maf {
 	class Record;
 	class Header;
 	class InputStream;
+	struct Sequence;
 
 } } }
 
@@ -0,0 +1,182 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_GENOME_BATCHMAPPER_HH__
+#define __BIO_GENOME_BATCHMAPPER_HH__
+
+#include <vector>
+#include <algorithm>
+
+#include "bio/genome/Interval.hh"
+#include "bio/genome/BasicInterval.hh"
+#include "util/thread.hh"
+
+namespace bio { namespace genome {
+
+	// Maps a batch of intervals on a pool of worker threads.  Each
+	// interval is first split into pieces, one per group (e.g. a
+	// homology map segment or an AGP contig) that it must be mapped
+	// through.  All pieces belonging to the same group are mapped by the
+	// same worker, one group after another, so a worker may cache
+	// expensive per-group state such as an alignment.  The mappings of
+	// the pieces are reported for each interval in input order, and for
+	// each interval in the order its groups were listed by getGroups.
+	//
+	// Group must be copyable and less-than comparable.
+	template<typename Group>
+	class BatchMapper {
+	public:
+		// Per-thread mapping state.  A worker is only ever used by one
+		// thread at a time.
+		class Worker {
+		public:
+			virtual ~Worker() {}
+			virtual void map(const Interval& i,
+							 const Group& group,
+							 std::vector<BasicInterval>& mapped) = 0;
+		};
+
+		// Uses one thread per processor if numThreads is zero
+		explicit BatchMapper(size_t numThreads = 0)
+			: numThreads(numThreads) {}
+
+		virtual ~BatchMapper() {}
+
+		void map(const std::vector<const Interval*>& intervals,
+				 std::vector< std::vector<BasicInterval> >& mapped);
+
+	protected:
+		// Appends the groups that interval i must be mapped through
+		virtual void getGroups(const Interval& i,
+							   std::vector<Group>& groups) const = 0;
+
+		// Returns a new worker, to be owned by the caller
+		virtual Worker* newWorker() const = 0;
+
+	private:
+		struct Piece {
+			Group group;
+			size_t interval;
+			size_t rank;
+			const Interval* source;
+			std::vector<BasicInterval> mapped;
+
+			bool operator<(const Piece& other) const {
+				return group < other.group;
+			}
+		};
+
+		class WorkerTask : public util::thread::Task {
+		public:
+			WorkerTask(Worker* worker,
+					   std::vector<Piece>& pieces,
+					   const std::vector<size_t>& groupStarts,
+					   util::thread::Counter& counter)
+				: worker(worker), pieces(pieces), groupStarts(groupStarts),
+				  counter(counter) {}
+
+			~WorkerTask() { delete worker; }
+
+			void run() {
+				size_t g;
+				while (counter.next(g)) {
+					for (size_t p = groupStarts[g]; p < groupStarts[g + 1]; ++p) {
+						worker->map(*pieces[p].source, pieces[p].group,
+									pieces[p].mapped);
+					}
+				}
+			}
+
+		private:
+			Worker* worker;
+			std::vector<Piece>& pieces;
+			const std::vector<size_t>& groupStarts;
+			util::thread::Counter& counter;
+		};
+
+		size_t numThreads;
+	};
+
+	template<typename Group>
+	void BatchMapper<Group>::map(const std::vector<const Interval*>& intervals,
+								 std::vector< std::vector<BasicInterval> >& mapped) {
+		mapped.clear();
+		mapped.resize(intervals.size());
+
+		// Split intervals into pieces.  The pieces of interval i
+		// initially occupy positions firstPiece[i] to firstPiece[i + 1].
+		std::vector<Piece> pieces;
+		std::vector<size_t> firstPiece;
+		firstPiece.reserve(intervals.size() + 1);
+		std::vector<Group> groups;
+		for (size_t i = 0; i < intervals.size(); ++i) {
+			firstPiece.push_back(pieces.size());
+			groups.clear();
+			getGroups(*intervals[i], groups);
+			for (size_t g = 0; g < groups.size(); ++g) {
+				pieces.push_back(Piece());
+				pieces.back().group = groups[g];
+				pieces.back().interval = i;
+				pieces.back().rank = g;
+				pieces.back().source = intervals[i];
+			}
+		}
+		firstPiece.push_back(pieces.size());
+
+		if (pieces.empty()) { return; }
+
+		// Bring the pieces of each group together
+		std::stable_sort(pieces.begin(), pieces.end());
+		std::vector<size_t> groupStarts(1, 0);
+		for (size_t p = 1; p < pieces.size(); ++p) {
+			if (pieces[p - 1] < pieces[p]) {
+				groupStarts.push_back(p);
+			}
+		}
+		groupStarts.push_back(pieces.size());
+		size_t numGroups = groupStarts.size() - 1;
+
+		// Map groups on worker threads
+		util::thread::ThreadPool pool(std::min(numThreads == 0
+											   ? util::thread::numProcessors()
+											   : numThreads,
+											   numGroups));
+		util::thread::Counter counter(numGroups);
+		for (size_t w = 0; w < pool.size(); ++w) {
+			pool.add(new WorkerTask(newWorker(), pieces, groupStarts, counter));
+		}
+		pool.wait();
+
+		// Gather mapped pieces back into input order
+		std::vector<const Piece*> inputOrder(pieces.size());
+		for (size_t p = 0; p < pieces.size(); ++p) {
+			inputOrder[firstPiece[pieces[p].interval] + pieces[p].rank] = &pieces[p];
+		}
+		for (size_t i = 0; i < intervals.size(); ++i) {
+			for (size_t p = firstPiece[i]; p < firstPiece[i + 1]; ++p) {
+				mapped[i].insert(mapped[i].end(),
+								 inputOrder[p]->mapped.begin(),
+								 inputOrder[p]->mapped.end());
+			}
+		}
+	}
+
+} }
+
+#endif // __BIO_GENOME_BATCHMAPPER_HH__
@@ -23,7 +23,7 @@
 #include <string>
 #include <istream>
 #include <ostream>
-#include <list>
+#include <vector>
 
 #include "bio/genome/BasicInterval.hh"
 #include "util/io.hh"
@@ -31,16 +31,20 @@
 
 namespace bio { namespace gff {
 
+	class GFFTable;
+
 	class GFFRecord {
 	public:
 		typedef float Score;
 
 		struct Attribute {
 			std::string tag;
-			std::list<std::string> values;
+			std::vector<std::string> values;
 		};
 		
 		GFFRecord();
+		GFFRecord(const GFFRecord& r);
+		GFFRecord& operator=(const GFFRecord& r);
 		
 		const std::string& getSeqname() const;
 		const std::string& getSource() const;
@@ -80,10 +84,21 @@ namespace bio { namespace gff {
 		friend void operator>>(const std::string& tag, GFFRecord& r);
 
 		bool operator<(const GFFRecord& r) const;
+
+		// Approximate number of bytes taken by a copy of this record,
+		// including the attribute strings it owns but not the shared
+		// seqname, source and feature strings
+		size_t getMemorySize() const;
 		
 	private:
+		friend class GFFTable;
+
 		typedef boost::unordered_map<std::string, const std::string*> StringMap;
-		typedef std::list<Attribute> AttributeList;
+		// Attributes are stored in the first numAttributes slots of a
+		// flat vector.  Slots beyond those are kept (with their string
+		// capacity) for reuse when the next record is parsed into this
+		// one, so that steady-state parsing does not allocate.
+		typedef std::vector<Attribute> AttributeList;
 
 		struct AttributeFinder {
 			const std::string& tag;
@@ -93,7 +108,14 @@ namespace bio { namespace gff {
 
 		const std::string* storeString(const std::string& s,
 									   StringMap& strmap);
+		static const std::string* storeString(const char* begin,
+											  const char* end,
+											  const std::string* current,
+											  StringMap& strmap);
 		void parseAttributes() const;
+		void writeAttributes(std::ostream& strm) const;
+		Attribute& nextAttributeSlot() const;
+		AttributeList::iterator findAttribute(const std::string& tag) const;
 		
 		static const std::string THE_EMPTY_STRING;
 		static StringMap seqnames;
@@ -110,6 +132,7 @@ namespace bio { namespace gff {
 		char frame;
 		mutable std::string attributeString;
 		mutable AttributeList attributes;
+		mutable size_t numAttributes;
 		
 		bool validScore;
 	};
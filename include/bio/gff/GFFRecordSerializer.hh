@@ -0,0 +1,36 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __GFF_RECORD_SERIALIZER_HH__
+#define __GFF_RECORD_SERIALIZER_HH__
+
+#include "bio/gff/GFFRecord.hh"
+#include "util/sort.hh"
+
+namespace bio { namespace gff {
+
+	// Serializer for sorting GFF records with util::sort, which counts
+	// the attribute strings a record owns toward the sort buffer size
+	struct GFFRecordSerializer : public util::sort::StreamSerializer<GFFRecord> {
+		size_t size(const GFFRecord& r) const { return r.getMemorySize(); }
+	};
+
+} }
+
+#endif // __GFF_RECORD_SERIALIZER_HH__
@@ -0,0 +1,204 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __GFF_TABLE_HH__
+#define __GFF_TABLE_HH__
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "bio/gff/GFFRecord.hh"
+#include "boost/unordered_map.hpp"
+
+namespace bio { namespace gff {
+
+	// An in-memory table of GFF records stored by column.  Seqnames,
+	// sources and features are interned as small integer IDs local to
+	// the table, the numeric fields are kept in parallel arrays, and the
+	// (unparsed) attribute text of all rows is kept in one arena string.
+	// This uses much less memory than a vector of GFFRecords and makes
+	// scans over a single column cheap.
+	//
+	// The helpers below work on lists of row numbers, so that a table
+	// can be sorted, filtered and grouped without moving its columns.
+	class GFFTable {
+	public:
+		typedef unsigned int Id;
+		typedef size_t Row;
+		typedef std::vector<Row> RowList;
+
+		enum Column { SEQNAME, SOURCE, FEATURE };
+
+		static const Id NO_ID;
+
+		GFFTable();
+
+		void push_back(const GFFRecord& rec);
+		void clear();
+		size_t size() const;
+		bool empty() const;
+
+		// Approximate number of bytes used by the rows of the table
+		size_t memoryUsage() const;
+
+		Id getSeqnameId(Row r) const;
+		Id getSourceId(Row r) const;
+		Id getFeatureId(Row r) const;
+		Id getId(Column c, Row r) const;
+		const std::string& getSeqname(Row r) const;
+		const std::string& getSource(Row r) const;
+		const std::string& getFeature(Row r) const;
+		genome::Position getStart(Row r) const;
+		genome::Position getEnd(Row r) const;
+		GFFRecord::Score getScore(Row r) const;
+		bool hasScore(Row r) const;
+		char getStrand(Row r) const;
+		char getFrame(Row r) const;
+		std::string getAttributeString(Row r) const;
+
+		// Number of distinct values of a column, and the value of an ID
+		// (NO_ID if the value does not occur in the table)
+		size_t getNumIds(Column c) const;
+		const std::string& getName(Column c, Id id) const;
+		Id findId(Column c, const std::string& name) const;
+
+		// Copies a row into a record
+		void getRecord(Row r, GFFRecord& rec) const;
+
+		// Writes a row in GFF format, as a GFFRecord would be written
+		void write(std::ostream& strm, Row r) const;
+
+		// Stores the numbers of all rows in rows
+		void getRows(RowList& rows) const;
+
+		// Stably sorts rows by seqname, start, and end
+		void sortByPosition(RowList& rows) const;
+
+		// Removes the rows for which pred(table, row) is false,
+		// keeping the order of the others
+		template<typename Predicate>
+		void filter(RowList& rows, Predicate pred) const;
+
+		// Removes the rows whose value of column c is not id
+		void filterById(RowList& rows, Column c, Id id) const;
+
+		// Stably groups rows by their value of column c, in order of
+		// ID.  The rows of group i are then
+		// [rows[groupStarts[i]], rows[groupStarts[i + 1]]), and its
+		// value is that of any of them.
+		void groupBy(RowList& rows,
+					 Column c,
+					 std::vector<size_t>& groupStarts) const;
+
+	private:
+		// Interned strings of one column
+		class StringPool {
+		public:
+			Id intern(const std::string& s);
+			Id find(const std::string& s) const;
+			const std::string& getName(Id id) const { return names[id]; }
+			size_t size() const { return names.size(); }
+			void clear();
+		private:
+			typedef boost::unordered_map<std::string, Id> IdMap;
+			std::vector<std::string> names;
+			IdMap ids;
+			std::string lastName;
+			Id lastId;
+		};
+
+		struct PositionLessThan;
+
+		const StringPool& getPool(Column c) const;
+		const std::vector<Id>& getIds(Column c) const;
+
+		StringPool seqnamePool, sourcePool, featurePool;
+		std::vector<Id> seqnames, sources, features;
+		std::vector<genome::Position> starts, ends;
+		std::vector<GFFRecord::Score> scores;
+		std::vector<unsigned char> validScores;
+		std::vector<char> strands, frames;
+		std::string attributeArena;
+		std::vector<size_t> attributeEnds;
+	};
+
+	inline size_t GFFTable::size() const { return starts.size(); }
+	inline bool GFFTable::empty() const { return starts.empty(); }
+
+	inline GFFTable::Id GFFTable::getSeqnameId(Row r) const {
+		return seqnames[r];
+	}
+	inline GFFTable::Id GFFTable::getSourceId(Row r) const {
+		return sources[r];
+	}
+	inline GFFTable::Id GFFTable::getFeatureId(Row r) const {
+		return features[r];
+	}
+	inline GFFTable::Id GFFTable::getId(Column c, Row r) const {
+		return getIds(c)[r];
+	}
+	inline const std::string& GFFTable::getSeqname(Row r) const {
+		return seqnamePool.getName(seqnames[r]);
+	}
+	inline const std::string& GFFTable::getSource(Row r) const {
+		return sourcePool.getName(sources[r]);
+	}
+	inline const std::string& GFFTable::getFeature(Row r) const {
+		return featurePool.getName(features[r]);
+	}
+	inline genome::Position GFFTable::getStart(Row r) const {
+		return starts[r];
+	}
+	inline genome::Position GFFTable::getEnd(Row r) const {
+		return ends[r];
+	}
+	inline GFFRecord::Score GFFTable::getScore(Row r) const {
+		return scores[r];
+	}
+	inline bool GFFTable::hasScore(Row r) const { return validScores[r]; }
+	inline char GFFTable::getStrand(Row r) const { return strands[r]; }
+	inline char GFFTable::getFrame(Row r) const { return frames[r]; }
+
+	inline size_t GFFTable::getNumIds(Column c) const {
+		return getPool(c).size();
+	}
+	inline const std::string& GFFTable::getName(Column c, Id id) const {
+		return getPool(c).getName(id);
+	}
+	inline GFFTable::Id GFFTable::findId(Column c,
+										 const std::string& name) const {
+		return getPool(c).find(name);
+	}
+
+	template<typename Predicate>
+	void GFFTable::filter(RowList& rows, Predicate pred) const {
+		RowList::iterator out = rows.begin();
+		for (RowList::const_iterator r = rows.begin(); r != rows.end(); ++r) {
+			if (pred(*this, *r)) {
+				*out = *r;
+				++out;
+			}
+		}
+		rows.erase(out, rows.end());
+	}
+
+} }
+
+#endif // __GFF_TABLE_HH__
@@ -0,0 +1,60 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_HOMOLOGYMAP_BATCHHOMOLOGYMAPPER_HH__
+#define __BIO_HOMOLOGYMAP_BATCHHOMOLOGYMAPPER_HH__
+
+#include "bio/genome/BatchMapper.hh"
+#include "bio/homologymap/HomologyMapper.hh"
+
+namespace bio { namespace homologymap {
+
+	// Maps batches of intervals through a homology map, grouping the
+	// intervals by segment so that each segment alignment is read only
+	// once per batch.  Each worker thread owns its own alignment.
+	class BatchHomologyMapper : public genome::BatchMapper<const Segment*> {
+	public:
+		BatchHomologyMapper(const HomologyMapper& mapper,
+							size_t numThreads = 0);
+
+	protected:
+		void getGroups(const genome::Interval& i,
+					   std::vector<const Segment*>& segs) const;
+		Worker* newWorker() const;
+
+	private:
+		class SegmentWorker : public Worker {
+		public:
+			SegmentWorker(const HomologyMapper& mapper);
+			void map(const genome::Interval& i,
+					 const Segment* const& seg,
+					 std::vector<genome::BasicInterval>& mapped);
+		private:
+			const HomologyMapper& mapper;
+			alignment::BasicNamedMultipleAlignment align;
+			const Segment* alignSeg;
+			bool alignRead;
+		};
+
+		const HomologyMapper& mapper;
+	};
+
+} }
+
+#endif // __BIO_HOMOLOGYMAP_BATCHHOMOLOGYMAPPER_HH__
@@ -50,16 +50,37 @@ namespace bio { namespace homologymap {
 		void setTargetGenome(const std::string& targetGenome);
 		void setSourceGenome(const std::string& sourceGenome);
 
+		// The following methods do not modify the mapper and may be
+		// called concurrently, each thread supplying its own alignment.
+
+		// Appends the segments that interval i (in the source genome)
+		// must be mapped through to reach the target genome
+		void getSegments(const genome::Interval& i,
+						 std::vector<Segment*>& segs) const;
+
+		// Reads the alignment of a segment.  Returns false if the
+		// alignment file could not be opened.
+		bool readAlignment(size_t segmentNum,
+						   alignment::BasicNamedMultipleAlignment& segAlign) const;
+
+		// Maps interval i through segment seg, whose alignment is segAlign.
+		// Returns false if i maps to an empty interval.
+		bool mapSegment(const Segment& seg,
+						const alignment::BasicNamedMultipleAlignment& segAlign,
+						const genome::Interval& i,
+						genome::BasicInterval& mapped) const;
+
 	private:
 		size_t getIndex(const std::string& g) const;
 		bool readAlignment(size_t segmentNum);	
-		void flipInterval(alignment::Interval& i, size_t length);
-		void getInterval(genome::Interval* segSourceInt,
-						 genome::Interval* segTargetInt,
-						 int alignSourceNum,
-						 int alignTargetNum,
-						 const genome::Interval& sourceInterval,
-						 genome::BasicInterval& targetInterval);
+		static void flipInterval(alignment::Interval& i, size_t length);
+		static void getInterval(const alignment::BasicNamedMultipleAlignment& align,
+								genome::Interval* segSourceInt,
+								genome::Interval* segTargetInt,
+								int alignSourceNum,
+								int alignTargetNum,
+								const genome::Interval& sourceInterval,
+								genome::BasicInterval& targetInterval);
 
 		static const std::string GENOMES_FILENAME;
 		static const std::string MAP_FILENAME;
@@ -0,0 +1,151 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_KMER_KMERCOUNTER_HH__
+#define __BIO_KMER_KMERCOUNTER_HH__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "util/thread.hh"
+
+namespace bio { namespace kmer {
+
+	// A k-mer of up to 31 bases, packed two bits per base with the last
+	// base in the lowest bits (A = 0, C = 1, G = 2, T = 3)
+	typedef uint64_t Kmer;
+
+	// Counts the k-mers of DNA sequences in a hash table divided into
+	// shards, each with its own lock, so that sequences can be added from
+	// several threads at once.  The table grows with the number of
+	// distinct k-mers rather than holding a counter for each of the 4^k
+	// possible ones.
+	class KmerCounter {
+	public:
+		static const size_t MAX_K = 31;
+
+		// If CANONICAL, a k-mer and its reverse complement are counted
+		// together.  If SKIPN, k-mers with a base other than A, C, G or T
+		// are ignored; otherwise such bases are replaced by a base that
+		// depends only on their position in the sequence.
+		KmerCounter(size_t k, bool canonical = true, bool skipN = false);
+		~KmerCounter();
+
+		size_t getK() const { return k; }
+
+		// Counts the k-mers of SEQ, or those lying within [START, END)
+		// of it.  May be called from several threads at once, but not
+		// at the same time as getCount().
+		void add(const std::string& seq);
+		void add(const std::string& seq, size_t start, size_t end);
+
+		// Counts are saturated at the largest uint32_t
+		uint32_t getCount(Kmer kmer) const;
+
+		size_t getNumDistinct() const;
+
+		// Calls visitor(end, kmer) for each k-mer of SEQ, or of those
+		// lying within [START, END) of it, in order, where END is the
+		// position just past its last base
+		template<typename Visitor>
+		void scan(const std::string& seq, Visitor& visitor) const;
+		template<typename Visitor>
+		void scan(const std::string& seq,
+				  size_t start,
+				  size_t end,
+				  Visitor& visitor) const;
+
+	private:
+		struct Shard;
+		class Adder;
+
+		static const size_t SHARD_BITS = 6;
+		static const Kmer EMPTY = ~Kmer(0);
+
+		static uint64_t hash(Kmer kmer);
+		static int encode(char c);
+
+		size_t k;
+		bool canonical;
+		bool skipN;
+		std::vector<Shard*> shards;
+
+		KmerCounter(const KmerCounter&);
+		KmerCounter& operator=(const KmerCounter&);
+	};
+
+	inline int KmerCounter::encode(char c) {
+		switch (c) {
+		case 'A': case 'a': return 0;
+		case 'C': case 'c': return 1;
+		case 'G': case 'g': return 2;
+		case 'T': case 't': return 3;
+		default: return -1;
+		}
+	}
+
+	template<typename Visitor>
+	inline void KmerCounter::scan(const std::string& seq,
+								  Visitor& visitor) const {
+		scan(seq, 0, seq.size(), visitor);
+	}
+
+	template<typename Visitor>
+	void KmerCounter::scan(const std::string& seq,
+						   size_t start,
+						   size_t end,
+						   Visitor& visitor) const {
+		const Kmer mask = (Kmer(1) << (2 * k)) - 1;
+		const size_t rcShift = 2 * (k - 1);
+		Kmer forward = 0, reverse = 0;
+		size_t numValid = 0;
+		for (size_t i = start; i < end; ++i) {
+			int base = encode(seq[i]);
+			if (base < 0) {
+				if (skipN) {
+					numValid = 0;
+					continue;
+				}
+				// A fixed base for each position, so that a sequence
+				// always has the same k-mers
+				base = static_cast<int>(hash(i) >> 62);
+			}
+			forward = ((forward << 2) | base) & mask;
+			reverse = (reverse >> 2) | (Kmer(3 - base) << rcShift);
+			if (++numValid >= k) {
+				visitor(i + 1, (canonical and reverse < forward) ?
+						reverse : forward);
+			}
+		}
+	}
+
+	// The finalizer of MurmurHash3, which mixes all bits of a k-mer
+	inline uint64_t KmerCounter::hash(Kmer kmer) {
+		kmer ^= kmer >> 33;
+		kmer *= 0xff51afd7ed558ccdULL;
+		kmer ^= kmer >> 33;
+		kmer *= 0xc4ceb9fe1a85ec53ULL;
+		kmer ^= kmer >> 33;
+		return kmer;
+	}
+
+} }
+
+#endif // __BIO_KMER_KMERCOUNTER_HH__
@@ -29,6 +29,7 @@
 #include "bio/alphabet/Nucleotide.hh"
 #include "bio/alphabet/AmbiguousNucleotide.hh"
 #include "filesystem/Path.hh"
+#include "util/thread.hh"
 
 namespace bio {
 
@@ -117,6 +118,14 @@ namespace SDB {
 		void putRec(const std::string& title,
 					const std::string& sequence,
 					const bool compressed=false);
+
+		// Write a record piece by piece: beginRec, any number of
+		// appendSeq calls, then endRec.  No other record may be
+		// written until the open record has been ended.
+		void beginRec(const std::string& title,
+					  const bool compressed=false);
+		void appendSeq(const std::string& sequence);
+		void endRec();
 		
 		void getRec(const std::string& title, Record& rec);
 		void getRec(const unsigned int recNum, Record& rec);
@@ -198,12 +207,42 @@ namespace SDB {
 		unsigned int indexSize;
 
 		std::vector<Record*> recs;
+
+		// Record being written by beginRec/appendSeq, and the last
+		// base appended to it if that base has not yet been paired
+		// with another for nib compression
+		Record* openRec;
+		std::string unpairedBase;
 	
 		static const unsigned int MAGIC_NUMBER;
 		static const unsigned int VERSION;
 
 		friend class Record;
 	};
+
+	// A database opened for reading whose sequences may be read from
+	// several threads at once.  Reads of the database file are made one
+	// at a time, while reverse complementing is done by the calling
+	// thread.
+	class SharedDB {
+	public:
+		// If LOADINDEX is true, the whole index is read into memory
+		// now rather than searched on disk for each lookup
+		void open(const filesystem::Path& filename, bool loadIndex=false);
+
+		std::string getSeq(const std::string& title,
+						   const unsigned int start,
+						   const unsigned int end,
+						   const char strand='+',
+						   const alphabet::Nucleotide& alphabet=alphabet::AmbiguousDNA);
+
+		std::string getSeq(const genome::Interval& i,
+						   const alphabet::Nucleotide& alphabet=alphabet::AmbiguousDNA);
+
+	private:
+		DB db;
+		util::thread::Mutex mutex;
+	};
 	
 };
 
@@ -0,0 +1,83 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __BIO_TRANSLATION_ORFSCANNER_HH__
+#define __BIO_TRANSLATION_ORFSCANNER_HH__
+
+#include <string>
+#include <vector>
+
+#include "bio/translation/Table.hh"
+
+namespace bio { namespace translation {
+
+	// Translates codons of A, C, G and T through a 64-entry table indexed
+	// by a rolling 6-bit code of the codon, and only uses the full Table
+	// for codons with other bases.  Finds ORFs in all six frames in one
+	// pass over a sequence without translating it to protein strings.
+	class OrfScanner {
+	public:
+		// An ORF as a half-open interval of positions on the forward
+		// strand
+		struct Orf {
+			size_t start;
+			size_t end;
+			char strand;
+		};
+		typedef std::vector<Orf> OrfList;
+
+		OrfScanner(size_t tableNum);
+		OrfScanner(const Table* table);
+
+		// Gives the same protein as Table::translate
+		std::string translate(const std::string& seq,
+							  const unsigned int phase=0,
+							  const bool toStop=false) const;
+
+		// Finds the maximal runs of codons in each frame that translate
+		// to neither a stop nor X, of at least MINLENGTH bases.  ORFs are
+		// listed for the forward frames and then the reverse frames, each
+		// frame numbered from the start of its strand, and within a frame
+		// in order along its strand.
+		void findOrfs(const std::string& seq,
+					  size_t minLength,
+					  OrfList& orfs) const;
+
+	private:
+		static int encode(char c);
+		void init();
+
+		const Table* table;
+		char codons[64];
+		bool breaksOrf[64];
+	};
+
+	inline int OrfScanner::encode(char c) {
+		switch (c) {
+		case 'A': case 'a': return 0;
+		case 'C': case 'c': return 1;
+		case 'G': case 'g': return 2;
+		case 'T': case 't': return 3;
+		default: return -1;
+		}
+	}
+
+} }
+
+#endif // __BIO_TRANSLATION_ORFSCANNER_HH__
@@ -49,7 +49,8 @@ namespace filesystem {
 		void copyTo(const Path& target) const;
 
 		void openForInput(std::ifstream& strm) const;
-		void openForOutput(std::ofstream& strm) const;
+		void openForOutput(std::ofstream& strm,
+						   std::ios::openmode mode = std::ios::out) const;
 		
 		class Error : public std::runtime_error {
 		public:
@@ -23,13 +23,14 @@
 #include <vector>
 
 #include "polytope/Vector.hh"
+#include "polytope/numbers.hh"
 
+#ifndef POLYTOPE_NATIVE
 // Polymake includes
-#include <Rational.h>
-#include <Integer.h>
 #include <Matrix.h>
 #include <Bitset.h>
 #include <cdd_interface.h>
+#endif
 
 namespace polytope {
 
@@ -57,9 +58,11 @@ namespace polytope {
 		void reduceRays();
 		void computeFacets();
 
+#ifndef POLYTOPE_NATIVE
 		static Ray ratToInt(const Vector<Rational>& ratRay);
 
 		static polymake::polytope::cdd_interface::solver<Rational> CDDSolver;
+#endif
 		
 		RayList rays;
 		FacetList facets;
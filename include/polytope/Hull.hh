@@ -0,0 +1,81 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __POLYTOPE_HULL_HH__
+#define __POLYTOPE_HULL_HH__
+
+#include <vector>
+
+#include "polytope/Vector.hh"
+#include "polytope/numbers.hh"
+
+namespace polytope {
+
+	// The exact convex hull of the cone generated by a set of integer
+	// vectors, computed by the double description method.  A polytope is
+	// handled through its homogenization: a point p is given as (1, p).
+	//
+	// The generators are first projected onto coordinates that are
+	// independent on their linear span, so that lower dimensional inputs
+	// (such as the alignment polytopes, which lie in a hyperplane) are
+	// treated as full dimensional.  The facets are then found as the
+	// extreme rays of the dual cone, adding one generator at a time; a
+	// generator strictly inside the hull of those before it is dropped
+	// as soon as it is seen.
+	//
+	// All arithmetic is on integers.  It is done with machine integers,
+	// which suffice for the small coordinates of alignment polytopes, and
+	// is redone with GMP integers if any result would overflow.
+	class Hull {
+	public:
+		typedef Vector<Integer> IntegerVector;
+		typedef std::vector<IntegerVector> VectorList;
+
+		explicit Hull(const VectorList& generators);
+
+		// Dimension of the linear span of the generators
+		size_t getDim() const;
+
+		// Inequalities f with f . g >= 0 for each generator g, one for
+		// each facet.  Each has coprime integer coefficients, which are
+		// zero outside the coordinates chosen for the span.
+		const VectorList& getFacets() const;
+
+		// Whether generator i spans an extreme ray (for a polytope,
+		// whether the point is a vertex)
+		bool isExtreme(size_t i) const;
+
+	private:
+		template<typename Number>
+		void compute(const VectorList& generators);
+
+		std::vector<size_t> spanCoords;
+		std::vector<bool> extreme;
+		VectorList facets;
+	};
+
+	inline size_t Hull::getDim() const { return spanCoords.size(); }
+
+	inline const Hull::VectorList& Hull::getFacets() const { return facets; }
+
+	inline bool Hull::isExtreme(size_t i) const { return extreme[i]; }
+
+}
+
+#endif // __POLYTOPE_HULL_HH__
@@ -27,10 +27,14 @@
 
 #include "polytope/Vector.hh"
 #include "polytope/Cone.hh"
+#include "polytope/numbers.hh"
+#include "util/thread.hh"
+#include "util/timer.hh"
 
+#ifdef POLYTOPE_NATIVE
+#include "polytope/Hull.hh"
+#else
 // Polymake includes
-#include <Rational.h>
-#include <Integer.h>
 #include <Matrix.h>
 #include <Bitset.h>
 #include <lrs_interface.h>
@@ -40,6 +44,7 @@
 extern "C" {
 #include "qhull/qhull_a.h"
 }
+#endif // POLYTOPE_NATIVE
 
 namespace polytope {
 
@@ -87,9 +92,35 @@ namespace polytope {
 		friend std::ostream& operator<<(std::ostream& strm,
 										const Polytope<C>& p);
 
+		// Only has an effect with the polymake backend, which uses qhull
 		static void setQhullLogFile(const std::string& filename);
 
+		// Statistics on the reduction of point sets to their vertices,
+		// gathered over all polytopes of this type since the last reset
+		struct ReductionStats {
+			ReductionStats();
+			size_t numReductions;
+			// Total numbers of points before and after the reductions
+			size_t pointsIn;
+			size_t pointsOut;
+			// Most points held by a sum or product before its reduction
+			size_t peakNumPoints;
+			// Wall clock seconds spent finding vertices and facets
+			double hullTime;
+		};
+
+		static ReductionStats getReductionStats();
+		static void resetReductionStats();
+
 	protected:
+		static void notePoints(size_t numPoints);
+		static void noteReduction(size_t numIn, size_t numOut,
+								  double seconds);
+		static void noteHullTime(double seconds);
+
+		static util::thread::Mutex statsMutex;
+		static ReductionStats stats;
+
 		static bool isRightTurn2D(const Vector<T>& v1,
 								  const Vector<T>& v2,
 								  const Vector<T>& v3);
@@ -103,26 +134,33 @@ namespace polytope {
 		void removeRedundantPoints(const std::vector<bool>& redundant) const;
 		void ensureReduced() const;
 
+		void computeFacets() const;
+
+		void findValidDims(std::vector<size_t>& validDims) const;
+
+#ifdef POLYTOPE_NATIVE
+		Hull::VectorList homogeneousPoints() const;
+		void setFacets(const Hull& hull) const;
+		bool redundantNative(std::vector<bool>& redundant) const;
+		void computeFacetsNative() const;
+#else
 		bool redundantQhull(std::vector<bool>& redundant) const;
 		template<typename Solver>
 		bool redundantPolymake(std::vector<bool>& redundant, Solver& s) const;
 		bool redundantCDD(std::vector<bool>& redundant) const;
 		bool redundantLRS(std::vector<bool>& redundant) const;
 
-		void computeFacets() const;
-
 		template<typename Solver>
 		void computeFacetsPolymake(Solver& s) const;
 		void computeFacetsCDD() const;
 		void computeFacetsLRS() const;
 
-		void findValidDims(std::vector<size_t>& validDims) const;
-		
 		polymake::Matrix<Rational> polymakePoints() const;
 
 		static polymake::polytope::lrs_interface::solver LRSSolver;
 		static polymake::polytope::cdd_interface::solver<Rational> CDDSolver;
 		static FILE* qhullLogFile;
+#endif // POLYTOPE_NATIVE
 
 		size_t ambientDim;
 		mutable VectorList vertices;
@@ -132,6 +170,10 @@ namespace polytope {
 		mutable bool facetsComputed;
     };
 
+#ifdef POLYTOPE_NATIVE
+	template<typename T>
+	void Polytope<T>::setQhullLogFile(const std::string& filename) {}
+#else
 	template<typename T>
 	polymake::polytope::lrs_interface::solver Polytope<T>::LRSSolver;
 
@@ -146,6 +188,59 @@ namespace polytope {
 		if (qhullLogFile != stderr) { fclose(qhullLogFile); }
 		qhullLogFile = fopen(filename.c_str(), "w");
 	}
+#endif // POLYTOPE_NATIVE
+
+	template<typename T>
+	Polytope<T>::ReductionStats::ReductionStats()
+		: numReductions(0), pointsIn(0), pointsOut(0), peakNumPoints(0),
+		  hullTime(0) {
+	}
+
+	template<typename T>
+	util::thread::Mutex Polytope<T>::statsMutex;
+
+	template<typename T>
+	typename Polytope<T>::ReductionStats Polytope<T>::stats;
+
+	template<typename T>
+	typename Polytope<T>::ReductionStats Polytope<T>::getReductionStats() {
+		util::thread::Lock lock(statsMutex);
+		return stats;
+	}
+
+	template<typename T>
+	void Polytope<T>::resetReductionStats() {
+		util::thread::Lock lock(statsMutex);
+		stats = ReductionStats();
+	}
+
+	// The statistics are updated under a lock, since polytopes may be
+	// combined by several threads at once.  Updates are made once per
+	// sum, product or reduction of multi-point polytopes, whose merging
+	// and hull computations cost far more than the lock.
+	template<typename T>
+	void Polytope<T>::notePoints(size_t numPoints) {
+		util::thread::Lock lock(statsMutex);
+		if (numPoints > stats.peakNumPoints) {
+			stats.peakNumPoints = numPoints;
+		}
+	}
+
+	template<typename T>
+	void Polytope<T>::noteReduction(size_t numIn, size_t numOut,
+									double seconds) {
+		util::thread::Lock lock(statsMutex);
+		++stats.numReductions;
+		stats.pointsIn += numIn;
+		stats.pointsOut += numOut;
+		stats.hullTime += seconds;
+	}
+
+	template<typename T>
+	void Polytope<T>::noteHullTime(double seconds) {
+		util::thread::Lock lock(statsMutex);
+		stats.hullTime += seconds;
+	}
 	
 	template<typename T>
 	size_t
@@ -292,11 +387,65 @@ namespace polytope {
 
 		removeRedundantPoints();
 
+		util::WallTimer timer;
+#ifdef POLYTOPE_NATIVE
+		// Removing redundant points may have found the facets already
+		if (not facetsComputed) { computeFacetsNative(); }
+#else
 		computeFacetsCDD();
+#endif
+		noteHullTime(timer.elapsed());
+
+		facetsComputed = true;
+	}
+
+#ifdef POLYTOPE_NATIVE
+	template<typename T>
+	Hull::VectorList Polytope<T>::homogeneousPoints() const {
+		Hull::VectorList points(vertices.size(),
+								Hull::IntegerVector(ambientDim + 1));
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			points[i][0] = 1;
+			for (size_t j = 0; j < ambientDim; ++j) {
+				points[i][j + 1] = vertices[i][j];
+			}
+		}
+		return points;
+	}
 
+	template<typename T>
+	void Polytope<T>::setFacets(const Hull& hull) const {
+		const Hull::VectorList& f = hull.getFacets();
+		facets.clear();
+		facets.resize(f.size(), Facet(ambientDim + 1));
+		for (size_t i = 0; i < f.size(); ++i) {
+			for (size_t j = 0; j < ambientDim + 1; ++j) {
+				facets[i][j] = f[i][j];
+			}
+		}
 		facetsComputed = true;
 	}
 
+	// The hull of the points gives the facets along with the vertices,
+	// so both are kept.
+	template<typename T>
+	bool Polytope<T>::redundantNative(std::vector<bool>& redundant) const {
+		Hull hull(homogeneousPoints());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			// Copies of a vertex (which are adjacent, as the points are
+			// sorted) all span the same ray, so all but one are dropped
+			redundant[i] = (not hull.isExtreme(i) or
+							(i > 0 and vertices[i] == vertices[i - 1]));
+		}
+		setFacets(hull);
+		return true;
+	}
+
+	template<typename T>
+	void Polytope<T>::computeFacetsNative() const {
+		setFacets(Hull(homogeneousPoints()));
+	}
+#else
 	template<typename T>
 	template<typename Solver>
 	void Polytope<T>::computeFacetsPolymake(Solver& s) const {
@@ -321,6 +470,7 @@ namespace polytope {
 	void Polytope<T>::computeFacetsLRS() const {
 		computeFacetsPolymake(LRSSolver);
 	}
+#endif // POLYTOPE_NATIVE
 
 	template<typename T>
 	const size_t Polytope<T>::getNumFacets() const {
@@ -380,10 +530,11 @@ namespace polytope {
 			}
 			
 			vertices.swap(newVertices);
+			notePoints(vertices.size());
 			combineDuplicatePoints();
 		}
 
-		reducedEnsured = reduced = false;
+		reducedEnsured = reduced = facetsComputed = false;
 		removeRedundantPoints();
 		return *this;
 	}
@@ -398,6 +549,7 @@ namespace polytope {
 			for (size_t i = 0; i < vertices.size(); ++i) {
 				vertices[i] += v;
 			}
+			facetsComputed = false;
 			return *this;
 		} else {
 			VectorList newVertices;
@@ -411,11 +563,12 @@ namespace polytope {
 			}
 
 			vertices.swap(newVertices);
+			notePoints(vertices.size());
 			
 			std::sort(vertices.begin(), vertices.end());
 			combineDuplicatePoints();
 
-			reducedEnsured = reduced = false;
+			reducedEnsured = reduced = facetsComputed = false;
 			removeRedundantPoints();
 			return *this;
 		}
@@ -430,6 +583,7 @@ namespace polytope {
 		if (not vertices.empty() and e == 0) {
 			vertices.resize(1);
 		}
+		facetsComputed = false;
 		return *this;
 	}
 
@@ -459,9 +613,16 @@ namespace polytope {
 		if (reducedEnsured) { return; }
 
 		if (vertices.size() > 2) {
+			util::WallTimer timer;
+			size_t numPoints = vertices.size();
 			std::vector<bool> redundant(vertices.size(), false);
+#ifdef POLYTOPE_NATIVE
+			redundantNative(redundant);
+#else
 			redundantCDD(redundant);
+#endif
 			removeRedundantPoints(redundant);
+			noteReduction(numPoints, vertices.size(), timer.elapsed());
 		}
 
 		reducedEnsured = reduced = true;
@@ -480,16 +641,24 @@ namespace polytope {
 // 		std::cerr << "Finding vertices among points ("
 // 				  << vertices.size() << ")...\n";
 		
+		util::WallTimer timer;
+		size_t numPoints = vertices.size();
 		std::vector<bool> redundant(vertices.size(), false);
 		
+#ifdef POLYTOPE_NATIVE
+		redundantNative(redundant);
+		reducedEnsured = true;
+#else
 		bool success = (vertices.size() > ambientDim and
 						redundantQhull(redundant));
 		if (not success) {
 			redundantCDD(redundant);
 			reducedEnsured = true;
 		}
+#endif
 
 		removeRedundantPoints(redundant);
+		noteReduction(numPoints, vertices.size(), timer.elapsed());
 		
 		reduced = true;
 	}
@@ -511,6 +680,7 @@ namespace polytope {
 		if (reduced) { return; }
 		if (n <= 2) { reduced = true; return; }
 
+		util::WallTimer timer;
 		std::vector<bool> redundant(n, true);
 
 		std::vector<int> side;
@@ -553,6 +723,7 @@ namespace polytope {
 		}
 
 		Polytope<T>::removeRedundantPoints(redundant);
+		noteReduction(n, vertices.size(), timer.elapsed());
 		reducedEnsured = true;
 		reduced = true;
 	}
@@ -593,6 +764,7 @@ namespace polytope {
 		}
 	}
 	
+#ifndef POLYTOPE_NATIVE
 	template<typename T>
 	bool Polytope<T>::redundantQhull(std::vector<bool>& redundant) const {
 		int dim;                  /* dimension of points */
@@ -677,6 +849,7 @@ namespace polytope {
 	bool Polytope<T>::redundantLRS(std::vector<bool>& redundant) const {
 		return redundantPolymake(redundant, LRSSolver);
 	}
+#endif // POLYTOPE_NATIVE
 
 	template<typename T>
 	std::ostream& operator<<(std::ostream& strm, const Polytope<T>& p) {
@@ -20,17 +20,49 @@
 #ifndef __POLYTOPE_VECTOR_HH__
 #define __POLYTOPE_VECTOR_HH__
 
-#include <valarray>
-#include <iosfwd>
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+
+#include "boost/type_traits/is_arithmetic.hpp"
 
 namespace polytope {
 
+	// Inline storage for the coordinates of a Vector.  Only arithmetic
+	// types are stored inline: for others, such as GMP numbers, building
+	// the unused slots of every vector would cost more than the
+	// allocation it saves.
+	template<typename T, bool Inline = boost::is_arithmetic<T>::value>
+	class VectorStorage {
+	public:
+		static const size_t INLINE_DIMS = 6;
+	protected:
+		T* buffer() { return local; }
+	private:
+		T local[INLINE_DIMS];
+	};
+
 	template<typename T>
-    class Vector {
+	class VectorStorage<T, false> {
 	public:
+		static const size_t INLINE_DIMS = 0;
+	protected:
+		T* buffer() { return NULL; }
+	};
+
+	// A vector whose coordinates are stored inline when there are at most
+	// INLINE_DIMS of them, as there are for nearly all polytopes we work
+	// with, so that creating and copying vertices does not allocate.
+	template<typename T>
+    class Vector : public VectorStorage<T> {
+	public:
+		using VectorStorage<T>::INLINE_DIMS;
+
 		static Vector<T> unit(size_t dims, size_t dim);
 		
 		Vector(size_t dims = 0);
+		Vector(const Vector& x);
+		~Vector();
 
 		Vector& operator=(const Vector& x);
 		
@@ -64,14 +96,73 @@ namespace polytope {
 		friend std::ostream& operator<<(std::ostream& strm, const Vector<S>& v);
 
 	private:
-		std::valarray<T> v;
+		void allocate(size_t dims);
+		T* copyOf(const Vector& x);
+		void release();
+
+		size_t n;
+		T* v;
     };
 
+	template<typename T>
+	inline void Vector<T>::allocate(size_t dims) {
+		n = dims;
+		v = (dims <= INLINE_DIMS ? this->buffer() : new T[dims]);
+	}
+
+	// Returns storage for the coordinates of X holding a copy of them,
+	// freeing any storage allocated here if copying throws
+	template<typename T>
+	T* Vector<T>::copyOf(const Vector& x) {
+		if (x.n <= INLINE_DIMS) {
+			std::copy(x.v, x.v + x.n, this->buffer());
+			return this->buffer();
+		}
+		T* copy = new T[x.n];
+		try {
+			std::copy(x.v, x.v + x.n, copy);
+		} catch (...) {
+			delete [] copy;
+			throw;
+		}
+		return copy;
+	}
+
+	template<typename T>
+	inline void Vector<T>::release() {
+		if (v != this->buffer()) { delete [] v; }
+	}
+
+	template<typename T>
+	Vector<T>::Vector(size_t dims) {
+		allocate(dims);
+		std::fill(v, v + n, T(0));
+	}
+
+	template<typename T>
+	Vector<T>::Vector(const Vector<T>& x)
+		: VectorStorage<T>(), n(x.n), v(copyOf(x)) {
+	}
+
+	template<typename T>
+	Vector<T>::~Vector() {
+		release();
+	}
+
+	// When the size changes, the new coordinates are copied before the
+	// old storage is freed, so that this vector is left intact if
+	// allocating or copying throws
 	template<typename T>
 	Vector<T>& Vector<T>::operator=(const Vector<T>& x) {
 		if (this == &x) { return *this; }
-		if (v.size() != x.v.size()) { v.resize(x.v.size()); }
-		v = x.v;
+		if (n != x.n) {
+			T* copy = copyOf(x);
+			release();
+			v = copy;
+			n = x.n;
+		} else {
+			std::copy(x.v, x.v + n, v);
+		}
 		return *this;
 	}
 	
@@ -82,54 +173,51 @@ namespace polytope {
 		return v;
 	}
 	
-	template<typename T>
-	Vector<T>::Vector(size_t dims) : v(dims) {}
-
 	template<typename T>
 	Vector<T>& Vector<T>::operator+=(const Vector& x) {
-		v += x.v;
+		for (size_t i = 0; i < n; ++i) { v[i] += x.v[i]; }
 		return *this;
 	}
 	
 	template<typename T>
 	Vector<T>& Vector<T>::operator+=(const T x) {
-		v += x;
+		for (size_t i = 0; i < n; ++i) { v[i] += x; }
 		return *this;
 	}
 
 	template<typename T>
 	Vector<T>& Vector<T>::operator-=(const Vector& x) {
-		v -= x.v;
+		for (size_t i = 0; i < n; ++i) { v[i] -= x.v[i]; }
 		return *this;
 	}
 	
 	template<typename T>
 	Vector<T>& Vector<T>::operator-=(const T x) {
-		v -= x;
+		for (size_t i = 0; i < n; ++i) { v[i] -= x; }
 		return *this;
 	}
 
 	template<typename T>
 	Vector<T>& Vector<T>::operator*=(const Vector& x) {
-		v *= x.v;
+		for (size_t i = 0; i < n; ++i) { v[i] *= x.v[i]; }
 		return *this;
 	}
 
 	template<typename T>
 	Vector<T>& Vector<T>::operator*=(const T x) {
-		v *= x;
+		for (size_t i = 0; i < n; ++i) { v[i] *= x; }
 		return *this;
 	}
 	
 	template<typename T>
 	Vector<T>& Vector<T>::operator/=(const Vector& x) {
-		v /= x.v;
+		for (size_t i = 0; i < n; ++i) { v[i] /= x.v[i]; }
 		return *this;
 	}
 
 	template<typename T>
 	Vector<T>& Vector<T>::operator/=(const T x) {
-		v /= x;
+		for (size_t i = 0; i < n; ++i) { v[i] /= x; }
 		return *this;
 	}
 
@@ -176,7 +264,7 @@ namespace polytope {
 	template<typename T>
 	bool
 	Vector<T>::operator<(const Vector& x) const {
-		for (size_t i = 0; i < v.size(); ++i) {
+		for (size_t i = 0; i < n; ++i) {
 			if (v[i] < x.v[i]) {
 				return true;
 			} else if (x.v[i] < v[i]) {
@@ -189,7 +277,7 @@ namespace polytope {
 	template<typename T>
 	bool
 	Vector<T>::operator==(const Vector& x) const {
-		for (size_t i = 0; i < v.size(); ++i) {
+		for (size_t i = 0; i < n; ++i) {
 			if (v[i] != x.v[i]) {
 				return false;
 			}
@@ -204,11 +292,11 @@ namespace polytope {
 	inline const T& Vector<T>::operator[](size_t i) const { return v[i]; }
 
 	template<typename T>
-	inline size_t Vector<T>::size() const { return v.size(); }
+	inline size_t Vector<T>::size() const { return n; }
 
 	template<typename T>
 	std::ostream& operator<<(std::ostream& strm, const Vector<T>& v) {
-		for (size_t i = 0; i < v.v.size(); ++i) {
+		for (size_t i = 0; i < v.n; ++i) {
 			if (i > 0) { strm << '\t'; }
 			strm << v.v[i];
 		}
@@ -22,6 +22,7 @@
 
 #include <iosfwd>
 #include <sstream>
+#include <stdexcept>
 
 #include "util/io/line/InputStream.hh"
 #include "polytope/Polytope.hh"
@@ -120,6 +121,10 @@ namespace polytope { namespace formats { namespace polymake {
 			else { skipSection(); }
 		}
 
+		if (vl.empty()) {
+			throw std::runtime_error("Polymake input has no VERTICES section");
+		}
+
 // 		if (cl.empty()) {
 			p = Polytope<T>(vl, true);
 // 		} else {
@@ -0,0 +1,49 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __POLYTOPE_NUMBERS_HH__
+#define __POLYTOPE_NUMBERS_HH__
+
+// The exact number types used by the polytope library.  With the native
+// backend (POLYTOPE_NATIVE) these are the GMP C++ classes, given the
+// names and helper functions of the polymake types they replace.
+
+#ifdef POLYTOPE_NATIVE
+
+#include <gmpxx.h>
+
+typedef mpz_class Integer;
+typedef mpq_class Rational;
+
+inline Integer numerator(const Rational& r) { return r.get_num(); }
+inline Integer denominator(const Rational& r) { return r.get_den(); }
+
+inline int toInt(const Integer& x) { return static_cast<int>(x.get_si()); }
+
+#else
+
+// Polymake includes
+#include <Rational.h>
+#include <Integer.h>
+
+inline int toInt(const Integer& x) { return static_cast<int>(x); }
+
+#endif // POLYTOPE_NATIVE
+
+#endif // __POLYTOPE_NUMBERS_HH__
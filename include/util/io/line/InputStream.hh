@@ -20,7 +20,7 @@
 #ifndef __UTIL_IO_LINE_INPUTSTREAM_HH__
 #define __UTIL_IO_LINE_INPUTSTREAM_HH__
 
-#include <iosfwd>
+#include <ios>
 #include <vector>
 
 #define IO_BUFFER_SIZE (4 * 1024)
@@ -34,13 +34,24 @@ namespace util { namespace io { namespace line {
 		InputStream& operator>>(std::string& line);
 		operator bool() const;
 		bool operator!() const;
+
+		// Offset of the next line, counting from the position of the
+		// underlying stream when this stream was created (or from the
+		// beginning of the underlying stream after a seek)
+		std::streamoff tell() const;
+
+		// Discards any buffered input and continues reading from
+		// position p of the underlying stream, which must be seekable
+		void seek(std::streampos p);
 				
 	private:
 		void fillBuffer();
 
 		std::istream& strm;
+		size_t bufferSize;
 		std::vector<char> buffer;
 		std::vector<char>::iterator pos;
+		std::streamoff bufferOffset;
 		bool atEnd;
 	};
 			
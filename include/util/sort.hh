@@ -0,0 +1,455 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __UTIL_SORT_HH__
+#define __UTIL_SORT_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/thread.hh"
+
+namespace util { namespace sort {
+
+	// Default in-memory buffer size for external sorts (in bytes)
+	const size_t DEFAULT_BUFFER_SIZE = 256 * 1024 * 1024;
+
+	// Most run files an external sort holds open at once while merging
+	const size_t MAX_MERGE_RUNS = 64;
+
+	// A uniquely named temporary file that is removed when the object
+	// is destroyed.  The file is created in dir, or in $TMPDIR (or /tmp)
+	// if dir is empty.
+	class TempFile {
+	public:
+		explicit TempFile(const std::string& dir = "");
+		~TempFile();
+		const std::string& getPath() const { return path; }
+	private:
+		std::string path;
+		TempFile(const TempFile&);
+		TempFile& operator=(const TempFile&);
+	};
+
+	// Writes and reads records to and from temporary files with the
+	// stream operators, one record per line, and estimates their size
+	// in memory
+	template<typename T>
+	struct StreamSerializer {
+		void write(std::ostream& strm, const T& x) const { strm << x << '\n'; }
+		bool read(std::istream& strm, T& x) const {
+			if (strm >> x) { return true; }
+			return false;
+		}
+		size_t size(const T&) const { return sizeof(T); }
+	};
+
+	// Sorts a sequence of records that need not fit in memory.  Records
+	// are buffered until the buffer size is exceeded, and each full
+	// buffer is sorted and written to a temporary file as a run.  The
+	// runs are then merged with a heap.  If there are more than
+	// MAX_MERGE_RUNS runs, groups of adjacent runs are first merged into
+	// longer runs until there are few enough, so that the number of open
+	// files stays bounded.  The sort is stable.
+	//
+	// With more than one thread (zero meaning one per processor), full
+	// buffers are sorted and written on worker threads while the next
+	// buffer is filled.  The buffer size is then shared between the
+	// buffer being filled and the buffers being sorted, so that it still
+	// bounds the memory used.
+	//
+	// Usage: push() all records, then call next() until it returns false.
+	template<typename T,
+			 typename Compare = std::less<T>,
+			 typename Serializer = StreamSerializer<T> >
+	class ExternalSorter {
+	public:
+		ExternalSorter(size_t bufferSize = DEFAULT_BUFFER_SIZE,
+					   const std::string& tempDir = "",
+					   size_t numThreads = 1,
+					   const Compare& comp = Compare(),
+					   const Serializer& serializer = Serializer())
+			: bufferSize(bufferSize), tempDir(tempDir),
+			  numThreads(numThreads == 0
+						 ? util::thread::numProcessors()
+						 : numThreads),
+			  comp(comp), serializer(serializer), bufferedSize(0),
+			  pool(NULL), numSpilling(0), numRuns(0), merging(false),
+			  nextBuffered(0) {
+			if (this->numThreads > 1) {
+				this->bufferSize /= this->numThreads + 1;
+			}
+		}
+
+		~ExternalSorter() {
+			// Let outstanding runs finish before removing their files
+			delete pool;
+			closeRuns();
+			for (size_t r = 0; r < runs.size(); ++r) {
+				delete runs[r];
+			}
+		}
+
+		void push(const T& x) {
+			if (merging) {
+				throw std::logic_error("ExternalSorter: push after next");
+			}
+			buffer.push_back(x);
+			bufferedSize += serializer.size(x);
+			if (bufferedSize >= bufferSize) {
+				spill();
+			}
+		}
+
+		// Stores the next record in sorted order in x and returns true,
+		// or returns false if all records have been returned
+		bool next(T& x);
+
+		// Number of runs written to temporary files
+		size_t getNumRuns() const { return numRuns; }
+
+	private:
+		struct Head {
+			T value;
+			size_t run;
+		};
+
+		// Orders heads so that the smallest value (and earliest run
+		// among equal values) is at the top of the heap
+		struct HeadCompare {
+			const Compare* comp;
+			HeadCompare(const Compare* comp) : comp(comp) {}
+			bool operator()(const Head& a, const Head& b) const {
+				return (*comp)(b.value, a.value)
+					or (not (*comp)(a.value, b.value) and b.run < a.run);
+			}
+		};
+
+		// Sorts a buffer and writes it to a run file, which is closed
+		// once written
+		class SpillTask : public util::thread::Task {
+		public:
+			SpillTask(std::vector<T>& records,
+					  const std::string& path,
+					  const Compare& comp,
+					  const Serializer& serializer)
+				: path(path), comp(comp), serializer(serializer) {
+				this->records.swap(records);
+			}
+
+			void run() {
+				std::stable_sort(records.begin(), records.end(), comp);
+				std::ofstream strm(path.c_str());
+				for (size_t i = 0; i < records.size(); ++i) {
+					serializer.write(strm, records[i]);
+				}
+				if (not strm.flush()) {
+					throw std::runtime_error("Could not write temporary file: "
+											 + path);
+				}
+			}
+
+		private:
+			std::vector<T> records;
+			std::string path;
+			Compare comp;
+			Serializer serializer;
+		};
+
+		void spill();
+		void startMerge();
+		void mergeRuns(size_t begin, size_t end, const std::string& path);
+		void openRuns(size_t begin, size_t end);
+		void closeRuns();
+		bool readHead(size_t run);
+		bool nextMerged(T& x);
+
+		size_t bufferSize;
+		std::string tempDir;
+		size_t numThreads;
+		Compare comp;
+		Serializer serializer;
+		std::vector<T> buffer;
+		size_t bufferedSize;
+		util::thread::ThreadPool* pool;
+		size_t numSpilling;
+		size_t numRuns;
+		std::vector<TempFile*> runs;
+		// The runs being merged, with the head record of each
+		std::vector<std::ifstream*> runStreams;
+		std::vector<Head> heads;
+		bool merging;
+		size_t nextBuffered;
+	};
+
+	template<typename T, typename Compare, typename Serializer>
+	void ExternalSorter<T, Compare, Serializer>::spill() {
+		// Run files are created here, in input order, so that the merge
+		// stays stable however the runs are scheduled
+		TempFile* run = new TempFile(tempDir);
+		runs.push_back(run);
+		++numRuns;
+
+		SpillTask* task = new SpillTask(buffer, run->getPath(),
+										comp, serializer);
+		std::vector<T>().swap(buffer);
+		bufferedSize = 0;
+
+		if (numThreads <= 1) {
+			task->run();
+			delete task;
+			return;
+		}
+
+		if (pool == NULL) {
+			pool = new util::thread::ThreadPool(numThreads);
+		}
+		pool->add(task);
+		if (++numSpilling == numThreads) {
+			pool->wait();
+			numSpilling = 0;
+		}
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	void ExternalSorter<T, Compare, Serializer>::startMerge() {
+		merging = true;
+
+		// Everything fit in memory
+		if (runs.empty()) {
+			std::stable_sort(buffer.begin(), buffer.end(), comp);
+			return;
+		}
+
+		if (not buffer.empty()) {
+			spill();
+		}
+		if (pool != NULL) {
+			pool->wait();
+		}
+
+		// Merge groups of adjacent runs, each replacing its group in
+		// place so that the merge stays stable, until the remaining runs
+		// can all be open at once
+		while (runs.size() > MAX_MERGE_RUNS) {
+			std::vector<TempFile*> merged;
+			for (size_t begin = 0; begin < runs.size();
+				 begin += MAX_MERGE_RUNS) {
+				size_t end = std::min(begin + MAX_MERGE_RUNS, runs.size());
+				TempFile* run = new TempFile(tempDir);
+				merged.push_back(run);
+				mergeRuns(begin, end, run->getPath());
+			}
+			for (size_t r = 0; r < runs.size(); ++r) {
+				delete runs[r];
+			}
+			runs.swap(merged);
+		}
+
+		openRuns(0, runs.size());
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	void ExternalSorter<T, Compare, Serializer>::mergeRuns(size_t begin,
+														   size_t end,
+														   const std::string& path) {
+		std::ofstream strm(path.c_str());
+		openRuns(begin, end);
+		T x;
+		while (nextMerged(x)) {
+			serializer.write(strm, x);
+		}
+		closeRuns();
+		if (not strm.flush()) {
+			throw std::runtime_error("Could not write temporary file: "
+									 + path);
+		}
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	void ExternalSorter<T, Compare, Serializer>::openRuns(size_t begin,
+														  size_t end) {
+		for (size_t r = begin; r < end; ++r) {
+			std::ifstream* strm = new std::ifstream(runs[r]->getPath().c_str());
+			runStreams.push_back(strm);
+			if (not *strm) {
+				throw std::runtime_error("Could not open temporary file: "
+										 + runs[r]->getPath());
+			}
+			readHead(r - begin);
+		}
+		std::make_heap(heads.begin(), heads.end(), HeadCompare(&comp));
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	void ExternalSorter<T, Compare, Serializer>::closeRuns() {
+		for (size_t r = 0; r < runStreams.size(); ++r) {
+			delete runStreams[r];
+		}
+		runStreams.clear();
+		heads.clear();
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	bool ExternalSorter<T, Compare, Serializer>::readHead(size_t run) {
+		Head head;
+		if (not serializer.read(*runStreams[run], head.value)) {
+			return false;
+		}
+		head.run = run;
+		heads.push_back(head);
+		return true;
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	bool ExternalSorter<T, Compare, Serializer>::next(T& x) {
+		if (not merging) {
+			startMerge();
+		}
+
+		if (runs.empty()) {
+			if (nextBuffered == buffer.size()) {
+				return false;
+			}
+			x = buffer[nextBuffered++];
+			return true;
+		}
+
+		return nextMerged(x);
+	}
+
+	template<typename T, typename Compare, typename Serializer>
+	bool ExternalSorter<T, Compare, Serializer>::nextMerged(T& x) {
+		if (heads.empty()) {
+			return false;
+		}
+		HeadCompare headComp(&comp);
+		std::pop_heap(heads.begin(), heads.end(), headComp);
+		x = heads.back().value;
+		size_t run = heads.back().run;
+		heads.pop_back();
+		if (readHead(run)) {
+			std::push_heap(heads.begin(), heads.end(), headComp);
+		}
+		return true;
+	}
+
+	// Reads records of type T from an input stream (anything supporting
+	// "in >> x" followed by a test of "in") in sorted order.  If the
+	// input is declared presorted the records are passed through as they
+	// are read, and an exception is thrown if one is found out of order.
+	// Otherwise all records are first read into an ExternalSorter.
+	template<typename T,
+			 typename InputStream,
+			 typename Compare = std::less<T>,
+			 typename Serializer = StreamSerializer<T> >
+	class SortedReader {
+	public:
+		SortedReader(InputStream& in,
+					 bool presorted,
+					 size_t bufferSize = DEFAULT_BUFFER_SIZE,
+					 const std::string& tempDir = "",
+					 size_t numThreads = 1,
+					 const Compare& comp = Compare(),
+					 const Serializer& serializer = Serializer())
+			: in(in), presorted(presorted), comp(comp),
+			  sorter(bufferSize, tempDir, numThreads, comp, serializer),
+			  hasPrevious(false) {
+			if (not presorted) {
+				T x;
+				while (in >> x) {
+					sorter.push(x);
+				}
+			}
+		}
+
+		bool next(T& x) {
+			if (not presorted) {
+				return sorter.next(x);
+			}
+			if (not (in >> x)) {
+				return false;
+			}
+			if (hasPrevious and comp(x, previous)) {
+				throw std::runtime_error("Input is not sorted");
+			}
+			previous = x;
+			hasPrevious = true;
+			return true;
+		}
+
+	private:
+		InputStream& in;
+		bool presorted;
+		Compare comp;
+		ExternalSorter<T, Compare, Serializer> sorter;
+		T previous;
+		bool hasPrevious;
+	};
+
+	// Input iterator over the records returned by a reader's
+	// "bool next(T&)" method.  Copies of an iterator share the reader.
+	template<typename Reader, typename T>
+	class ReaderIterator {
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		ReaderIterator() : reader(NULL), valid(false) {}
+
+		explicit ReaderIterator(Reader& reader)
+			: reader(&reader), valid(true) {
+			++(*this);
+		}
+
+		const T& operator*() const { return value; }
+		const T* operator->() const { return &value; }
+
+		ReaderIterator& operator++() {
+			valid = reader->next(value);
+			return *this;
+		}
+
+		bool operator==(const ReaderIterator& x) const {
+			return ((not valid and not x.valid) or
+					(valid and x.valid and reader == x.reader));
+		}
+
+		bool operator!=(const ReaderIterator& x) const {
+			return not (*this == x);
+		}
+
+	private:
+		Reader* reader;
+		T value;
+		bool valid;
+	};
+
+} }
+
+#endif // __UTIL_SORT_HH__
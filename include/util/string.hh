@@ -115,6 +115,31 @@ namespace util {
 				   OutputIterator out,
 				   const std::string& sep);
 	
+		// A view of a range of characters owned by another string
+		struct Span {
+			const char* begin;
+			const char* end;
+
+			size_t size() const { return end - begin; }
+			bool empty() const { return begin == end; }
+			bool operator==(const std::string& s) const {
+				return s.size() == size()
+					&& std::char_traits<char>::compare(begin, s.data(),
+													   size()) == 0;
+			}
+			std::string str() const { return std::string(begin, end); }
+		};
+
+		// Split the characters in [BEGIN, END) at each SEP character
+		// into at most MAXSPANS spans, keeping empty spans.  The last
+		// span extends to END if there are more separators.  Returns
+		// the number of spans stored in SPANS.
+		size_t splitSpans(const char* begin,
+						  const char* end,
+						  char sep,
+						  Span* spans,
+						  size_t maxSpans);
+
 		template<typename OutputIterator>
 		void wrap(const std::string& s,
 				  OutputIterator out,
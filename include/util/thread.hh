@@ -0,0 +1,133 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __UTIL_THREAD_HH__
+#define __UTIL_THREAD_HH__
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace util { namespace thread {
+
+	// Number of online processors, or 1 if this cannot be determined
+	size_t numProcessors();
+
+	class Mutex {
+	public:
+		Mutex();
+		~Mutex();
+		void lock();
+		void unlock();
+	private:
+		friend class Condition;
+		pthread_mutex_t mutex;
+		Mutex(const Mutex&);
+		Mutex& operator=(const Mutex&);
+	};
+
+	// Holds a mutex locked for the lifetime of the object
+	class Lock {
+	public:
+		explicit Lock(Mutex& m) : m(m) { m.lock(); }
+		~Lock() { m.unlock(); }
+	private:
+		Mutex& m;
+		Lock(const Lock&);
+		Lock& operator=(const Lock&);
+	};
+
+	class Condition {
+	public:
+		Condition();
+		~Condition();
+		void wait(Mutex& m);
+		void signal();
+		void broadcast();
+	private:
+		pthread_cond_t cond;
+		Condition(const Condition&);
+		Condition& operator=(const Condition&);
+	};
+
+	// Hands out the integers 0, 1, ..., n - 1 to any number of threads
+	class Counter {
+	public:
+		explicit Counter(size_t n = 0) : nextValue(0), n(n) {}
+		void reset(size_t n) { Lock lock(m); nextValue = 0; this->n = n; }
+		// Stores the next value in i and returns true, or returns false
+		// if all values have been handed out
+		bool next(size_t& i) {
+			Lock lock(m);
+			if (nextValue >= n) { return false; }
+			i = nextValue++;
+			return true;
+		}
+	private:
+		Mutex m;
+		size_t nextValue;
+		size_t n;
+	};
+
+	class Task {
+	public:
+		virtual ~Task() {}
+		virtual void run() = 0;
+	};
+
+	// A fixed set of threads that run tasks from a shared queue.  Tasks
+	// added to the pool are owned by the pool and deleted once they
+	// have been run.  An exception thrown by a task is reported by the
+	// next call to wait() as a std::runtime_error.
+	class ThreadPool {
+	public:
+		// Creates a pool of numThreads threads, or one thread per
+		// processor if numThreads is zero
+		explicit ThreadPool(size_t numThreads = 0);
+		~ThreadPool();
+
+		void add(Task* task);
+
+		// Blocks until all tasks added so far have been run
+		void wait();
+
+		size_t size() const { return threads.size(); }
+
+	private:
+		static void* start(void* pool);
+		void work();
+
+		std::vector<pthread_t> threads;
+		std::deque<Task*> tasks;
+		size_t numPending;
+		bool stopping;
+		std::string error;
+		Mutex m;
+		Condition taskAvailable;
+		Condition allDone;
+
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+	};
+
+} }
+
+#endif // __UTIL_THREAD_HH__
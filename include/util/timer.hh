@@ -0,0 +1,50 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __UTIL_TIMER_HH__
+#define __UTIL_TIMER_HH__
+
+#include <cstddef>
+#include <sys/time.h>
+
+namespace util {
+
+	// Returns the current wall clock time in seconds
+	inline double wallTime() {
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec + tv.tv_usec / 1e6;
+	}
+
+	// Measures elapsed wall clock time.  Unlike boost::timer, which
+	// reads std::clock() and so sums the processor time of all threads,
+	// this shows the speedup from running work in parallel.
+	class WallTimer {
+	public:
+		WallTimer() : start(wallTime()) {}
+		void restart() { start = wallTime(); }
+		// Seconds since construction or the last restart
+		double elapsed() const { return wallTime() - start; }
+	private:
+		double start;
+	};
+
+}
+
+#endif // __UTIL_TIMER_HH__
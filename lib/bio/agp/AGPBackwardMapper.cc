@@ -22,63 +22,39 @@
 
 namespace bio { namespace agp {
 
-	struct AGPRecComparer {
-		bool operator()(const formats::agp::Record& x,
-						const formats::agp::Record& y) const {
-			int chromComp = x.getChrom().compare(y.getChrom());
-			return chromComp < 0
-				or (chromComp == 0
-					and (x.getContigStart() < y.getContigStart()
-						 or (x.getContigStart()  == y.getContigStart()
-							 and x.getContigEnd() < y.getContigEnd())));
-		}
-	};
-
-	struct AGPIntervalComparer {
-		bool operator()(const formats::agp::Record& x,
-						const genome::Interval& y) const{
-			int chromComp = x.getChrom().compare(y.getChrom());
-			return chromComp < 0
-				or (chromComp == 0 && x.getContigEnd() <= y.getStart());
-		}
-	};
-	
 	AGPBackwardMapper::AGPBackwardMapper(std::istream& strm) {
 		// Read in AGP file
 		formats::agp::InputStream agpStream(strm);
 		formats::agp::Record agpRec;
 		while (agpStream >> agpRec) {
 			if (!agpRec.isGap()) {
-				agpRecs.push_back(agpRec);
+				chromMap[agpRec.getChrom()].add(agpRec);
 			}
 		}
 
-		// Sort AGP Records by chrom interval
-		std::sort(agpRecs.begin(), agpRecs.end(), AGPRecComparer());
+		// Index AGP records by chrom interval
+		for (AGPMap::iterator it = chromMap.begin();
+			 it != chromMap.end(); ++it) {
+			it->second.build();
+		}
 	}
 	
 	void AGPBackwardMapper::map(const genome::Interval& i,
 								std::vector<genome::BasicInterval>& mapped) {
-		genome::BasicInterval query(i);
-		std::vector<formats::agp::Record>::const_iterator start
-			= std::lower_bound(agpRecs.begin(), agpRecs.end(),
-							   query, AGPIntervalComparer());
-		if (start == agpRecs.end()) {
+		AGPMap::const_iterator chrom = chromMap.find(i.getChrom());
+		if (chrom == chromMap.end()) {
 			return;
 		}
 
-		// Find last AGP record that this interval overlaps
-		std::vector<formats::agp::Record>::const_iterator end = start;
-		while (end != agpRecs.end() and overlap(*end, i)) {
-			++end;
-		}			 
+		std::vector<const formats::agp::Record*> recs;
+		chrom->second.getOverlapping(i.getStart(), i.getEnd(), recs);
 
-		std::vector<formats::agp::Record>::const_iterator it;
-		for (it = start; it != end; ++it) {
+		for (size_t r = 0; r < recs.size(); ++r) {
+			const formats::agp::Record* rec = recs[r];
 			genome::BasicInterval untransformedInt(i);
 
-			genome::BasicInterval contig_interval = it->getTargetInterval();
-			genome::BasicInterval source_interval = it->getSourceInterval();
+			genome::BasicInterval contig_interval = rec->getTargetInterval();
+			genome::BasicInterval source_interval = rec->getSourceInterval();
 			
 			int startOffset = i.getStart() < contig_interval.getStart() ? 
 				0 :
@@ -87,9 +63,9 @@ namespace bio { namespace agp {
 				i.getEnd() - contig_interval.getStart() :
 				contig_interval.getLength();
 
-			untransformedInt.setChrom(it->getSourceAccession());
+			untransformedInt.setChrom(rec->getSourceAccession());
 			
-			if (it->getSourceOrientation() == '+') {
+			if (rec->getSourceOrientation() == '+') {
 				untransformedInt.setStart(source_interval.getStart() + startOffset);
 				untransformedInt.setEnd(source_interval.getStart() + endOffset);
 			} else {
@@ -103,11 +79,4 @@ namespace bio { namespace agp {
 		
 	}
 
-	bool AGPBackwardMapper::overlap(const formats::agp::Record& rec,
-									const genome::Interval& i) {
-		return rec.getContigEnd() > i.getStart()
-			and rec.getContigStart() <= i.getEnd()
-			and rec.getChrom() == i.getChrom();
-	}
-		
 } }
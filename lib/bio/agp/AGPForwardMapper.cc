@@ -28,10 +28,15 @@ namespace bio { namespace agp {
 		formats::agp::Record agpRec;
 		while (agpStream >> agpRec) {
 			if (!agpRec.isGap()) {
-				contigMap[agpRec.getSourceAccession()].push_back(agpRec);
+				contigMap[agpRec.getSourceAccession()].add(agpRec);
 			}
 			chromSizes[agpRec.getChrom()] += agpRec.getContigLength();
 		}
+
+		for (AGPMap::iterator it = contigMap.begin();
+			 it != contigMap.end(); ++it) {
+			it->second.build();
+		}
 	}
 	
 	void AGPForwardMapper::map(const genome::Interval& i,
@@ -41,14 +46,11 @@ namespace bio { namespace agp {
 			return;
 		}
 		
-		AGPList& mappingList = it->second;
+		std::vector<const formats::agp::Record*> mappings;
+		it->second.getOverlapping(i.getStart(), i.getEnd(), mappings);
 
-		for (AGPList::iterator mapping = mappingList.begin();
-			 mapping != mappingList.end(); ++mapping) {
-			if (not overlap(i, *mapping)) {
-				continue;
-			}
-			
+		for (size_t m = 0; m < mappings.size(); ++m) {
+			const formats::agp::Record* mapping = mappings[m];
 			genome::BasicInterval j;
 			
 			j.setChrom(mapping->getChrom());
@@ -100,11 +102,4 @@ namespace bio { namespace agp {
 		return it->second;
 	}
 	
-	bool AGPForwardMapper::overlap(const genome::Interval& i,
-								   const formats::agp::Record& rec) {
-		return i.getStart() < rec.getSourceEnd()
-			and i.getEnd() >= rec.getSourceStart()
-			and i.getChrom() == rec.getSourceAccession();
-	}
-	
 } }
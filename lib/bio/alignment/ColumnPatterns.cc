@@ -0,0 +1,53 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <utility>
+
+#include "boost/unordered_map.hpp"
+
+#include "bio/alignment/ColumnPatterns.hh"
+
+namespace bio { namespace alignment {
+
+	ColumnPatterns::ColumnPatterns(const MultipleAlignment& ma)
+		: numSeqs(ma.getNumSeqs()), indices(ma.getNumCols()) {
+		std::vector<std::string> seqs(numSeqs);
+		for (size_t i = 0; i < numSeqs; ++i) {
+			seqs[i] = ma.getSeq(i);
+		}
+
+		typedef boost::unordered_map<std::string, size_t> PatternMap;
+		PatternMap patternMap;
+		std::string column(numSeqs, ' ');
+		for (size_t t = 0; t < indices.size(); ++t) {
+			for (size_t i = 0; i < numSeqs; ++i) {
+				column[i] = seqs[i][t];
+			}
+			std::pair<PatternMap::iterator, bool> inserted =
+				patternMap.insert(std::make_pair(column, patterns.size()));
+			if (inserted.second) {
+				patterns.push_back(column);
+				counts.push_back(0);
+			}
+			indices[t] = inserted.first->second;
+			++counts[indices[t]];
+		}
+	}
+	
+} }
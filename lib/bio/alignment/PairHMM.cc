@@ -17,10 +17,387 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
 #include "bio/alignment/PairHMM.hh"
 
 namespace bio { namespace alignment {
 
+		namespace {
+			// A row of the banded DP matrix, holding the H, I and D
+			// values for the columns from FIRST onwards
+			struct Row {
+				size_t first;
+				std::vector<double> h, i, d;
+
+				void reset(size_t firstCol, size_t lastCol) {
+					first = firstCol;
+					h.assign(lastCol - firstCol + 1, 0.0);
+					i.assign(h.size(), 0.0);
+					d.assign(h.size(), 0.0);
+				}
+
+				size_t last() const { return first + h.size() - 1; }
+
+				// Values outside of the band are zero
+				double get(const std::vector<double>& v, size_t j) const {
+					return (j >= first and j - first < v.size()) ?
+						v[j - first] : 0.0;
+				}
+				double getH(size_t j) const { return get(h, j); }
+				double getI(size_t j) const { return get(i, j); }
+				double getD(size_t j) const { return get(d, j); }
+
+				// Divides all values by the largest and returns it
+				double rescale() {
+					double m = 0.0;
+					for (size_t k = 0; k < h.size(); ++k) {
+						m = std::max(m, std::max(h[k], std::max(i[k], d[k])));
+					}
+					if (m <= 0.0) {
+						return 1.0;
+					}
+					for (size_t k = 0; k < h.size(); ++k) {
+						h[k] /= m;
+						i[k] /= m;
+						d[k] /= m;
+					}
+					return m;
+				}
+
+				void swap(Row& other) {
+					std::swap(first, other.first);
+					h.swap(other.h);
+					i.swap(other.i);
+					d.swap(other.d);
+				}
+			};
+
+			// Finds the alignment maximizing the sum of match posteriors
+			// by dynamic programming over suffixes, as the rows of
+			// posteriors arrive from the last to the first
+			class PosteriorDecoder : public PairHMM::PosteriorVisitor {
+			public:
+				PosteriorDecoder(const PairHMM::Band& band)
+					: band(band), moves(band.size()) {
+					size_t n = band.size() - 1;
+					const size_t m = band[n].second;
+					suffix.assign(m - band[n].first + 1, 0.0);
+					moves[n].assign(suffix.size(), RIGHT);
+				}
+
+				void visitRow(size_t i,
+							  size_t firstCol,
+							  const std::vector<double>& probs) {
+					size_t first = band[i - 1].first;
+					size_t last = band[i - 1].second;
+					std::vector<double> prevSuffix(last - first + 1, UNREACHABLE);
+					std::vector<unsigned char>& prevMoves = moves[i - 1];
+					prevMoves.assign(prevSuffix.size(), NONE);
+					for (size_t j = last + 1; j-- > first; ) {
+						double& best = prevSuffix[j - first];
+						unsigned char& move = prevMoves[j - first];
+						if (j + 1 >= firstCol and j + 1 - firstCol < probs.size()
+							and suffix[j + 1 - firstCol] != UNREACHABLE) {
+							best = suffix[j + 1 - firstCol] + probs[j + 1 - firstCol];
+							move = DIAG;
+						}
+						if (j >= firstCol and j - firstCol < probs.size()
+							and suffix[j - firstCol] > best) {
+							best = suffix[j - firstCol];
+							move = DOWN;
+						}
+						if (j < last and prevSuffix[j + 1 - first] > best) {
+							best = prevSuffix[j + 1 - first];
+							move = RIGHT;
+						}
+					}
+					suffix.swap(prevSuffix);
+				}
+
+				PairwiseAlignment traceback(const PairHMM::Seq& s1,
+											const PairHMM::Seq& s2) const {
+					if (suffix.empty() or suffix[0] == UNREACHABLE) {
+						throw std::runtime_error("No alignment within band");
+					}
+					PairwiseAlignment alignment;
+					size_t i = 0, j = 0;
+					while (i < s1.size() or j < s2.size()) {
+						unsigned char move = moves[i][j - band[i].first];
+						if (move == DIAG) {
+							alignment.seq1 += s1[i++];
+							alignment.seq2 += s2[j++];
+						} else if (move == DOWN) {
+							alignment.seq1 += s1[i++];
+							alignment.seq2 += '-';
+						} else if (move == RIGHT) {
+							alignment.seq1 += '-';
+							alignment.seq2 += s2[j++];
+						} else {
+							throw std::runtime_error("No alignment within band");
+						}
+					}
+					return alignment;
+				}
+
+			private:
+				enum Move { NONE, DIAG, DOWN, RIGHT };
+				static const double UNREACHABLE;
+
+				const PairHMM::Band& band;
+				std::vector<double> suffix;
+				std::vector< std::vector<unsigned char> > moves;
+			};
+
+			const double PosteriorDecoder::UNREACHABLE = -1.0;
+		}
+
+		// The model with probabilities as doubles, for computing rows of
+		// the DP matrix in rescaled arithmetic
+		class PairHMM::ScaledModel {
+		public:
+			ScaledModel(const PairHMM& hmm,
+						const Seq& s1,
+						const Seq& s2,
+						const Band& band);
+
+			double forwardRow(size_t i, const Row& prev, Row& cur) const;
+			double backwardRow(size_t i, const Row& next, Row& cur) const;
+			double endSum(const Row& last) const;
+
+		private:
+			static const size_t NUM_STATES = 3;
+
+			double hEmission(size_t i, size_t j) const {
+				return hEmissions(static_cast<unsigned char>(s1[i - 1]),
+								  static_cast<unsigned char>(s2[j - 1]));
+			}
+			double iEmission(size_t j) const {
+				return iEmissions[static_cast<unsigned char>(s2[j - 1])];
+			}
+			double dEmission(size_t i) const {
+				return dEmissions[static_cast<unsigned char>(s1[i - 1])];
+			}
+
+			const Seq& s1;
+			const Seq& s2;
+			const Band& band;
+			util::Matrix<double> hEmissions;
+			std::vector<double> iEmissions;
+			std::vector<double> dEmissions;
+			double begin[NUM_STATES];
+			double end[NUM_STATES];
+			double t[NUM_STATES][NUM_STATES];
+		};
+
+		PairHMM::ScaledModel::ScaledModel(const PairHMM& hmm,
+										  const Seq& s1,
+										  const Seq& s2,
+										  const Band& band)
+			: s1(s1), s2(s2), band(band),
+			  hEmissions(hmm.hEmissions.getNumRows(),
+						 hmm.hEmissions.getNumCols()),
+			  iEmissions(hmm.iEmissions.begin(), hmm.iEmissions.end()),
+			  dEmissions(hmm.dEmissions.begin(), hmm.dEmissions.end()) {
+			if (band.size() != s1.size() + 1 or band.front().first != 0
+				or band.back().second != s2.size()) {
+				throw std::runtime_error("Band does not span the sequences");
+			}
+			for (size_t i = 0; i < band.size(); ++i) {
+				if (band[i].first > band[i].second
+					or band[i].second > s2.size()) {
+					throw std::runtime_error("Invalid band");
+				}
+			}
+			for (size_t c1 = 0; c1 < hEmissions.getNumRows(); ++c1) {
+				for (size_t c2 = 0; c2 < hEmissions.getNumCols(); ++c2) {
+					hEmissions(c1, c2) = hmm.hEmissions(c1, c2);
+				}
+			}
+			for (size_t s = 0; s < NUM_STATES; ++s) {
+				begin[s] = hmm.beginProbs[s];
+				end[s] = hmm.endProbs[s];
+				for (size_t s2 = 0; s2 < NUM_STATES; ++s2) {
+					t[s][s2] = hmm.transitions(s, s2);
+				}
+			}
+		}
+
+		// Fills CUR with row I of the forward matrix, given row I - 1
+		// in PREV, and returns the factor the row was scaled down by
+		double PairHMM::ScaledModel::forwardRow(size_t i,
+												const Row& prev,
+												Row& cur) const {
+			cur.reset(band[i].first, band[i].second);
+			for (size_t j = cur.first; j <= cur.last(); ++j) {
+				size_t k = j - cur.first;
+				if (j > 0) {
+					if (i > 0) {
+						cur.h[k] = hEmission(i, j) * ((i == 1 and j == 1) ?
+							begin[H_STATE] :
+							t[H_STATE][H_STATE] * prev.getH(j - 1) +
+							t[I_STATE][H_STATE] * prev.getI(j - 1) +
+							t[D_STATE][H_STATE] * prev.getD(j - 1));
+					}
+					cur.i[k] = iEmission(j) * ((i == 0 and j == 1) ?
+						begin[I_STATE] :
+						t[H_STATE][I_STATE] * cur.getH(j - 1) +
+						t[I_STATE][I_STATE] * cur.getI(j - 1) +
+						t[D_STATE][I_STATE] * cur.getD(j - 1));
+				}
+				if (i > 0) {
+					cur.d[k] = dEmission(i) * ((i == 1 and j == 0) ?
+						begin[D_STATE] :
+						t[H_STATE][D_STATE] * prev.getH(j) +
+						t[I_STATE][D_STATE] * prev.getI(j) +
+						t[D_STATE][D_STATE] * prev.getD(j));
+				}
+			}
+			// Row 1 takes begin probabilities as well as values from row
+			// 0, so row 0 must be left at the same scale as them
+			return (i == 0 ? 1.0 : cur.rescale());
+		}
+
+		// Fills CUR with row I of the backward matrix, given row I + 1
+		// in NEXT, and returns the factor the row was scaled down by
+		double PairHMM::ScaledModel::backwardRow(size_t i,
+												 const Row& next,
+												 Row& cur) const {
+			const size_t n = s1.size(), m = s2.size();
+			cur.reset(band[i].first, band[i].second);
+			for (size_t j = cur.last() + 1; j-- > cur.first; ) {
+				size_t k = j - cur.first;
+				double toH = 0.0, toI = 0.0, toD = 0.0;
+				if (i < n and j < m) {
+					toH = hEmission(i + 1, j + 1) * next.getH(j + 1);
+				}
+				if (j < m) {
+					toI = iEmission(j + 1) * cur.getI(j + 1);
+				}
+				if (i < n) {
+					toD = dEmission(i + 1) * next.getD(j);
+				}
+				bool isEnd = (i == n and j == m);
+				double* values[NUM_STATES] = { &cur.h[k], &cur.i[k], &cur.d[k] };
+				for (size_t s = 0; s < NUM_STATES; ++s) {
+					*values[s] = t[s][H_STATE] * toH + t[s][I_STATE] * toI +
+						t[s][D_STATE] * toD + (isEnd ? end[s] : 0.0);
+				}
+			}
+			return cur.rescale();
+		}
+
+		double PairHMM::ScaledModel::endSum(const Row& last) const {
+			const size_t m = s2.size();
+			return last.getH(m) * end[H_STATE] + last.getI(m) * end[I_STATE] +
+				last.getD(m) * end[D_STATE];
+		}
+
+		PairHMM::Band PairHMM::getFullBand(size_t length1, size_t length2) {
+			return Band(length1 + 1, std::make_pair(size_t(0), length2));
+		}
+
+		PairHMM::Band PairHMM::getSeedBand(const PairwiseAlignment& seed,
+										   size_t width) {
+			Band band(1, std::make_pair(size_t(0), size_t(0)));
+			size_t j = 0;
+			for (size_t col = 0; col < seed.length(); ++col) {
+				bool inSeq1 = (seed.seq1[col] != '-');
+				bool inSeq2 = (seed.seq2[col] != '-');
+				if (inSeq2) {
+					++j;
+				}
+				if (inSeq1) {
+					band.push_back(std::make_pair(j, j));
+				} else if (inSeq2) {
+					band.back().second = j;
+				}
+			}
+			for (size_t i = 0; i < band.size(); ++i) {
+				band[i].first -= std::min(band[i].first, width);
+				band[i].second = std::min(band[i].second + width, j);
+			}
+			return band;
+		}
+
+		PairHMM::Prob PairHMM::posteriors(const Seq& seq1,
+										  const Seq& seq2,
+										  const Band& band,
+										  PosteriorVisitor& visitor) const {
+			ScaledModel model(*this, seq1, seq2, band);
+			const size_t n = seq1.size();
+			const size_t interval =
+				std::max(size_t(1), size_t(std::sqrt(double(n + 1))));
+
+			// Forward pass, keeping the rows at checkpoints and the log
+			// of the scale of every row
+			std::vector<double> logScales(n + 1);
+			std::vector<Row> checkpoints(n / interval + 1);
+			Row prev, cur;
+			for (size_t i = 0; i <= n; ++i) {
+				logScales[i] = std::log(model.forwardRow(i, prev, cur)) +
+					(i == 0 ? 0.0 : logScales[i - 1]);
+				if (i % interval == 0) {
+					checkpoints[i / interval] = cur;
+				}
+				prev.swap(cur);
+			}
+			Prob likelihood;
+			likelihood.value = std::log(model.endSum(prev)) + logScales[n];
+			if (not (likelihood.value > -HUGE_VAL)) {
+				throw std::runtime_error("Sequences cannot be aligned "
+										 "within band");
+			}
+
+			// Backward pass over blocks of rows from the last, recomputing
+			// the forward rows of each block from its checkpoint.  Every
+			// alignment enters row i > 0 in exactly one H or D cell, so the
+			// sum of forward times backward over those cells is the
+			// likelihood, and normalizing by it cancels the row scales.
+			std::vector<Row> block(interval);
+			Row next, back;
+			std::vector<double> probs;
+			for (size_t c = checkpoints.size(); c-- > 0; ) {
+				size_t start = c * interval;
+				size_t end = std::min(start + interval, n + 1);
+				block[0].swap(checkpoints[c]);
+				for (size_t i = start + 1; i < end; ++i) {
+					model.forwardRow(i, block[i - start - 1], block[i - start]);
+				}
+				for (size_t i = end; i-- > start; ) {
+					model.backwardRow(i, next, back);
+					if (i > 0) {
+						const Row& f = block[i - start];
+						probs.resize(back.h.size());
+						double total = 0.0;
+						for (size_t k = 0; k < probs.size(); ++k) {
+							probs[k] = f.h[k] * back.h[k];
+							total += probs[k] + f.d[k] * back.d[k];
+						}
+						if (total > 0.0) {
+							for (size_t k = 0; k < probs.size(); ++k) {
+								probs[k] /= total;
+							}
+						}
+						visitor.visitRow(i, back.first, probs);
+					}
+					next.swap(back);
+				}
+			}
+
+			return likelihood;
+		}
+
+		PairwiseAlignment PairHMM::posteriorDecode(const Seq& seq1,
+												   const Seq& seq2,
+												   const Band& band) const {
+			PosteriorDecoder decoder(band);
+			posteriors(seq1, seq2, band, decoder);
+			return decoder.traceback(seq1, seq2);
+		}
+
 		PairHMM::PairHMM(const ProbMatrix& hEmissions,
 						 const ProbVector& iEmissions,
 						 const ProbVector& dEmissions,
@@ -0,0 +1,273 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+#include "bio/formats/agp/Assembler.hh"
+#include "util/thread.hh"
+
+namespace bio { namespace formats { namespace agp {
+
+	const size_t Assembler::DEFAULT_CHUNK_SIZE = 1 << 20;
+
+	struct ContigStartSorter {
+		bool operator()(const Record& r1, const Record& r2) const {
+			return r1.getContigStart() < r2.getContigStart();
+		}
+	};
+
+	// Zero-based end of the part of the assembled sequence that REC
+	// covers
+	static genome::Position componentEnd(const Record& rec) {
+		if (rec.isGap()) {
+			return rec.getContigEnd();
+		}
+		return rec.getContigStart() - 1
+			+ rec.getSourceEnd() - rec.getSourceStart() + 1;
+	}
+
+	struct Assembler::Chrom {
+		const std::string* name;
+		std::vector<Record>* recs;
+		// Greatest component end among recs[0..i], so that the
+		// components overlapping a position can be found by binary
+		// search even when components overlap
+		std::vector<genome::Position> maxEnd;
+		genome::Position length;
+	};
+
+	struct Assembler::Chunk {
+		const Chrom* chrom;
+		genome::Position start;
+		genome::Position end;
+		bool first;
+		bool last;
+		std::string seq;
+	};
+
+	class Assembler::FillTask : public util::thread::Task {
+	public:
+		FillTask(Source& source, Chunk& chunk)
+			: source(source), chunk(chunk) {}
+		void run() { Assembler::fill(source, chunk); }
+	private:
+		Source& source;
+		Chunk& chunk;
+	};
+
+	void Assembler::addRecord(const Record& rec) {
+		chromRecs[rec.getChrom()].push_back(rec);
+	}
+
+	void Assembler::getSourceNames(std::set<std::string>& names) const {
+		std::map<std::string, std::vector<Record> >::const_iterator it;
+		for (it = chromRecs.begin(); it != chromRecs.end(); ++it) {
+			for (size_t i = 0; i < it->second.size(); ++i) {
+				if (!it->second[i].isGap()) {
+					names.insert(it->second[i].getSourceAccession());
+				}
+			}
+		}
+	}
+
+	void Assembler::prepare(Chrom& chrom) {
+		std::vector<Record>& recs = *chrom.recs;
+		std::stable_sort(recs.begin(), recs.end(), ContigStartSorter());
+
+		chrom.maxEnd.resize(recs.size());
+		genome::Position maxEnd = 0;
+		for (size_t i = 0; i < recs.size(); ++i) {
+			maxEnd = std::max(maxEnd, componentEnd(recs[i]));
+			chrom.maxEnd[i] = maxEnd;
+		}
+
+		// The sequence ends where its last component does
+		chrom.length = recs.back().getContigEnd();
+	}
+
+	void Assembler::fill(Source& source, Chunk& chunk) {
+		const std::vector<Record>& recs = *chunk.chrom->recs;
+		const std::vector<genome::Position>& maxEnd = chunk.chrom->maxEnd;
+
+		chunk.seq.assign(chunk.end - chunk.start, 'N');
+
+		// Skip the components that end before the chunk
+		size_t i = std::upper_bound(maxEnd.begin(), maxEnd.end(), chunk.start)
+			- maxEnd.begin();
+
+		for (; i < recs.size() && recs[i].getContigStart() - 1 < chunk.end; ++i) {
+			const Record& rec = recs[i];
+			if (rec.isGap()) {
+				continue;
+			}
+
+			genome::Position contigStart = rec.getContigStart() - 1;
+			genome::Position start = std::max(chunk.start, contigStart);
+			genome::Position end = std::min(chunk.end, componentEnd(rec));
+			if (start >= end) {
+				continue;
+			}
+
+			// Map the overlap back to source coordinates, counting
+			// from the end of the source range on the reverse strand
+			std::string seq;
+			if (rec.getSourceOrientation() == '-') {
+				seq = source.getSeq(rec.getSourceAccession(),
+									rec.getSourceEnd() - (end - contigStart),
+									rec.getSourceEnd() - (start - contigStart),
+									'-');
+			} else {
+				genome::Position sourceStart = rec.getSourceStart() - 1;
+				seq = source.getSeq(rec.getSourceAccession(),
+									sourceStart + (start - contigStart),
+									sourceStart + (end - contigStart),
+									'+');
+			}
+			chunk.seq.replace(start - chunk.start, seq.size(), seq);
+		}
+	}
+
+	void Assembler::assemble(Source& source,
+							 Sink& sink,
+							 const size_t numThreads,
+							 const size_t chunkSize) {
+		if (chunkSize == 0) {
+			throw std::runtime_error("Assembly chunk size must be positive");
+		}
+
+		std::vector<Chrom> chroms;
+		std::map<std::string, std::vector<Record> >::iterator it;
+		for (it = chromRecs.begin(); it != chromRecs.end(); ++it) {
+			Chrom chrom;
+			chrom.name = &it->first;
+			chrom.recs = &it->second;
+			chroms.push_back(chrom);
+			prepare(chroms.back());
+		}
+
+		// Fill a few chunks per thread at a time, then write them out
+		// in order
+		util::thread::ThreadPool pool(numThreads);
+		const size_t batchSize = pool.size() * 4;
+		std::vector<Chunk> batch;
+		size_t c = 0;
+		genome::Position pos = 0;
+		while (c < chroms.size()) {
+			batch.clear();
+			while (batch.size() < batchSize && c < chroms.size()) {
+				Chunk chunk;
+				chunk.chrom = &chroms[c];
+				chunk.start = pos;
+				chunk.end = std::min(pos + static_cast<genome::Position>(chunkSize),
+									 chroms[c].length);
+				chunk.first = (pos == 0);
+				chunk.last = (chunk.end == chroms[c].length);
+				batch.push_back(chunk);
+				if (chunk.last) {
+					++c;
+					pos = 0;
+				} else {
+					pos = chunk.end;
+				}
+			}
+
+			for (size_t i = 0; i < batch.size(); ++i) {
+				pool.add(new FillTask(source, batch[i]));
+			}
+			pool.wait();
+
+			for (size_t i = 0; i < batch.size(); ++i) {
+				const Chrom& chrom = *batch[i].chrom;
+				if (batch[i].first) {
+					sink.beginSeq(*chrom.name, chrom.length);
+				}
+				sink.appendSeq(batch[i].seq);
+				if (batch[i].last) {
+					sink.endSeq();
+				}
+			}
+		}
+	}
+
+	// Implementation of sources and sinks
+
+	std::string Assembler::SDBSource::getSeq(const std::string& name,
+											 const size_t start,
+											 const size_t end,
+											 const char strand) {
+		return db.getSeq(name, start, end, strand);
+	}
+
+	std::string Assembler::FastaSource::getSeq(const std::string& name,
+											   const size_t start,
+											   const size_t end,
+											   const char strand) {
+		return file.getSeq(name, start, end, strand);
+	}
+
+	Assembler::FastaSink::FastaSink(std::ostream& strm,
+									const size_t lineWidth)
+		: strm(strm),
+		  lineWidth(lineWidth),
+		  column(0) {
+	}
+
+	void Assembler::FastaSink::beginSeq(const std::string& name,
+										const size_t length) {
+		strm << fasta::Constants::TITLE_LINE_PREFIX << name << '\n';
+		column = 0;
+	}
+
+	void Assembler::FastaSink::appendSeq(const std::string& seq) {
+		size_t pos = 0;
+		while (pos < seq.size()) {
+			size_t n = std::min(lineWidth - column, seq.size() - pos);
+			strm.write(seq.data() + pos, n);
+			pos += n;
+			column += n;
+			if (column == lineWidth) {
+				strm << '\n';
+				column = 0;
+			}
+		}
+	}
+
+	void Assembler::FastaSink::endSeq() {
+		if (column != 0) {
+			strm << '\n';
+			column = 0;
+		}
+	}
+
+	void Assembler::SDBSink::beginSeq(const std::string& name,
+									  const size_t length) {
+		db.beginRec(name, compressed);
+	}
+
+	void Assembler::SDBSink::appendSeq(const std::string& seq) {
+		db.appendSeq(seq);
+	}
+
+	void Assembler::SDBSink::endSeq() {
+		db.endRec();
+	}
+
+} } }
@@ -0,0 +1,215 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "bio/formats/fasta/IndexedFile.hh"
+#include "bio/formats/fasta/Constants.hh"
+#include "util/io.hh"
+#include "util/string.hh"
+
+namespace bio { namespace formats { namespace fasta {
+
+	IndexedFile::IndexedFile()
+		: strm(NULL) {
+	}
+
+	IndexedFile::~IndexedFile() {
+		if (strm) {
+			close();
+		}
+	}
+
+	void IndexedFile::open(const filesystem::Path& filename) {
+		if (strm) {
+			throw std::runtime_error("Attempted to open FASTA file before closing previous file");
+		}
+
+		filesystem::Path indexFilename(filename.toString() + ".fai");
+		if (indexFilename.exists()) {
+			readIndex(indexFilename);
+		} else {
+			buildIndex(filename);
+		}
+
+		strm = fopen(filename.toString().c_str(), "rb");
+		if (!strm) {
+			throw std::runtime_error(std::string("Failed to open file ") +
+									 filename.toString());
+		}
+	}
+
+	void IndexedFile::close() {
+		if (strm) {
+			fclose(strm);
+			strm = NULL;
+		}
+		entries.clear();
+	}
+
+	void IndexedFile::readIndex(const filesystem::Path& indexFilename) {
+		std::ifstream indexFile;
+		indexFilename.openForInput(indexFile);
+
+		util::string::Converter<size_t> toSize;
+		util::string::Converter<off_t> toOffset;
+		std::string line;
+		while (std::getline(indexFile, line)) {
+			std::vector<std::string> fields;
+			util::string::split(line, std::back_inserter(fields), "\t");
+			if (fields.size() < 5) {
+				throw std::runtime_error("Bad line in FASTA index "
+										 + indexFilename.toString()
+										 + ": " + line);
+			}
+			Entry& e = entries[fields[0]];
+			e.length = toSize(fields[1]);
+			e.offset = toOffset(fields[2]);
+			e.lineBases = toSize(fields[3]);
+			e.lineBytes = toSize(fields[4]);
+		}
+	}
+
+	void IndexedFile::buildIndex(const filesystem::Path& filename) {
+		std::ifstream file;
+		filename.openForInput(file);
+
+		std::string title;
+		Entry* e = NULL;
+		bool seenShortLine = false;
+		off_t pos = 0;
+		std::string line;
+		while (std::getline(file, line)) {
+			pos += line.size() + 1;
+
+			if (!line.empty() && line[0] == Constants::TITLE_LINE_PREFIX) {
+				// Records are named by the first word of the title, as
+				// in a samtools index
+				title = util::string::firstWord(line, 1);
+				e = &entries[title];
+				e->length = 0;
+				e->offset = pos;
+				e->lineBases = 0;
+				e->lineBytes = 0;
+				seenShortLine = false;
+				continue;
+			} else if (!e) {
+				// Text before the first title line is ignored
+				continue;
+			}
+
+			size_t bases = line.size();
+			if (bases > 0 && line[bases - 1] == '\r') {
+				--bases;
+			}
+			if (bases == 0) {
+				seenShortLine = true;
+				continue;
+			}
+
+			// Only the last line of a record may be shorter than the
+			// others
+			if (seenShortLine
+				|| (e->lineBases != 0
+					&& (bases > e->lineBases
+						|| (bases == e->lineBases
+							&& line.size() + 1 != e->lineBytes)))) {
+				throw std::runtime_error("Cannot index FASTA record \"" + title
+										 + "\" in " + filename.toString()
+										 + ": sequence lines have differing lengths");
+			}
+			if (e->lineBases == 0) {
+				e->lineBases = bases;
+				e->lineBytes = line.size() + 1;
+			} else if (bases < e->lineBases) {
+				seenShortLine = true;
+			}
+			e->length += bases;
+		}
+	}
+
+	const IndexedFile::Entry& IndexedFile::lookup(const std::string& title) const {
+		boost::unordered_map<std::string, Entry>::const_iterator it =
+			entries.find(title);
+		if (it == entries.end()) {
+			throw std::runtime_error("Record \"" + title + "\" not in FASTA file");
+		}
+		return it->second;
+	}
+
+	bool IndexedFile::hasSeq(const std::string& title) const {
+		return entries.find(title) != entries.end();
+	}
+
+	size_t IndexedFile::getLength(const std::string& title) const {
+		return lookup(title).length;
+	}
+
+	std::string IndexedFile::getSeq(const std::string& title,
+									const size_t start,
+									const size_t end,
+									const char strand,
+									const alphabet::Nucleotide& alphabet) {
+		const Entry& e = lookup(title);
+		if (end > e.length || end < start) {
+			throw std::runtime_error("Bad coordinates for " + title
+									 + ": " + util::string::toString(start)
+									 + "-" + util::string::toString(end));
+		}
+
+		std::string seq;
+		if (start == end) {
+			return seq;
+		}
+
+		// Read the bytes spanning the range, including line breaks
+		off_t first = e.offset + (start / e.lineBases) * e.lineBytes
+			+ start % e.lineBases;
+		off_t last = e.offset + ((end - 1) / e.lineBases) * e.lineBytes
+			+ (end - 1) % e.lineBases + 1;
+		std::vector<char> buffer(last - first);
+		{
+			util::thread::Lock lock(mutex);
+			fseeko(strm, first, SEEK_SET);
+			if (!util::io::binary::read(strm, &buffer[0], buffer.size())) {
+				throw std::runtime_error("Error while reading FASTA sequence");
+			}
+		}
+
+		seq.reserve(end - start);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			if (buffer[i] != '\n' && buffer[i] != '\r') {
+				seq += buffer[i];
+			}
+		}
+		if (seq.size() != end - start) {
+			throw std::runtime_error("Error while reading FASTA sequence for "
+									 + title);
+		}
+
+		if (strand == '-') {
+			alphabet.reverseComplementInPlace(seq);
+		}
+
+		return seq;
+	}
+
+} } }
@@ -0,0 +1,162 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bio/formats/maf/Index.hh"
+#include "bio/formats/maf/InputStream.hh"
+#include "bio/formats/maf/Record.hh"
+
+namespace bio { namespace formats { namespace maf {
+
+	const std::string Index::HEADER = "#mafindex";
+
+	Index::Index() : srcs(), sorted(true) {}
+
+	void Index::add(const genome::Interval& i, std::streamoff offset) {
+		Entry e = { i.getStart(), i.getEnd(), offset };
+		srcs[i.getChrom()].entries.push_back(e);
+		sorted = false;
+	}
+
+	void Index::sort() {
+		for (SrcMap::iterator s = srcs.begin(); s != srcs.end(); ++s) {
+			SrcIndex& index = s->second;
+			std::stable_sort(index.entries.begin(), index.entries.end());
+			index.maxEnds.resize(index.entries.size());
+			genome::Position maxEnd = 0;
+			for (size_t i = 0; i < index.entries.size(); ++i) {
+				maxEnd = std::max(maxEnd, index.entries[i].end);
+				index.maxEnds[i] = maxEnd;
+			}
+		}
+		sorted = true;
+	}
+
+	void Index::build(std::istream& strm) {
+		// Sequence text is not needed, so it is read lazily
+		InputStream input(strm, true);
+		Record rec;
+		while (input >> rec) {
+			for (size_t i = 0; i < rec.sequences.size(); ++i) {
+				add(rec.sequences[i], input.getRecordOffset());
+			}
+		}
+		sort();
+	}
+
+	void Index::read(std::istream& strm) {
+		std::string header;
+		if (not std::getline(strm, header) or header != HEADER) {
+			throw std::runtime_error("Invalid MAF index header: " + header);
+		}
+		std::string src;
+		Entry e;
+		while (strm >> src >> e.start >> e.end >> e.offset) {
+			srcs[src].entries.push_back(e);
+		}
+		if (not strm.eof()) {
+			throw std::runtime_error("Invalid MAF index line for " + src);
+		}
+		sort();
+	}
+
+	void Index::write(std::ostream& strm) const {
+		strm << HEADER << '\n';
+		for (SrcMap::const_iterator s = srcs.begin(); s != srcs.end(); ++s) {
+			const std::vector<Entry>& entries = s->second.entries;
+			for (size_t i = 0; i < entries.size(); ++i) {
+				strm << s->first << '\t'
+					 << entries[i].start << '\t'
+					 << entries[i].end << '\t'
+					 << entries[i].offset << '\n';
+			}
+		}
+	}
+
+	void Index::getOffsets(const genome::Interval& region,
+						   std::vector<std::streamoff>& offsets) const {
+		if (not sorted) {
+			throw std::logic_error("MAF index queried before being sorted");
+		}
+		SrcMap::const_iterator s = srcs.find(region.getChrom());
+		if (s == srcs.end()) {
+			return;
+		}
+		const SrcIndex& index = s->second;
+		// Entries before the first whose running maximum end passes the
+		// region start cannot overlap it
+		size_t i = std::upper_bound(index.maxEnds.begin(),
+									index.maxEnds.end(),
+									region.getStart())
+			- index.maxEnds.begin();
+		for (; i < index.entries.size()
+				 and index.entries[i].start < region.getEnd(); ++i) {
+			if (index.entries[i].end > region.getStart()) {
+				offsets.push_back(index.entries[i].offset);
+			}
+		}
+	}
+
+	bool Index::hasSrc(const std::string& src) const {
+		return srcs.find(src) != srcs.end();
+	}
+
+	IndexedReader::IndexedReader(std::istream& strm,
+								 const Index& index,
+								 bool lazyText)
+		: index(index), input(new InputStream(strm, lazyText)),
+		  offsets(), nextOffset(0), sorted(true) {
+	}
+
+	IndexedReader::~IndexedReader() {
+		delete input;
+	}
+
+	const Header& IndexedReader::getHeader() const {
+		return input->getHeader();
+	}
+
+	void IndexedReader::addRegion(const genome::Interval& region) {
+		index.getOffsets(region, offsets);
+		sorted = false;
+	}
+
+	bool IndexedReader::next(Record& rec) {
+		if (not sorted) {
+			std::sort(offsets.begin() + nextOffset, offsets.end());
+			offsets.erase(std::unique(offsets.begin() + nextOffset,
+									  offsets.end()),
+						  offsets.end());
+			sorted = true;
+		}
+		if (nextOffset == offsets.size()) {
+			return false;
+		}
+		input->seek(offsets[nextOffset++]);
+		if (*input >> rec) {
+			return true;
+		}
+		throw std::runtime_error("MAF index does not match the MAF file");
+	}
+
+} } }
@@ -17,20 +17,76 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
-#include <sstream>
+#include <algorithm>
+#include <cstdlib>
 
 #include "bio/formats/maf/InputStream.hh"
 #include "bio/formats/maf/Record.hh"
 #include "util/string.hh"
 using util::string::startsWith;
-using util::string::split;
+using util::string::Span;
 
 namespace bio { namespace formats { namespace maf {
 
-	InputStream::InputStream(std::istream& strm)
-		: strm(strm), hasNewRecord(false) {
+	InputStream::InputStream(std::istream& strm, bool lazyText)
+		: strm(strm), hasNewRecord(false), lazyText(lazyText),
+		  lineOffset(0), recordOffset(0) {
 		readHeader();
 	}
+
+	InputStream::InputStream(std::istream& strm, const Header& header,
+							 bool lazyText)
+		: strm(strm), header(header), hasNewRecord(false),
+		  lazyText(lazyText), lineOffset(0), recordOffset(0) {
+	}
+
+	std::streamoff InputStream::getRecordOffset() const {
+		return recordOffset;
+	}
+
+	void InputStream::seek(std::streamoff offset) {
+		strm.seek(offset);
+		hasNewRecord = false;
+	}
+
+	// Reads the next line, noting its offset
+	bool InputStream::readLine() {
+		lineOffset = strm.tell();
+		if (strm >> line) {
+			return true;
+		}
+		return false;
+	}
+
+	static bool isSpace(char c) {
+		return c == ' ' or c == '\t' or c == '\n' or c == '\r'
+			or c == '\f' or c == '\v';
+	}
+
+	// Stores the next whitespace-delimited token of [pos, end) in token
+	// and advances pos past it.  Returns false if there is none.
+	static bool nextToken(const char*& pos, const char* end, Span& token) {
+		while (pos != end and isSpace(*pos)) {
+			++pos;
+		}
+		if (pos == end) {
+			return false;
+		}
+		token.begin = pos;
+		while (pos != end and not isSpace(*pos)) {
+			++pos;
+		}
+		token.end = pos;
+		return true;
+	}
+
+	// Parses a token that is followed by whitespace or the end of a
+	// C string as an integer, returning false if it is not one
+	static bool parseInteger(const Span& token, long long& x) {
+		char* end;
+		x = std::strtoll(token.begin, &end, 10);
+		return end == token.end;
+	}
 	
 	InputStream::operator bool() const { return strm or hasNewRecord; }
 	bool InputStream::operator!() const { return not (strm or hasNewRecord); }
@@ -40,18 +96,17 @@ namespace bio { namespace formats { namespace maf {
 	}
 
 	void InputStream::parseVariables(const std::string& s, VariableMap& m) {
-		std::vector<std::string> tokens;
-		split(s, std::back_inserter(tokens));
-		typedef std::vector<std::string>::const_iterator Iterator;
-		for (Iterator i = tokens.begin(); i != tokens.end(); ++i) {
-			const std::string& token = *i;
-			size_t splitPoint = token.find('=');
-			if (splitPoint == std::string::npos) {
+		const char* pos = s.data();
+		const char* end = pos + s.size();
+		Span token;
+		while (nextToken(pos, end, token)) {
+			const char* splitPoint = std::find(token.begin, token.end, '=');
+			if (splitPoint == token.end) {
 				throw std::runtime_error("Invalid variable/value pair: "
-										 + token);
+										 + token.str());
 			}
-			m.setVariable(token.substr(0, splitPoint),
-						  token.substr(splitPoint + 1));
+			m.setVariable(std::string(token.begin, splitPoint),
+						  std::string(splitPoint + 1, token.end));
 		}
 	}
 	
@@ -73,13 +128,28 @@ namespace bio { namespace formats { namespace maf {
 	}
 
 	void InputStream::skipToNextParagraph() {
-		while (strm >> line) {
+		while (readLine()) {
 			if (not (line.empty() or startsWith(line, COMMENT_LINE_PREFIX))) {
 				break;
 			}
 		}
 	}		
 	
+	bool InputStream::readParagraph(std::string& text) {
+		hasNewRecord = false;
+		skipToNextParagraph();
+		if (not strm) {
+			return false;
+		}
+		do {
+			if (line.empty()) { break; }
+			text += line;
+			text += '\n';
+		} while (strm >> line);
+		text += '\n';
+		return true;
+	}
+
 	InputStream& InputStream::operator>>(Record& rec) {
 		hasNewRecord = false;
 		// Read paragraphs until an alignment block is found
@@ -89,11 +159,12 @@ namespace bio { namespace formats { namespace maf {
 		if (not strm) { return *this; }
 		
 		// Parse alignment line
+		recordOffset = lineOffset;
 		rec.variables.clear();
 		parseVariables(line.substr(ALIGNMENT_LINE_PREFIX.size()), rec);
 
-		// Parse sequence lines
-		rec.sequences.clear();
+		// Parse sequence lines into the record's existing sequences
+		size_t numSeqs = 0;
 		while (strm >> line) {
 			// Stop when end of paragraph has been reached
 			if (line.empty()) { break; }
@@ -103,18 +174,50 @@ namespace bio { namespace formats { namespace maf {
 				continue;
 			}
 
-			// Create a new sequence from the line
-			rec.sequences.push_back(Sequence());
-			Sequence& seq = rec.sequences.back();
-			std::istringstream seqStream(line.substr(SEQ_LINE_PREFIX.size()));
-			seqStream >> seq.src >> seq.start >> seq.size >> seq.strand
-					  >> seq.srcSize >> seq.text;
-			if (not seqStream) {
-				throw std::runtime_error("Invalid MAF sequence line:\n" + line);
+			if (numSeqs == rec.sequences.size()) {
+				rec.sequences.push_back(Sequence());
 			}
+			parseSequence(rec.sequences[numSeqs], numSeqs);
+			++numSeqs;
 		}
+		rec.sequences.resize(numSeqs);
 		hasNewRecord = true;
 		return *this;
 	}
+
+	void InputStream::parseSequence(Sequence& seq, size_t seqNum) {
+		// line is terminated, so numbers can be parsed in place
+		const char* pos = line.c_str() + SEQ_LINE_PREFIX.size();
+		const char* end = line.c_str() + line.size();
+		Span src, start, size, strand, srcSize, text;
+		long long x;
+		if (not (nextToken(pos, end, src)
+				 and nextToken(pos, end, start)
+				 and parseInteger(start, seq.start)
+				 and nextToken(pos, end, size)
+				 and parseInteger(size, x)
+				 and nextToken(pos, end, strand)
+				 and nextToken(pos, end, srcSize)
+				 and parseInteger(srcSize, seq.srcSize)
+				 and nextToken(pos, end, text))) {
+			throw std::runtime_error("Invalid MAF sequence line:\n" + line);
+		}
+		seq.size = x;
+		seq.src.assign(src.begin, src.end);
+		seq.strand = *strand.begin;
+
+		if (lazyText) {
+			// Keep the line, and point the sequence at its text
+			if (seqNum == seqLines.size()) {
+				seqLines.push_back(std::string());
+			}
+			size_t textOffset = text.begin - line.data();
+			seqLines[seqNum].swap(line);
+			seq.setTextView(seqLines[seqNum].data() + textOffset, text.size());
+		} else {
+			seq.setTextView(NULL, 0);
+			seq.getText().assign(text.begin, text.end);
+		}
+	}
 	
 } } }
@@ -30,6 +30,13 @@ namespace bio { namespace formats { namespace maf {
 		writeHeader(header);
 	}
 
+	OutputStream::OutputStream(std::ostream& strm, bool writeHeader)
+		: strm(strm) {
+		if (writeHeader) {
+			this->writeHeader(Header());
+		}
+	}
+
 	OutputStream& OutputStream::operator<<(const Record& rec) {
 		// Determine the maximum length of the fields
 		size_t maxSrcLength = 0;
@@ -109,9 +116,9 @@ namespace bio { namespace formats { namespace maf {
 			 << std::setw(maxSrcSizeLength)
 			 << std::right
 			 << s.srcSize
-			 << ' '
-			 << s.text
-			 << '\n';
+			 << ' ';
+		strm.write(s.getTextData(), s.getTextSize());
+		strm << '\n';
 	}
 
 	OutputStream::operator bool() const { return strm; }
@@ -0,0 +1,186 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <stdexcept>
+
+#include "bio/formats/maf/Pipeline.hh"
+#include "bio/formats/maf/InputStream.hh"
+#include "bio/formats/maf/OutputStream.hh"
+#include "bio/formats/maf/Record.hh"
+#include "util/thread.hh"
+using namespace util::thread;
+
+namespace bio { namespace formats { namespace maf {
+
+	const size_t Pipeline::DEFAULT_CHUNK_SIZE;
+
+	// State shared by the reading thread and the chunk tasks.  Finished
+	// chunks are held until all earlier chunks have been written.
+	class ChunkWriter {
+	public:
+		ChunkWriter(std::ostream& out, size_t maxInFlight)
+			: out(out), maxInFlight(maxInFlight), numInFlight(0),
+			  nextToWrite(0), failed(false) {}
+
+		// Waits for room for another chunk.  Returns false if a chunk
+		// has failed, in which case no more should be added.
+		bool reserve() {
+			Lock lock(m);
+			while (numInFlight >= maxInFlight and not failed) {
+				done.wait(m);
+			}
+			if (failed) {
+				return false;
+			}
+			++numInFlight;
+			return true;
+		}
+
+		// Takes the output of chunk i, writing it and any chunks waiting
+		// on it if it is next
+		void finish(size_t i, std::string& text, bool ok) {
+			Lock lock(m);
+			if (not ok) {
+				failed = true;
+			} else if (not failed) {
+				pending[i].swap(text);
+				std::map<size_t, std::string>::iterator next;
+				while ((next = pending.find(nextToWrite)) != pending.end()) {
+					out.write(next->second.data(), next->second.size());
+					pending.erase(next);
+					++nextToWrite;
+				}
+			}
+			--numInFlight;
+			done.signal();
+		}
+
+	private:
+		std::ostream& out;
+		size_t maxInFlight;
+		size_t numInFlight;
+		size_t nextToWrite;
+		bool failed;
+		std::map<size_t, std::string> pending;
+		Mutex m;
+		Condition done;
+	};
+
+	class ChunkTask : public Task {
+	public:
+		ChunkTask(size_t index,
+				  std::string& chunk,
+				  const Header& header,
+				  bool lazyText,
+				  const Pipeline::Transform& transform,
+				  ChunkWriter& writer)
+			: index(index), header(header), lazyText(lazyText),
+			  transform(transform), writer(writer) {
+			text.swap(chunk);
+		}
+
+		void run() {
+			std::string output;
+			try {
+				std::istringstream in(text);
+				std::ostringstream out;
+				InputStream inputStream(in, header, lazyText);
+				OutputStream outputStream(out, false);
+				Record rec;
+				while (inputStream >> rec) {
+					if (transform(rec)) {
+						outputStream << rec;
+					}
+				}
+				output = out.str();
+			} catch (...) {
+				writer.finish(index, output, false);
+				throw;
+			}
+			writer.finish(index, output, true);
+		}
+
+	private:
+		size_t index;
+		std::string text;
+		const Header& header;
+		bool lazyText;
+		const Pipeline::Transform& transform;
+		ChunkWriter& writer;
+	};
+
+	Pipeline::Pipeline(size_t numThreads, bool lazyText, size_t chunkSize)
+		: numThreads(numThreads == 0 ? numProcessors() : numThreads),
+		  lazyText(lazyText),
+		  chunkSize(chunkSize) {
+	}
+
+	void Pipeline::runSerial(std::istream& in, std::ostream& out,
+							 const Transform& transform) const {
+		InputStream inputStream(in, lazyText);
+		OutputStream outputStream(out, inputStream.getHeader());
+		Record rec;
+		while (inputStream >> rec) {
+			if (transform(rec)) {
+				outputStream << rec;
+			}
+		}
+	}
+
+	void Pipeline::run(std::istream& in, std::ostream& out,
+					   const Transform& transform) const {
+		if (numThreads == 1) {
+			runSerial(in, out, transform);
+			return;
+		}
+
+		InputStream inputStream(in);
+		OutputStream outputStream(out, inputStream.getHeader());
+
+		// Allow enough chunks in flight to keep every thread busy while
+		// the chunk to be written next is being processed.  The pool is
+		// declared last so that its threads are joined before the
+		// writer they use is destroyed.
+		ChunkWriter writer(out, 2 * numThreads + 1);
+		ThreadPool pool(numThreads);
+
+		std::string chunk;
+		size_t numChunks = 0;
+		bool more = true;
+		while (more) {
+			chunk.clear();
+			while (chunk.size() < chunkSize
+				   and (more = inputStream.readParagraph(chunk))) {
+			}
+			if (chunk.empty() or not writer.reserve()) {
+				break;
+			}
+			pool.add(new ChunkTask(numChunks++, chunk,
+								   inputStream.getHeader(), lazyText,
+								   transform, writer));
+		}
+		pool.wait();
+	}
+
+} } }
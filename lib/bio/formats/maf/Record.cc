@@ -25,7 +25,7 @@ namespace bio { namespace formats { namespace maf {
 
 	size_t Record::getNumCols() const {
 		assert(not sequences.empty());
-		return sequences.front().text.size();
+		return sequences.front().getTextSize();
 	}
 	
 	size_t Record::getNumSeqs() const {
@@ -33,7 +33,7 @@ namespace bio { namespace formats { namespace maf {
 	}
 	
 	std::string Record::getSeq(size_t seqNum) const {
-		return sequences[seqNum].text;
+		return sequences[seqNum].getText();
 	}
 	   
 	std::string Record::getSubstring(size_t seqNum,
@@ -22,6 +22,37 @@
 
 namespace bio { namespace formats { namespace maf {
 
+	Sequence::Sequence()
+		: start(0), size(0), srcSize(0), textView(NULL), textViewSize(0) {
+	}
+
+	Sequence::Sequence(const Sequence& other)
+		: genome::MutableInterval(other),
+		  src(other.src),
+		  start(other.start),
+		  size(other.size),
+		  strand(other.strand),
+		  srcSize(other.srcSize),
+		  text(other.getTextData(), other.getTextSize()),
+		  textView(NULL),
+		  textViewSize(0) {
+	}
+
+	Sequence& Sequence::operator=(const Sequence& other) {
+		if (this != &other) {
+			genome::MutableInterval::operator=(other);
+			src = other.src;
+			start = other.start;
+			size = other.size;
+			strand = other.strand;
+			srcSize = other.srcSize;
+			text.assign(other.getTextData(), other.getTextSize());
+			textView = NULL;
+			textViewSize = 0;
+		}
+		return *this;
+	}
+
 	std::string Sequence::getChrom() const {
 		return src;
 	}
@@ -47,6 +78,7 @@ namespace bio { namespace formats { namespace maf {
 	}
 
 	void Sequence::setSequence(const std::string& s) {
+		textView = NULL;
 		text = s;
 		size = s.size() - std::count(s.begin(), s.end(), '-');
 	}
@@ -18,11 +18,13 @@
 */
 
 #include <string>
+#include <algorithm>
+#include <cstring>
 #include <cstdlib> // For atoi, atol, atof
-#include "boost/tokenizer.hpp"
 
 #include "bio/gff/GFFRecord.hh"
 #include "util/parser.hh"
+#include "util/string.hh"
 
 namespace bio { namespace gff {
 
@@ -37,9 +39,45 @@ namespace bio { namespace gff {
 		frame('.'),
 		attributeString(""),
 		attributes(),
+		numAttributes(0),
 		validScore(false)
 	{}
 
+	GFFRecord::GFFRecord(const GFFRecord& r) :
+		seqname(r.seqname),
+		source(r.source),
+		feature(r.feature),
+		start(r.start),
+		end(r.end),
+		score(r.score),
+		strand(r.strand),
+		frame(r.frame),
+		attributeString(r.attributeString),
+		attributes(r.attributes.begin(),
+				   r.attributes.begin() + r.numAttributes),
+		numAttributes(r.numAttributes),
+		validScore(r.validScore)
+	{}
+
+	GFFRecord& GFFRecord::operator=(const GFFRecord& r) {
+		if (this != &r) {
+			seqname = r.seqname;
+			source = r.source;
+			feature = r.feature;
+			start = r.start;
+			end = r.end;
+			score = r.score;
+			strand = r.strand;
+			frame = r.frame;
+			attributeString = r.attributeString;
+			attributes.assign(r.attributes.begin(),
+							  r.attributes.begin() + r.numAttributes);
+			numAttributes = r.numAttributes;
+			validScore = r.validScore;
+		}
+		return *this;
+	}
+
 	const std::string GFFRecord::THE_EMPTY_STRING = "";
 	GFFRecord::StringMap GFFRecord::seqnames = GFFRecord::StringMap();
 	GFFRecord::StringMap GFFRecord::sources = GFFRecord::StringMap();
@@ -54,33 +92,110 @@ namespace bio { namespace gff {
 						 and getEnd() < r.getEnd())));
 	}
 	
+	size_t GFFRecord::getMemorySize() const {
+		size_t size = sizeof(GFFRecord) + attributeString.size();
+		for (size_t i = 0; i < numAttributes; ++i) {
+			const Attribute& a = attributes[i];
+			size += sizeof(Attribute) + a.tag.size();
+			for (size_t j = 0; j < a.values.size(); ++j) {
+				size += sizeof(std::string) + a.values[j].size();
+			}
+		}
+		return size;
+	}
+	
+	// Returns the string to hold the next token of an attribute,
+	// reusing the slot at index i of strs if there is one
+	static std::string& tokenSlot(std::vector<std::string>& strs, size_t i) {
+		if (i == strs.size()) {
+			strs.push_back(std::string());
+		}
+		strs[i].clear();
+		return strs[i];
+	}
+
+	// Reads the next token (a word, possibly with quoted parts and
+	// backslash escapes) from [pos, end) into token, and returns the
+	// position after the token
+	static const char* readAttributeToken(const char* pos,
+										  const char* end,
+										  std::string& token) {
+		bool inQuote = false;
+		for (; pos != end; ++pos) {
+			char c = *pos;
+			if (c == '\\') {
+				if (++pos == end) {
+					throw std::runtime_error("Invalid escape in GFF "
+											 "attributes");
+				}
+				switch (*pos) {
+				case '\\':
+				case '"':
+					token += *pos;
+					break;
+				case 'n':
+					token += '\n';
+					break;
+				default:
+					throw std::runtime_error("Invalid escape in GFF "
+											 "attributes");
+				}
+			} else if (c == '"') {
+				inQuote = !inQuote;
+			} else if (c == ' ' && !inQuote) {
+				return pos + 1;
+			} else {
+				token += c;
+			}
+		}
+		return pos;
+	}
+
 	void GFFRecord::parseAttributes() const {
 		// Check if attribute parsing has already been done (or if
 		// there are no attributes to parse)
 		if (attributeString.empty()) {
 			return;
 		}
-		
-		typedef boost::tokenizer<boost::char_separator<char> > CharTok;
-		typedef boost::tokenizer<boost::escaped_list_separator<char> > EscListTok;
-
-		CharTok ctok(attributeString, boost::char_separator<char>(";"));
-		for (CharTok::iterator pos = ctok.begin(); pos != ctok.end(); ++pos) {
-			EscListTok ltok(*pos,
-							boost::escaped_list_separator<char>('\\', ' ', '\"'));
-			Attribute a;
-			for (EscListTok::iterator sub = ltok.begin();
-				 sub != ltok.end(); ++sub) {
-				if (sub->empty()) {
+
+		// Attributes are separated by semicolons, and the tag and
+		// values of each attribute by spaces.  Tokens are read directly
+		// into unused attribute slots, which are only counted once a
+		// tag has been found.
+		const char* pos = attributeString.data();
+		const char* end = pos + attributeString.size();
+		while (pos != end) {
+			const char* attrEnd = static_cast<const char*>
+				(std::memchr(pos, ';', end - pos));
+			if (attrEnd == NULL) {
+				attrEnd = end;
+			}
+			if (numAttributes == attributes.size()) {
+				attributes.push_back(Attribute());
+			}
+			Attribute& a = attributes[numAttributes];
+			bool hasTag = false;
+			size_t numValues = 0;
+			while (pos != attrEnd) {
+				std::string& token = (hasTag
+									  ? tokenSlot(a.values, numValues)
+									  : a.tag);
+				token.clear();
+				pos = readAttributeToken(pos, attrEnd, token);
+				if (token.empty()) {
 					continue;
-				} else if (a.tag.empty()) {
-					a.tag = *sub;
+				} else if (hasTag) {
+					++numValues;
 				} else {
-					a.values.push_back(*sub);
+					hasTag = true;
 				}
 			}
-			if (!a.tag.empty()) {
-				attributes.push_back(a);
+			if (hasTag) {
+				a.values.resize(numValues);
+				++numAttributes;
+			}
+			if (pos != end) {
+				++pos;
 			}
 		}
 
@@ -89,11 +204,17 @@ namespace bio { namespace gff {
 		attributeString.clear();
 	}
 
-	GFFRecord::Attribute& GFFRecord::getAttribute(const std::string& tag) const {
+	GFFRecord::AttributeList::iterator
+	GFFRecord::findAttribute(const std::string& tag) const {
 		parseAttributes();
-		AttributeList::iterator pos = std::find_if(attributes.begin(),
-												   attributes.end(),
+		AttributeList::iterator last = attributes.begin() + numAttributes;
+		AttributeList::iterator pos = std::find_if(attributes.begin(), last,
 												   AttributeFinder(tag));
+		return pos == last ? attributes.end() : pos;
+	}
+
+	GFFRecord::Attribute& GFFRecord::getAttribute(const std::string& tag) const {
+		AttributeList::iterator pos = findAttribute(tag);
 		if (pos == attributes.end()) {
 			throw std::runtime_error(std::string("Attribute not found: ")
 									 + tag);
@@ -103,24 +224,39 @@ namespace bio { namespace gff {
 	}
 
 	bool GFFRecord::hasAttribute(const std::string& tag) const {
-		parseAttributes();
-		return std::find_if(attributes.begin(),
-							attributes.end(),
-							AttributeFinder(tag)) != attributes.end();
+		return findAttribute(tag) != attributes.end();
+	}
+
+	GFFRecord::Attribute& GFFRecord::nextAttributeSlot() const {
+		if (numAttributes == attributes.size()) {
+			attributes.push_back(Attribute());
+		}
+		return attributes[numAttributes++];
 	}
 
 	GFFRecord::Attribute& GFFRecord::addAttribute(const std::string& tag) {
 		parseAttributes();
-		attributes.push_back(Attribute());
-		attributes.back().tag = tag;
-		return attributes.back();
+		Attribute& a = nextAttributeSlot();
+		a.tag = tag;
+		a.values.clear();
+		return a;
 	}
 
 	void GFFRecord::removeAttribute(const std::string& tag) {
 		parseAttributes();
-		attributes.erase(std::remove_if(attributes.begin(), attributes.end(),
-										AttributeFinder(tag)),
-						 attributes.end());
+		// Compact the remaining attributes, swapping removed ones into
+		// the unused slots
+		size_t kept = 0;
+		for (size_t i = 0; i < numAttributes; ++i) {
+			if (attributes[i].tag != tag) {
+				if (kept != i) {
+					attributes[kept].tag.swap(attributes[i].tag);
+					attributes[kept].values.swap(attributes[i].values);
+				}
+				++kept;
+			}
+		}
+		numAttributes = kept;
 	}
 
 	const std::string*
@@ -132,6 +268,52 @@ namespace bio { namespace gff {
 		return pos->second;
 	}
 
+	const std::string*
+	GFFRecord::storeString(const char* begin,
+						   const char* end,
+						   const std::string* current,
+						   StringMap& strmap) {
+		// Consecutive records usually share their seqname, source and
+		// feature, so check the current value before hashing
+		util::string::Span s = { begin, end };
+		if (s == *current) {
+			return current;
+		}
+		// Look up the string through a reused key to avoid allocating
+		static std::string key;
+		key.assign(begin, end);
+		StringMap::const_iterator pos = strmap.find(key);
+		if (pos == strmap.end()) {
+			pos = strmap.insert(std::make_pair(key, new std::string(key))).first;
+		}
+		return pos->second;
+	}
+
+	void GFFRecord::writeAttributes(std::ostream& strm) const {
+		if (attributeString.empty()) {
+			AttributeList::const_iterator pos;
+			AttributeList::const_iterator last =
+				attributes.begin() + numAttributes;
+			for (pos = attributes.begin(); pos != last; ++pos) {
+				if (pos != attributes.begin()) {
+					strm << " ; ";
+				}
+				strm << pos->tag;
+				std::vector<std::string>::const_iterator vpos;
+				for (vpos = pos->values.begin();
+					 vpos != pos->values.end(); ++vpos) {
+					if (util::parser::isFreeText(*vpos)) {
+						strm << ' ' <<  '"' << *vpos << '"';
+					} else {
+						strm << ' ' << *vpos;
+					}
+				}
+			}
+		} else {
+			strm << attributeString;
+		}
+	}
+
 	std::ostream& operator<<(std::ostream& strm, const GFFRecord& r) {
 
 		strm << r.getSeqname() << '\t'
@@ -149,26 +331,7 @@ namespace bio { namespace gff {
 		strm << r.strand << '\t'
 			 << r.frame << '\t';
 
-		if (r.attributeString.empty()) {
-			GFFRecord::AttributeList::const_iterator pos;
-			for (pos = r.attributes.begin(); pos != r.attributes.end(); ++pos) {
-				if (pos != r.attributes.begin()) {
-					strm << " ; ";
-				}
-				strm << pos->tag;
-				std::list<std::string>::const_iterator vpos;
-				for (vpos = pos->values.begin();
-					 vpos != pos->values.end(); ++vpos) {
-					if (util::parser::isFreeText(*vpos)) {
-						strm << ' ' <<  '"' << *vpos << '"';
-					} else {
-						strm << ' ' << *vpos;
-					}
-				}
-			}
-		} else {
-			strm << r.attributeString;
-		}
+		r.writeAttributes(strm);
 
 		strm << '\n';
 
@@ -204,95 +367,80 @@ namespace bio { namespace gff {
 		return strm;
 	}
 
-	void operator>>(const std::string& line, GFFRecord& rec) {
-		// Split the string at tabs
-		typedef boost::char_separator<char> CharSep;
-		typedef boost::tokenizer<CharSep> CharTok;
-		CharTok tabtok(line, CharSep("\t", "", boost::keep_empty_tokens));
-
-		// Step through tokens
-		CharTok::iterator t = tabtok.begin();
-
-		// Parse seqname
- 		if (t == tabtok.end()) {
- 			throw util::parser::FormatError(line, "invalid number of fields");
- 		}
-		rec.setSeqname(*t);
-
-		// Parse source
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
+	// Converts a field to a number as atoi/atof would, copying it to a
+	// terminated buffer on the stack
+	static int spanToInt(const util::string::Span& s) {
+		char buf[32];
+		if (s.size() >= sizeof(buf)) {
+			return std::atoi(s.str().c_str());
 		}
-		rec.setSource(*t);
-
-		// Parse feature
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
-		}		
-		rec.setFeature(*t);
+		std::copy(s.begin, s.end, buf);
+		buf[s.size()] = '\0';
+		return std::atoi(buf);
+	}
 
-		// Parse start
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
+	static double spanToDouble(const util::string::Span& s) {
+		char buf[64];
+		if (s.size() >= sizeof(buf)) {
+			return std::atof(s.str().c_str());
 		}
-		rec.start = std::atoi(t->c_str());
+		std::copy(s.begin, s.end, buf);
+		buf[s.size()] = '\0';
+		return std::atof(buf);
+	}
 
-		// Parse end
-		++t;
-		if (t == tabtok.end()) {
+	void operator>>(const std::string& line, GFFRecord& rec) {
+		// Split the line at tabs into the nine GFF fields, with any
+		// further tab-separated fields included in the attribute field
+		const size_t NUM_FIELDS = 9;
+		util::string::Span fields[NUM_FIELDS];
+		size_t numFields = util::string::splitSpans(line.data(),
+													line.data() + line.size(),
+													'\t',
+													fields,
+													NUM_FIELDS);
+		if (numFields < NUM_FIELDS) {
 			throw util::parser::FormatError(line, "invalid number of fields");
 		}
-		rec.end = std::atoi(t->c_str());
+
+		// Parse seqname, source, and feature
+		rec.seqname = GFFRecord::storeString(fields[0].begin, fields[0].end,
+											 rec.seqname, GFFRecord::seqnames);
+		rec.source = GFFRecord::storeString(fields[1].begin, fields[1].end,
+											rec.source, GFFRecord::sources);
+		rec.feature = GFFRecord::storeString(fields[2].begin, fields[2].end,
+											 rec.feature, GFFRecord::features);
+
+		// Parse start and end
+		rec.start = spanToInt(fields[3]);
+		rec.end = spanToInt(fields[4]);
 
 		// Parse score
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
-		}		
-		if (*t == ".") {
+		if (fields[5].size() == 1 && *fields[5].begin == '.') {
 			rec.unsetScore();
 		} else {
-			rec.setScore(std::atof(t->c_str()));
-		}
-
-		// Parse strand
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
+			rec.setScore(spanToDouble(fields[5]));
 		}
-		rec.strand = (*t).at(0);
 
-		// Parse frame
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
+		// Parse strand and frame
+		if (fields[6].empty() || fields[7].empty()) {
+			throw util::parser::FormatError(line, "empty strand or frame");
 		}
-		rec.frame = (*t).at(0);
+		rec.strand = *fields[6].begin;
+		rec.frame = *fields[7].begin;
 		
-		// Parse attributes
-		++t;
-		if (t == tabtok.end()) {
-			throw util::parser::FormatError(line, "invalid number of fields");
-		}
-		std::string attributeString = *t;
-		++t;
-		while (t != tabtok.end()) {
-			attributeString += " " + *t;
-			++t;
-		}
 		// Remove previous attributes
-		rec.attributes.clear();
-		// Strip off any comments
-		std::string::size_type commentBegin = attributeString.find('#');
-		if (commentBegin != std::string::npos) {
-			rec.attributeString = attributeString.substr(0, commentBegin);
-		} else {
-			rec.attributeString = attributeString;
+		rec.numAttributes = 0;
+		// Store attributes without any comment, separating any extra
+		// fields by spaces
+		const char* attrEnd = static_cast<const char*>
+			(std::memchr(fields[8].begin, '#', fields[8].size()));
+		if (attrEnd == NULL) {
+			attrEnd = fields[8].end;
 		}
-
+		rec.attributeString.assign(fields[8].begin, attrEnd);
+		std::replace(rec.attributeString.begin(), rec.attributeString.end(),
+					 '\t', ' ');
 	}
 
 	genome::BasicInterval GFFRecord::getInterval() const {
@@ -0,0 +1,267 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <sstream>
+
+#include "bio/gff/GFFTable.hh"
+
+namespace bio { namespace gff {
+
+	const GFFTable::Id GFFTable::NO_ID = static_cast<GFFTable::Id>(-1);
+
+	GFFTable::Id GFFTable::StringPool::intern(const std::string& s) {
+		// Consecutive rows usually share their values
+		if (not names.empty() and s == lastName) {
+			return lastId;
+		}
+		IdMap::const_iterator pos = ids.find(s);
+		if (pos == ids.end()) {
+			pos = ids.insert(std::make_pair(s, Id(names.size()))).first;
+			names.push_back(s);
+		}
+		lastName = s;
+		lastId = pos->second;
+		return lastId;
+	}
+
+	GFFTable::Id GFFTable::StringPool::find(const std::string& s) const {
+		IdMap::const_iterator pos = ids.find(s);
+		return pos == ids.end() ? NO_ID : pos->second;
+	}
+
+	void GFFTable::StringPool::clear() {
+		names.clear();
+		ids.clear();
+		lastName.clear();
+	}
+
+	GFFTable::GFFTable() {}
+
+	const GFFTable::StringPool& GFFTable::getPool(Column c) const {
+		switch (c) {
+		case SEQNAME:
+			return seqnamePool;
+		case SOURCE:
+			return sourcePool;
+		default:
+			return featurePool;
+		}
+	}
+
+	const std::vector<GFFTable::Id>& GFFTable::getIds(Column c) const {
+		switch (c) {
+		case SEQNAME:
+			return seqnames;
+		case SOURCE:
+			return sources;
+		default:
+			return features;
+		}
+	}
+
+	void GFFTable::push_back(const GFFRecord& rec) {
+		seqnames.push_back(seqnamePool.intern(rec.getSeqname()));
+		sources.push_back(sourcePool.intern(rec.getSource()));
+		features.push_back(featurePool.intern(rec.getFeature()));
+		starts.push_back(rec.start);
+		ends.push_back(rec.end);
+		scores.push_back(rec.score);
+		validScores.push_back(rec.validScore);
+		strands.push_back(rec.strand);
+		frames.push_back(rec.frame);
+
+		// Keep the attribute text as it was read, unless the attributes
+		// have been parsed (and possibly modified)
+		if (not rec.attributeString.empty() or rec.numAttributes == 0) {
+			attributeArena += rec.attributeString;
+		} else {
+			std::ostringstream attributes;
+			rec.writeAttributes(attributes);
+			attributeArena += attributes.str();
+		}
+		attributeEnds.push_back(attributeArena.size());
+	}
+
+	void GFFTable::clear() {
+		seqnamePool.clear();
+		sourcePool.clear();
+		featurePool.clear();
+		seqnames.clear();
+		sources.clear();
+		features.clear();
+		starts.clear();
+		ends.clear();
+		scores.clear();
+		validScores.clear();
+		strands.clear();
+		frames.clear();
+		attributeArena.clear();
+		attributeEnds.clear();
+	}
+
+	size_t GFFTable::memoryUsage() const {
+		size_t rowSize = 3 * sizeof(Id) + 2 * sizeof(genome::Position)
+			+ sizeof(GFFRecord::Score) + 3 + sizeof(size_t);
+		return size() * rowSize + attributeArena.size();
+	}
+
+	std::string GFFTable::getAttributeString(Row r) const {
+		size_t begin = (r == 0 ? 0 : attributeEnds[r - 1]);
+		return attributeArena.substr(begin, attributeEnds[r] - begin);
+	}
+
+	void GFFTable::getRecord(Row r, GFFRecord& rec) const {
+		const std::string& seqname = getSeqname(r);
+		const std::string& source = getSource(r);
+		const std::string& feature = getFeature(r);
+		rec.seqname = GFFRecord::storeString(seqname.data(),
+											 seqname.data() + seqname.size(),
+											 rec.seqname,
+											 GFFRecord::seqnames);
+		rec.source = GFFRecord::storeString(source.data(),
+											source.data() + source.size(),
+											rec.source,
+											GFFRecord::sources);
+		rec.feature = GFFRecord::storeString(feature.data(),
+											 feature.data() + feature.size(),
+											 rec.feature,
+											 GFFRecord::features);
+		rec.start = starts[r];
+		rec.end = ends[r];
+		rec.score = scores[r];
+		rec.validScore = validScores[r];
+		rec.strand = strands[r];
+		rec.frame = frames[r];
+		size_t begin = (r == 0 ? 0 : attributeEnds[r - 1]);
+		rec.attributeString.assign(attributeArena, begin,
+								   attributeEnds[r] - begin);
+		rec.numAttributes = 0;
+	}
+
+	void GFFTable::write(std::ostream& strm, Row r) const {
+		strm << getSeqname(r) << '\t'
+			 << getSource(r) << '\t'
+			 << getFeature(r) << '\t'
+			 << starts[r] << '\t'
+			 << ends[r] << '\t';
+
+		if (validScores[r]) {
+			strm << scores[r] << '\t';
+		} else {
+			strm << '.' << '\t';
+		}
+
+		strm << strands[r] << '\t'
+			 << frames[r] << '\t';
+
+		size_t begin = (r == 0 ? 0 : attributeEnds[r - 1]);
+		strm.write(attributeArena.data() + begin, attributeEnds[r] - begin);
+
+		strm << '\n';
+	}
+
+	void GFFTable::getRows(RowList& rows) const {
+		rows.resize(size());
+		for (Row r = 0; r < rows.size(); ++r) {
+			rows[r] = r;
+		}
+	}
+
+	// Orders rows by the rank of their seqname name, then start and end
+	struct GFFTable::PositionLessThan {
+		const GFFTable* table;
+		const std::vector<Id>* seqnameRanks;
+
+		bool operator()(Row a, Row b) const {
+			Id rankA = (*seqnameRanks)[table->seqnames[a]];
+			Id rankB = (*seqnameRanks)[table->seqnames[b]];
+			return rankA < rankB
+				or (rankA == rankB
+					and (table->starts[a] < table->starts[b]
+						 or (table->starts[a] == table->starts[b]
+							 and table->ends[a] < table->ends[b])));
+		}
+	};
+
+	// Orders seqname IDs by name
+	struct NameLessThan {
+		const std::vector<std::string>* names;
+		bool operator()(GFFTable::Id a, GFFTable::Id b) const {
+			return (*names)[a] < (*names)[b];
+		}
+	};
+
+	void GFFTable::sortByPosition(RowList& rows) const {
+		// Rank seqnames by name once, so that rows compare by integers
+		std::vector<Id> byName(seqnamePool.size());
+		std::vector<std::string> names(seqnamePool.size());
+		for (Id id = 0; id < byName.size(); ++id) {
+			byName[id] = id;
+			names[id] = seqnamePool.getName(id);
+		}
+		NameLessThan nameLess = { &names };
+		std::sort(byName.begin(), byName.end(), nameLess);
+		std::vector<Id> ranks(byName.size());
+		for (Id i = 0; i < byName.size(); ++i) {
+			ranks[byName[i]] = i;
+		}
+
+		PositionLessThan less = { this, &ranks };
+		std::stable_sort(rows.begin(), rows.end(), less);
+	}
+
+	void GFFTable::filterById(RowList& rows, Column c, Id id) const {
+		const std::vector<Id>& ids = getIds(c);
+		RowList::iterator out = rows.begin();
+		for (RowList::const_iterator r = rows.begin(); r != rows.end(); ++r) {
+			if (ids[*r] == id) {
+				*out = *r;
+				++out;
+			}
+		}
+		rows.erase(out, rows.end());
+	}
+
+	void GFFTable::groupBy(RowList& rows,
+						   Column c,
+						   std::vector<size_t>& groupStarts) const {
+		// Counting sort of the rows by ID
+		const std::vector<Id>& ids = getIds(c);
+		std::vector<size_t> offsets(getNumIds(c) + 1, 0);
+		for (RowList::const_iterator r = rows.begin(); r != rows.end(); ++r) {
+			++offsets[ids[*r] + 1];
+		}
+		groupStarts.clear();
+		for (size_t i = 1; i < offsets.size(); ++i) {
+			if (offsets[i] > 0) {
+				groupStarts.push_back(offsets[i - 1]);
+			}
+			offsets[i] += offsets[i - 1];
+		}
+		groupStarts.push_back(rows.size());
+
+		RowList grouped(rows.size());
+		for (RowList::const_iterator r = rows.begin(); r != rows.end(); ++r) {
+			grouped[offsets[ids[*r]]++] = *r;
+		}
+		rows.swap(grouped);
+	}
+
+} }
@@ -0,0 +1,66 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+
+#include "bio/homologymap/BatchHomologyMapper.hh"
+
+namespace bio { namespace homologymap {
+
+	BatchHomologyMapper::BatchHomologyMapper(const HomologyMapper& mapper,
+											 size_t numThreads)
+		: genome::BatchMapper<const Segment*>(numThreads),
+		  mapper(mapper) {
+	}
+
+	void BatchHomologyMapper::getGroups(const genome::Interval& i,
+										std::vector<const Segment*>& segs) const {
+		std::vector<Segment*> overlapping;
+		mapper.getSegments(i, overlapping);
+		segs.insert(segs.end(), overlapping.begin(), overlapping.end());
+	}
+
+	BatchHomologyMapper::Worker* BatchHomologyMapper::newWorker() const {
+		return new SegmentWorker(mapper);
+	}
+
+	BatchHomologyMapper::SegmentWorker::SegmentWorker(const HomologyMapper& mapper)
+		: mapper(mapper), align(), alignSeg(NULL), alignRead(false) {
+	}
+
+	void BatchHomologyMapper::SegmentWorker::map(const genome::Interval& i,
+												 const Segment* const& seg,
+												 std::vector<genome::BasicInterval>& mapped) {
+		if (seg != alignSeg) {
+			alignSeg = seg;
+			alignRead = mapper.readAlignment(seg->num, align);
+			if (not alignRead) {
+				std::cerr << "Warning: Could not open alignment file for "
+						  << "segment " << seg->num << '\n';
+			}
+		}
+		if (not alignRead) { return; }
+
+		genome::BasicInterval targetInterval;
+		if (mapper.mapSegment(*seg, align, i, targetInterval)) {
+			mapped.push_back(targetInterval);
+		}
+	}
+
+} }
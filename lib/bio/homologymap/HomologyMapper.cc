@@ -79,7 +79,13 @@ namespace bio { namespace homologymap {
 			
 	bool HomologyMapper::readAlignment(size_t segmentNum) {
 		if (segmentNum == lastSegmentNum) { return true; }
-		
+		if (not readAlignment(segmentNum, align)) { return false; }
+		lastSegmentNum = segmentNum;
+		return true;
+	}
+
+	bool HomologyMapper::readAlignment(size_t segmentNum,
+									   alignment::BasicNamedMultipleAlignment& segAlign) const {
 		// Read in alignment file
 		filesystem::InputFileStream segFile;
 		try {
@@ -88,8 +94,7 @@ namespace bio { namespace homologymap {
 			return false;
 		}
 		formats::fasta::InputStream fastaStream(segFile);
-		fastaStream >> align;
-		lastSegmentNum = segmentNum;
+		fastaStream >> segAlign;
 		return true;
 	}
 
@@ -99,7 +104,8 @@ namespace bio { namespace homologymap {
 		i.end = length - i.end;
 	}
 
-	void HomologyMapper::getInterval(genome::Interval* segSourceInt,
+	void HomologyMapper::getInterval(const alignment::BasicNamedMultipleAlignment& align,
+									 genome::Interval* segSourceInt,
 									 genome::Interval* segTargetInt,
 									 int alignSourceNum,
 									 int alignTargetNum,
@@ -179,7 +185,7 @@ namespace bio { namespace homologymap {
 			int alignSourceNum = align.getSeqNum(source);
 			int alignTargetNum = align.getSeqNum(target);
 
-			getInterval(segSourceInt, segTargetInt,
+			getInterval(align, segSourceInt, segTargetInt,
 						alignSourceNum, alignTargetNum,
 						sourceInterval, targetInterval);
 			
@@ -188,6 +194,33 @@ namespace bio { namespace homologymap {
 			}
 		}
 	}		
+
+	void HomologyMapper::getSegments(const genome::Interval& i,
+									 std::vector<Segment*>& segs) const {
+		size_t sourceIndex = getIndex(sourceGenome);
+		size_t targetIndex = getIndex(targetGenome);
+
+		std::vector<Segment*> sourceSegs;
+		hmap.getSegments(sourceIndex, i, sourceSegs);
+		for (size_t s = 0; s < sourceSegs.size(); ++s) {
+			if (sourceSegs[s]->hasGenome(targetIndex)) {
+				segs.push_back(sourceSegs[s]);
+			}
+		}
+	}
+
+	bool HomologyMapper::mapSegment(const Segment& seg,
+									const alignment::BasicNamedMultipleAlignment& segAlign,
+									const genome::Interval& i,
+									genome::BasicInterval& mapped) const {
+		getInterval(segAlign,
+					seg.intervals[getIndex(sourceGenome)],
+					seg.intervals[getIndex(targetGenome)],
+					segAlign.getSeqNum(sourceGenome),
+					segAlign.getSeqNum(targetGenome),
+					i, mapped);
+		return mapped.getLength() > 0;
+	}
 		
 	void HomologyMapper::setTargetGenome(const std::string& targetGenome) {
 		this->targetGenome = targetGenome;
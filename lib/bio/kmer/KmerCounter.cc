@@ -0,0 +1,163 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <stdexcept>
+#include <limits>
+
+#include "bio/kmer/KmerCounter.hh"
+#include "util/string.hh"
+
+namespace bio { namespace kmer {
+
+	const size_t KmerCounter::MAX_K;
+	const size_t KmerCounter::SHARD_BITS;
+	const Kmer KmerCounter::EMPTY;
+
+	// An open-addressing table with linear probing, kept at most half
+	// full
+	struct KmerCounter::Shard {
+		util::thread::Mutex mutex;
+		std::vector<Kmer> keys;
+		std::vector<uint32_t> counts;
+		size_t size;
+
+		Shard() : keys(1024, EMPTY), counts(1024, 0), size(0) {}
+
+		size_t find(Kmer kmer, uint64_t h) const {
+			size_t slotMask = keys.size() - 1;
+			size_t slot = h & slotMask;
+			while (keys[slot] != kmer and keys[slot] != EMPTY) {
+				slot = (slot + 1) & slotMask;
+			}
+			return slot;
+		}
+
+		void increment(Kmer kmer, uint64_t h) {
+			size_t slot = find(kmer, h);
+			if (keys[slot] == EMPTY) {
+				keys[slot] = kmer;
+				if (++size * 2 > keys.size()) {
+					grow();
+					slot = find(kmer, h);
+				}
+			}
+			if (counts[slot] != std::numeric_limits<uint32_t>::max()) {
+				++counts[slot];
+			}
+		}
+
+		void grow() {
+			std::vector<Kmer> oldKeys(keys.size() * 2, EMPTY);
+			std::vector<uint32_t> oldCounts(counts.size() * 2, 0);
+			keys.swap(oldKeys);
+			counts.swap(oldCounts);
+			for (size_t i = 0; i < oldKeys.size(); ++i) {
+				if (oldKeys[i] != EMPTY) {
+					size_t slot = find(oldKeys[i], hash(oldKeys[i]));
+					keys[slot] = oldKeys[i];
+					counts[slot] = oldCounts[i];
+				}
+			}
+		}
+	};
+
+	// Collects the k-mers of a sequence by shard, so that each shard is
+	// locked once per batch of k-mers rather than once per k-mer
+	class KmerCounter::Adder {
+	public:
+		Adder(std::vector<Shard*>& shards)
+			: shards(shards), batches(shards.size()) {
+			for (size_t s = 0; s < batches.size(); ++s) {
+				batches[s].reserve(BATCH_SIZE);
+			}
+		}
+
+		~Adder() {
+			for (size_t s = 0; s < batches.size(); ++s) {
+				flush(s);
+			}
+		}
+
+		void operator()(size_t, Kmer kmer) {
+			size_t s = hash(kmer) >> (64 - SHARD_BITS);
+			batches[s].push_back(kmer);
+			if (batches[s].size() == BATCH_SIZE) {
+				flush(s);
+			}
+		}
+
+	private:
+		static const size_t BATCH_SIZE = 4096;
+
+		void flush(size_t s) {
+			Shard& shard = *shards[s];
+			util::thread::Lock lock(shard.mutex);
+			for (size_t i = 0; i < batches[s].size(); ++i) {
+				shard.increment(batches[s][i], hash(batches[s][i]));
+			}
+			batches[s].clear();
+		}
+
+		std::vector<Shard*>& shards;
+		std::vector< std::vector<Kmer> > batches;
+	};
+
+	KmerCounter::KmerCounter(size_t k, bool canonical, bool skipN)
+		: k(k), canonical(canonical), skipN(skipN),
+		  shards(size_t(1) << SHARD_BITS) {
+		if (k == 0 or k > MAX_K) {
+			throw std::runtime_error("k-mer size must be between 1 and " +
+									 util::string::toString(MAX_K));
+		}
+		for (size_t s = 0; s < shards.size(); ++s) {
+			shards[s] = new Shard;
+		}
+	}
+
+	KmerCounter::~KmerCounter() {
+		for (size_t s = 0; s < shards.size(); ++s) {
+			delete shards[s];
+		}
+	}
+
+	void KmerCounter::add(const std::string& seq) {
+		add(seq, 0, seq.size());
+	}
+
+	void KmerCounter::add(const std::string& seq, size_t start, size_t end) {
+		Adder adder(shards);
+		scan(seq, start, end, adder);
+	}
+
+	uint32_t KmerCounter::getCount(Kmer kmer) const {
+		uint64_t h = hash(kmer);
+		const Shard& shard = *shards[h >> (64 - SHARD_BITS)];
+		size_t slot = shard.find(kmer, h);
+		return (shard.keys[slot] == EMPTY ? 0 : shard.counts[slot]);
+	}
+
+	size_t KmerCounter::getNumDistinct() const {
+		size_t numDistinct = 0;
+		for (size_t s = 0; s < shards.size(); ++s) {
+			numDistinct += shards[s]->size;
+		}
+		return numDistinct;
+	}
+
+} }
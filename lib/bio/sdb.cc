@@ -75,6 +75,8 @@ namespace bio { namespace SDB {
 		seqSize = 0;
 		indexSize = 0;
 		recs.clear();
+		openRec = NULL;
+		unpairedBase.clear();
 	}
 
 	void DB::setCache(bool cache) {
@@ -179,6 +181,9 @@ namespace bio { namespace SDB {
 		
 		// Write the index and header information if we are in write mode
 		if (!readonly) {
+			if (openRec) {
+				endRec();
+			}
 			fseeko(strm, headerSize() + seqSize, SEEK_SET);
 			writeIndex();
 			fseeko(strm, 0, SEEK_SET);
@@ -470,33 +475,79 @@ namespace bio { namespace SDB {
 	void DB::putRec(const std::string& title,
 					const std::string& sequence,
 					const bool compressed) {
+		beginRec(title, compressed);
+		appendSeq(sequence);
+		endRec();
+	}
+
+	void DB::beginRec(const std::string& title,
+					  const bool compressed) {
 		if (!opened) {
 			throw std::runtime_error("Attempted to write to unopened database");
 		} else if (readonly) {
 			throw std::runtime_error("Attempted to write database opened for reading");
 		} else if (title.empty()) {
 			throw std::runtime_error("Attempted to write record with empty title");
+		} else if (openRec) {
+			throw std::runtime_error("Attempted to write record \"" + title
+									 + "\" before ending record \""
+									 + openRec->title + "\"");
 		}
 
-		// Seek to the end of the stored sequences
-		fseeko(strm, headerSize() + seqSize, SEEK_SET);
-
 		Record* rec = new Record(this);
 		rec->title = title;
-		rec->seqLength = sequence.length();
+		rec->seqLength = 0;
 		rec->seqPos = headerSize() + seqSize;
 		rec->compressed = (compressed ? 1 : 0);
 		recs.push_back(rec);
 		++numRecs;
-		if (compressed) {
-			std::string encoded = alphabet::Nucleotide::nibEncode(sequence);
+		indexSorted = false;
+		openRec = rec;
+		unpairedBase.clear();
+	}
+
+	void DB::appendSeq(const std::string& sequence) {
+		if (!openRec) {
+			throw std::runtime_error("Attempted to append sequence without an open record");
+		} else if (sequence.empty()) {
+			return;
+		}
+
+		// Seek to the end of the stored sequences
+		fseeko(strm, headerSize() + seqSize, SEEK_SET);
+
+		openRec->seqLength += sequence.length();
+		if (openRec->compressed) {
+			// Bases are packed in pairs, so hold back a trailing odd
+			// base until the next call or endRec
+			std::string pairs = unpairedBase + sequence;
+			unpairedBase.clear();
+			if (pairs.length() % 2) {
+				unpairedBase = pairs.substr(pairs.length() - 1);
+				pairs.erase(pairs.length() - 1);
+			}
+			std::string encoded = alphabet::Nucleotide::nibEncode(pairs);
 			util::io::binary::write(strm, encoded.data(), encoded.length());
 			seqSize += encoded.length();
 		} else {
 			util::io::binary::write(strm, sequence.data(), sequence.length());
 			seqSize += sequence.length();
 		}
-		indexSorted = false;
+	}
+
+	void DB::endRec() {
+		if (!openRec) {
+			throw std::runtime_error("Attempted to end record without an open record");
+		}
+
+		if (!unpairedBase.empty()) {
+			fseeko(strm, headerSize() + seqSize, SEEK_SET);
+			std::string encoded = alphabet::Nucleotide::nibEncode(unpairedBase);
+			util::io::binary::write(strm, encoded.data(), encoded.length());
+			seqSize += encoded.length();
+			unpairedBase.clear();
+		}
+		openRec = NULL;
 	}
 
 	// Implementation of Record
@@ -629,4 +680,38 @@ namespace bio { namespace SDB {
 		}
 	}
 	
+	// Implementation of SharedDB
+
+	void SharedDB::open(const filesystem::Path& filename, bool loadIndex) {
+		db.open(filename);
+		if (loadIndex) {
+			db.readIndex();
+		}
+	}
+
+	std::string SharedDB::getSeq(const std::string& title,
+								 const unsigned int start,
+								 const unsigned int end,
+								 const char strand,
+								 const alphabet::Nucleotide& alphabet) {
+		std::string seq;
+		{
+			util::thread::Lock lock(mutex);
+			seq = db.getSeq(title, start, end);
+		}
+		if (strand == '-') {
+			alphabet.reverseComplementInPlace(seq);
+		}
+		return seq;
+	}
+
+	std::string SharedDB::getSeq(const genome::Interval& i,
+								 const alphabet::Nucleotide& alphabet) {
+		return getSeq(i.getChrom(),
+					  i.getStart(),
+					  i.getEnd(),
+					  i.getStrand(),
+					  alphabet);
+	}
+
 } }
@@ -0,0 +1,175 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <stdexcept>
+#include <algorithm>
+
+#include "bio/translation/OrfScanner.hh"
+#include "bio/alphabet/AmbiguousNucleotide.hh"
+#include "util/string.hh"
+using util::string::toString;
+
+namespace bio { namespace translation {
+
+	OrfScanner::OrfScanner(size_t tableNum)
+		: table(Table::getTable(tableNum)) {
+		if (table == NULL) {
+			throw std::runtime_error("No translation table numbered " +
+									 toString(tableNum));
+		}
+		init();
+	}
+
+	OrfScanner::OrfScanner(const Table* table) : table(table) {
+		init();
+	}
+
+	void OrfScanner::init() {
+		static const char BASES[] = "ACGT";
+		for (int code = 0; code < 64; ++code) {
+			codons[code] = table->translate(BASES[code >> 4],
+											BASES[(code >> 2) & 3],
+											BASES[code & 3]);
+			breaksOrf[code] = (codons[code] == '*' or codons[code] == 'X');
+		}
+	}
+
+	std::string OrfScanner::translate(const std::string& seq,
+									  const unsigned int phase,
+									  const bool toStop) const {
+		size_t proteinSize = (seq.size() < phase ?
+							  0 : (seq.size() - phase) / 3);
+		std::string protein(proteinSize, '?');
+		for (size_t i = 0; i < proteinSize; ++i) {
+			size_t start = i * 3 + phase;
+			int b1 = encode(seq[start]);
+			int b2 = encode(seq[start + 1]);
+			int b3 = encode(seq[start + 2]);
+			char aa = (b1 < 0 or b2 < 0 or b3 < 0) ?
+				table->translate(seq[start], seq[start + 1], seq[start + 2]) :
+				codons[(b1 << 4) | (b2 << 2) | b3];
+			if (toStop and aa == '*') {
+				protein.resize(i);
+				break;
+			} else {
+				protein[i] = aa;
+			}
+		}
+		return protein;
+	}
+
+	void OrfScanner::findOrfs(const std::string& seq,
+							  size_t minLength,
+							  OrfList& orfs) const {
+		orfs.clear();
+		const size_t n = seq.size();
+		if (n < 3) {
+			return;
+		}
+		const alphabet::Nucleotide& dna = alphabet::AmbiguousDNA;
+
+		// ORFs on each strand of the codons starting at positions of
+		// each residue mod 3, and the start of the current run of codons
+		// that do not break an ORF, or NONE
+		const size_t NONE = static_cast<size_t>(-1);
+		OrfList found[2][3];
+		size_t runStart[2][3] = { { NONE, NONE, NONE }, { NONE, NONE, NONE } };
+
+		// Codes of the last three bases and of their reverse complement,
+		// and the number of the last three bases that are A, C, G or T
+		int code = 0, rcCode = 0;
+		size_t numValid = 0;
+		for (size_t i = 0; i < n; ++i) {
+			int base = encode(seq[i]);
+			if (base < 0) {
+				numValid = 0;
+				base = 0;
+			} else {
+				++numValid;
+			}
+			code = ((code << 2) | base) & 63;
+			rcCode = (rcCode >> 2) | ((3 - base) << 4);
+			if (i < 2) {
+				continue;
+			}
+
+			// The codon occupies [start, i]
+			size_t start = i - 2;
+			size_t frame = start % 3;
+			bool breaks[2];
+			if (numValid >= 3) {
+				breaks[0] = breaksOrf[code];
+				breaks[1] = breaksOrf[rcCode];
+			} else {
+				char aa = table->translate(seq[start], seq[start + 1], seq[i]);
+				breaks[0] = (aa == '*' or aa == 'X');
+				aa = table->translate(dna.complement(seq[i]),
+									  dna.complement(seq[start + 1]),
+									  dna.complement(seq[start]));
+				breaks[1] = (aa == '*' or aa == 'X');
+			}
+
+			for (size_t strand = 0; strand < 2; ++strand) {
+				size_t& run = runStart[strand][frame];
+				if (breaks[strand]) {
+					if (run != NONE) {
+						if (start - run >= minLength) {
+							Orf orf = { run, start, strand == 0 ? '+' : '-' };
+							found[strand][frame].push_back(orf);
+						}
+						run = NONE;
+					}
+				} else if (run == NONE) {
+					run = start;
+				}
+			}
+		}
+
+		// Close the runs at the end of the last codon of each frame
+		for (size_t frame = 0; frame < 3; ++frame) {
+			if (frame + 3 > n) {
+				continue;
+			}
+			size_t end = frame + (n - frame) / 3 * 3;
+			for (size_t strand = 0; strand < 2; ++strand) {
+				size_t run = runStart[strand][frame];
+				if (run != NONE and end - run >= minLength) {
+					Orf orf = { run, end, strand == 0 ? '+' : '-' };
+					found[strand][frame].push_back(orf);
+				}
+			}
+		}
+
+		// Forward frames start at the first base and reverse frames at
+		// the last, so reverse frame p holds the codons starting at
+		// positions congruent to n - 3 - p mod 3
+		for (size_t phase = 0; phase < 3; ++phase) {
+			orfs.insert(orfs.end(), found[0][phase].begin(),
+						found[0][phase].end());
+		}
+		for (size_t phase = 0; phase < 3; ++phase) {
+			if (phase + 3 > n) {
+				continue;
+			}
+			const OrfList& reverse = found[1][(n - 3 - phase) % 3];
+			orfs.insert(orfs.end(), reverse.rbegin(), reverse.rend());
+		}
+	}
+
+} }
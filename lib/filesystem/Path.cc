@@ -116,8 +116,9 @@ namespace filesystem {
 		}
 	}
 	
-	void Path::openForOutput(std::ofstream& strm) const {
-		strm.open(s.c_str());
+	void Path::openForOutput(std::ofstream& strm,
+							 std::ios::openmode mode) const {
+		strm.open(s.c_str(), mode | std::ios::out);
 		if (not strm) {
 			throw std::runtime_error("Could not open output file: " + s);
 		}
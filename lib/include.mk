@@ -11,10 +11,20 @@ _PYTHON_LIBS := $(wildcard $(DIR)/*.py)
 
 _CND_SRCS := $(_BIO_SRCS) $(_UTIL_SRCS) $(_FILESYSTEM_SRCS) $(_MATH_SRCS)
 
+# Sources used by only one of the polytope backends
+_NATIVE_POLYTOPE_SRCS := $(DIR)/polytope/Hull.cc
+_POLYMAKE_POLYTOPE_SRCS := $(DIR)/polytope/newton.cc
+
+ifeq ($(POLYTOPE_BACKEND),polymake)
 ifdef POLYMAKE_PATH
-_CND_SRCS += $(_POLYTOPE_SRCS)
-$(_POLYTOPE_SRCS:.cc=$(O)): USE_POLYMAKE = 1
-$(_POLYTOPE_SRCS:.cc=$(D)): USE_POLYMAKE = 1
+_BUILT_POLYTOPE_SRCS := $(filter-out $(_NATIVE_POLYTOPE_SRCS), \
+                          $(_POLYTOPE_SRCS))
+_CND_SRCS += $(_BUILT_POLYTOPE_SRCS)
+$(_BUILT_POLYTOPE_SRCS:.cc=$(O)): USE_POLYMAKE = 1
+$(_BUILT_POLYTOPE_SRCS:.cc=$(D)): USE_POLYMAKE = 1
+endif
+else
+_CND_SRCS += $(filter-out $(_POLYMAKE_POLYTOPE_SRCS), $(_POLYTOPE_SRCS))
 endif
 
 $(DIR)/libcnd$(A): $(_CND_SRCS:.cc=$(O))
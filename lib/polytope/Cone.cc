@@ -17,10 +17,16 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <stdexcept>
+
 #include "polytope/Cone.hh"
+#ifdef POLYTOPE_NATIVE
+#include "polytope/Hull.hh"
+#endif
 
 namespace polytope {
 
+#ifndef POLYTOPE_NATIVE
 	polymake::polytope::cdd_interface::solver<Rational> Cone::CDDSolver;
 
 	Cone::Ray Cone::ratToInt(const Vector<Rational>& ratRay) {
@@ -45,13 +51,19 @@ namespace polytope {
 
 		return intRay;
 	}
+#endif
 	
 	Cone::Cone(const RayList& rays)
 		: rays(rays),
 		  facets(),
 		  reduced(false) {
 		computeFacets();
+#ifdef POLYTOPE_NATIVE
+		// The facets and the extreme rays are found together
+		reduced = true;
+#else
 		this->rays.clear();
+#endif
 	}
 	
 	void Cone::addInequality(const Inequality& i) {
@@ -86,6 +98,40 @@ namespace polytope {
 		reduced = true;
 	}
 		
+#ifdef POLYTOPE_NATIVE
+	// The rays of the cone are the facets of the cone generated by its
+	// inequalities, provided that the inequalities have full rank, so
+	// that the cone has no lineality space.  Coordinate 0, which is zero
+	// in all rays and facets, is left out of the rank.
+	void Cone::computeRays() {
+		rays.clear();
+
+		if (facets.empty()) { return; }
+
+		Hull hull(facets);
+		if (hull.getDim() < facets.front().size() - 1) {
+			throw std::runtime_error("Cone is not pointed");
+		}
+		rays = hull.getFacets();
+	}
+
+	void Cone::computeFacets() {
+		facets.clear();
+
+		if (rays.empty()) { return; }
+
+		Hull hull(rays);
+		facets = hull.getFacets();
+
+		RayList extremeRays;
+		for (size_t i = 0; i < rays.size(); ++i) {
+			if (hull.isExtreme(i)) {
+				extremeRays.push_back(rays[i]);
+			}
+		}
+		rays.swap(extremeRays);
+	}
+#else
 	void Cone::computeRays() {
 		rays.clear();
 		
@@ -139,5 +185,6 @@ namespace polytope {
 			facets.push_back(ratToInt(ratFacet));
 		}
 	}
+#endif
 
 }
@@ -0,0 +1,551 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "polytope/Hull.hh"
+
+namespace polytope {
+
+	// Thrown when a machine integer result would overflow
+	struct Overflow {};
+
+	// A long whose arithmetic throws Overflow rather than wrapping
+	class CheckedLong {
+	public:
+		CheckedLong(long value = 0) : value(value) {}
+
+		long get() const { return value; }
+
+		CheckedLong operator-() const {
+			if (value == LONG_MIN) { throw Overflow(); }
+			return -value;
+		}
+
+		CheckedLong operator+(CheckedLong x) const {
+			if ((x.value > 0 and value > LONG_MAX - x.value) or
+				(x.value < 0 and value < LONG_MIN - x.value)) {
+				throw Overflow();
+			}
+			return value + x.value;
+		}
+
+		CheckedLong operator-(CheckedLong x) const {
+			if ((x.value < 0 and value > LONG_MAX + x.value) or
+				(x.value > 0 and value < LONG_MIN + x.value)) {
+				throw Overflow();
+			}
+			return value - x.value;
+		}
+
+		CheckedLong operator*(CheckedLong x) const {
+			// Products of numbers below the square root of the largest
+			// long are safe, which covers nearly all of them
+			if (-SMALL < value and value < SMALL and
+				-SMALL < x.value and x.value < SMALL) {
+				return value * x.value;
+			}
+			if (value == 0 or x.value == 0) { return 0; }
+			if (value == LONG_MIN or x.value == LONG_MIN or
+				std::labs(x.value) > LONG_MAX / std::labs(value)) {
+				throw Overflow();
+			}
+			return value * x.value;
+		}
+
+		CheckedLong operator/(CheckedLong x) const {
+			if (value == LONG_MIN and x.value == -1) { throw Overflow(); }
+			return value / x.value;
+		}
+
+		CheckedLong& operator+=(CheckedLong x) { return *this = *this + x; }
+		CheckedLong& operator-=(CheckedLong x) { return *this = *this - x; }
+		CheckedLong& operator*=(CheckedLong x) { return *this = *this * x; }
+		CheckedLong& operator/=(CheckedLong x) { return *this = *this / x; }
+
+		bool operator==(CheckedLong x) const { return value == x.value; }
+		bool operator!=(CheckedLong x) const { return value != x.value; }
+		bool operator<(CheckedLong x) const { return value < x.value; }
+		bool operator>(CheckedLong x) const { return value > x.value; }
+
+	private:
+		static const long SMALL = 1L << (sizeof(long) * CHAR_BIT / 2 - 1);
+
+		long value;
+	};
+
+	inline int sgn(CheckedLong x) {
+		return x.get() > 0 ? 1 : (x.get() < 0 ? -1 : 0);
+	}
+
+	inline CheckedLong abs(CheckedLong x) { return x < 0 ? -x : x; }
+
+	inline CheckedLong gcd(CheckedLong a, CheckedLong b) {
+		long x = abs(a).get(), y = abs(b).get();
+		while (y != 0) {
+			long r = x % y;
+			x = y;
+			y = r;
+		}
+		return x;
+	}
+
+	inline void convert(const Integer& from, Integer& to) { to = from; }
+
+	inline void convert(const Integer& from, CheckedLong& to) {
+		if (not from.fits_slong_p()) { throw Overflow(); }
+		to = from.get_si();
+	}
+
+	inline void convert(const CheckedLong& from, Integer& to) {
+		to = from.get();
+	}
+
+	// The double description computation of Hull, on integers of type
+	// Number
+	template<typename Number>
+	class DoubleDescription {
+	public:
+		typedef std::vector<Number> Point;
+		typedef std::vector<size_t> IndexList;
+
+		explicit DoubleDescription(const Hull::VectorList& generators);
+
+		std::vector<size_t> spanCoords;
+		// Extreme rays of the dual cone, in the coordinates of the span
+		std::vector<Point> facets;
+		std::vector<bool> extreme;
+
+	private:
+		typedef std::vector<unsigned long> BitSet;
+
+		struct Ray {
+			Point coords;
+			// Generators on which the ray is zero
+			BitSet zeros;
+		};
+
+		static Number dot(const Point& a, const Point& b);
+		static bool isZero(const Point& p);
+		static void makePrimitive(Point& p);
+		static void eliminate(Point& v, const Point& row, size_t col);
+		static size_t rank(std::vector<Point>& rows);
+		static Point nullVector(std::vector<Point>& rows, size_t cols);
+
+		void findSpan(const Hull::VectorList& generators, IndexList& basis);
+		void initRays(const IndexList& basis);
+		void addGenerator(size_t i);
+		bool isAdjacent(size_t r1, size_t r2, BitSet& common) const;
+		void findExtreme();
+
+		void setBit(BitSet& bits, size_t i) const;
+		bool testBit(const BitSet& bits, size_t i) const;
+
+		static const size_t BITS = sizeof(unsigned long) * CHAR_BIT;
+
+		size_t ambientDim;
+		size_t numWords;
+		std::vector<Point> points;
+		std::vector<Ray> rays;
+	};
+
+	template<typename Number>
+	DoubleDescription<Number>::DoubleDescription(const Hull::VectorList&
+												 generators)
+		: spanCoords(),
+		  facets(),
+		  extreme(generators.size(), false),
+		  ambientDim(generators.empty() ? 0 : generators.front().size()),
+		  numWords((generators.size() + BITS - 1) / BITS),
+		  points(),
+		  rays() {
+		IndexList basis;
+		findSpan(generators, basis);
+		initRays(basis);
+
+		std::vector<bool> inBasis(points.size(), false);
+		for (size_t j = 0; j < basis.size(); ++j) {
+			inBasis[basis[j]] = true;
+		}
+		for (size_t i = 0; i < points.size(); ++i) {
+			if (not inBasis[i]) {
+				addGenerator(i);
+			}
+		}
+
+		findExtreme();
+
+		facets.resize(rays.size());
+		for (size_t r = 0; r < rays.size(); ++r) {
+			facets[r].swap(rays[r].coords);
+		}
+	}
+
+	template<typename Number>
+	inline void DoubleDescription<Number>::setBit(BitSet& bits,
+												  size_t i) const {
+		bits[i / BITS] |= 1UL << (i % BITS);
+	}
+
+	template<typename Number>
+	inline bool DoubleDescription<Number>::testBit(const BitSet& bits,
+												   size_t i) const {
+		return (bits[i / BITS] >> (i % BITS)) & 1UL;
+	}
+
+	static size_t countBits(unsigned long word) {
+		size_t count = 0;
+		for (; word != 0; word &= word - 1) {
+			++count;
+		}
+		return count;
+	}
+
+	template<typename Number>
+	Number DoubleDescription<Number>::dot(const Point& a, const Point& b) {
+		Number sum = 0;
+		for (size_t i = 0; i < a.size(); ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+	template<typename Number>
+	bool DoubleDescription<Number>::isZero(const Point& p) {
+		for (size_t i = 0; i < p.size(); ++i) {
+			if (p[i] != 0) { return false; }
+		}
+		return true;
+	}
+
+	template<typename Number>
+	void DoubleDescription<Number>::makePrimitive(Point& p) {
+		Number divisor = 0;
+		for (size_t i = 0; i < p.size(); ++i) {
+			divisor = gcd(divisor, p[i]);
+		}
+		if (divisor > 1) {
+			for (size_t i = 0; i < p.size(); ++i) {
+				p[i] /= divisor;
+			}
+		}
+	}
+
+	// Clears coordinate col of v by subtracting a multiple of row, without
+	// leaving the integers
+	template<typename Number>
+	void DoubleDescription<Number>::eliminate(Point& v, const Point& row,
+											  size_t col) {
+		if (v[col] == 0) { return; }
+		Number a = row[col], b = v[col];
+		for (size_t c = 0; c < v.size(); ++c) {
+			v[c] = a * v[c] - b * row[c];
+		}
+		makePrimitive(v);
+	}
+
+	template<typename Number>
+	size_t DoubleDescription<Number>::rank(std::vector<Point>& rows) {
+		size_t r = 0;
+		size_t cols = rows.empty() ? 0 : rows.front().size();
+		for (size_t c = 0; c < cols and r < rows.size(); ++c) {
+			size_t pivot = r;
+			while (pivot < rows.size() and rows[pivot][c] == 0) {
+				++pivot;
+			}
+			if (pivot == rows.size()) { continue; }
+			rows[pivot].swap(rows[r]);
+			for (size_t i = r + 1; i < rows.size(); ++i) {
+				eliminate(rows[i], rows[r], c);
+			}
+			++r;
+		}
+		return r;
+	}
+
+	// A nonzero vector orthogonal to rows, which must have rank one less
+	// than the number of columns
+	template<typename Number>
+	typename DoubleDescription<Number>::Point
+	DoubleDescription<Number>::nullVector(std::vector<Point>& rows,
+										  size_t cols) {
+		// Reduce rows so that each is zero at the pivots of the others,
+		// leaving one column free
+		std::vector<size_t> pivots;
+		size_t r = 0;
+		for (size_t c = 0; c < cols and r < rows.size(); ++c) {
+			size_t pivot = r;
+			while (pivot < rows.size() and rows[pivot][c] == 0) {
+				++pivot;
+			}
+			if (pivot == rows.size()) { continue; }
+			rows[pivot].swap(rows[r]);
+			for (size_t i = 0; i < rows.size(); ++i) {
+				if (i != r) {
+					eliminate(rows[i], rows[r], c);
+				}
+			}
+			pivots.push_back(c);
+			++r;
+		}
+		size_t free = 0;
+		while (free < pivots.size() and pivots[free] == free) {
+			++free;
+		}
+
+		// Row i now reads a x[pivot] + b x[free] = 0
+		Number scale = 1;
+		for (size_t i = 0; i < pivots.size(); ++i) {
+			Number a = abs(rows[i][pivots[i]]);
+			scale = scale / gcd(scale, a) * a;
+		}
+		Point v(cols);
+		v[free] = scale;
+		for (size_t i = 0; i < pivots.size(); ++i) {
+			v[pivots[i]] = -(rows[i][free] * (scale / rows[i][pivots[i]]));
+		}
+		makePrimitive(v);
+		return v;
+	}
+
+	// Chooses generators that form a basis of the span, along with one
+	// coordinate per basis vector such that projecting onto the chosen
+	// coordinates is one-to-one on the span, and projects the generators
+	template<typename Number>
+	void DoubleDescription<Number>::findSpan(const Hull::VectorList&
+											 generators,
+											 IndexList& basis) {
+		std::vector<Point> converted(generators.size(), Point(ambientDim));
+		for (size_t i = 0; i < generators.size(); ++i) {
+			for (size_t c = 0; c < ambientDim; ++c) {
+				convert(generators[i][c], converted[i][c]);
+			}
+		}
+
+		std::vector<Point> echelon;
+		std::vector<size_t> pivots;
+		for (size_t i = 0; i < converted.size() and
+				 echelon.size() < ambientDim; ++i) {
+			Point v = converted[i];
+			for (size_t j = 0; j < echelon.size(); ++j) {
+				eliminate(v, echelon[j], pivots[j]);
+			}
+			size_t c = 0;
+			while (c < ambientDim and v[c] == 0) {
+				++c;
+			}
+			if (c < ambientDim) {
+				echelon.push_back(v);
+				pivots.push_back(c);
+				basis.push_back(i);
+			}
+		}
+
+		spanCoords = pivots;
+		std::sort(spanCoords.begin(), spanCoords.end());
+
+		points.resize(converted.size(), Point(spanCoords.size()));
+		for (size_t i = 0; i < converted.size(); ++i) {
+			for (size_t c = 0; c < spanCoords.size(); ++c) {
+				points[i][c] = converted[i][spanCoords[c]];
+			}
+		}
+	}
+
+	// The cone defined by the basis generators is simplicial: each of its
+	// extreme rays is zero on all basis generators but one
+	template<typename Number>
+	void DoubleDescription<Number>::initRays(const IndexList& basis) {
+		size_t k = basis.size();
+		rays.resize(k);
+		for (size_t j = 0; j < k; ++j) {
+			std::vector<Point> others;
+			for (size_t i = 0; i < k; ++i) {
+				if (i != j) {
+					others.push_back(points[basis[i]]);
+				}
+			}
+			Ray& ray = rays[j];
+			ray.coords = nullVector(others, k);
+			if (dot(ray.coords, points[basis[j]]) < 0) {
+				for (size_t c = 0; c < k; ++c) {
+					ray.coords[c] = -ray.coords[c];
+				}
+			}
+			ray.zeros.resize(numWords);
+			for (size_t i = 0; i < k; ++i) {
+				if (i != j) {
+					setBit(ray.zeros, basis[i]);
+				}
+			}
+		}
+	}
+
+	// Whether rays r1 and r2 span a face of the cone, by the
+	// combinatorial test: no third ray is zero on all the generators
+	// that both are zero on.  The generators are stored in common.
+	template<typename Number>
+	bool DoubleDescription<Number>::isAdjacent(size_t r1, size_t r2,
+											   BitSet& common) const {
+		size_t numCommon = 0;
+		for (size_t w = 0; w < numWords; ++w) {
+			common[w] = rays[r1].zeros[w] & rays[r2].zeros[w];
+			numCommon += countBits(common[w]);
+		}
+		if (numCommon + 2 < spanCoords.size()) {
+			return false;
+		}
+		for (size_t r = 0; r < rays.size(); ++r) {
+			if (r == r1 or r == r2) { continue; }
+			const BitSet& zeros = rays[r].zeros;
+			size_t w = 0;
+			while (w < numWords and (zeros[w] & common[w]) == common[w]) {
+				++w;
+			}
+			if (w == numWords) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename Number>
+	void DoubleDescription<Number>::addGenerator(size_t i) {
+		const Point& g = points[i];
+		if (isZero(g)) { return; }
+
+		std::vector<Number> values(rays.size());
+		IndexList positive, negative;
+		for (size_t r = 0; r < rays.size(); ++r) {
+			values[r] = dot(rays[r].coords, g);
+			int s = sgn(values[r]);
+			if (s > 0) {
+				positive.push_back(r);
+			} else if (s < 0) {
+				negative.push_back(r);
+			} else {
+				// Record the generator on the rays it lies on
+				setBit(rays[r].zeros, i);
+			}
+		}
+
+		// A generator strictly inside every facet is redundant and
+		// changes nothing
+		if (negative.empty()) { return; }
+
+		// Replace the rays on the wrong side of the generator by the
+		// intersections of the generator's hyperplane with the faces
+		// between them and the rays on the right side
+		std::vector<Ray> newRays;
+		BitSet common(numWords);
+		for (size_t p = 0; p < positive.size(); ++p) {
+			for (size_t n = 0; n < negative.size(); ++n) {
+				size_t rp = positive[p], rn = negative[n];
+				if (not isAdjacent(rp, rn, common)) { continue; }
+				newRays.push_back(Ray());
+				Ray& ray = newRays.back();
+				ray.coords.resize(g.size());
+				for (size_t c = 0; c < g.size(); ++c) {
+					ray.coords[c] = (values[rp] * rays[rn].coords[c] -
+									 values[rn] * rays[rp].coords[c]);
+				}
+				if (isZero(ray.coords)) {
+					newRays.pop_back();
+					continue;
+				}
+				makePrimitive(ray.coords);
+				ray.zeros = common;
+				setBit(ray.zeros, i);
+			}
+		}
+
+		// Move the kept rays down over the removed ones
+		size_t numKept = 0;
+		for (size_t r = 0; r < rays.size(); ++r) {
+			if (sgn(values[r]) >= 0) {
+				if (numKept != r) {
+					rays[numKept].coords.swap(rays[r].coords);
+					rays[numKept].zeros.swap(rays[r].zeros);
+				}
+				++numKept;
+			}
+		}
+		rays.resize(numKept + newRays.size());
+		for (size_t r = 0; r < newRays.size(); ++r) {
+			rays[numKept + r].coords.swap(newRays[r].coords);
+			rays[numKept + r].zeros.swap(newRays[r].zeros);
+		}
+	}
+
+	// A generator spans an extreme ray if the facets through it meet in
+	// a line, that is, if their normals have rank one less than the
+	// dimension
+	template<typename Number>
+	void DoubleDescription<Number>::findExtreme() {
+		size_t k = spanCoords.size();
+		if (k == 0) { return; }
+
+		std::vector<IndexList> raysThruPoint(points.size());
+		for (size_t r = 0; r < rays.size(); ++r) {
+			for (size_t i = 0; i < points.size(); ++i) {
+				if (testBit(rays[r].zeros, i)) {
+					raysThruPoint[i].push_back(r);
+				}
+			}
+		}
+
+		std::vector<Point> normals;
+		for (size_t i = 0; i < points.size(); ++i) {
+			if (isZero(points[i]) or raysThruPoint[i].size() + 1 < k) {
+				continue;
+			}
+			normals.clear();
+			for (size_t j = 0; j < raysThruPoint[i].size(); ++j) {
+				normals.push_back(rays[raysThruPoint[i][j]].coords);
+			}
+			extreme[i] = (rank(normals) + 1 >= k);
+		}
+	}
+
+	Hull::Hull(const VectorList& generators) {
+		try {
+			compute<CheckedLong>(generators);
+		} catch (const Overflow&) {
+			compute<Integer>(generators);
+		}
+	}
+
+	template<typename Number>
+	void Hull::compute(const VectorList& generators) {
+		DoubleDescription<Number> dd(generators);
+
+		size_t ambientDim = generators.empty() ? 0 : generators.front().size();
+		spanCoords = dd.spanCoords;
+		extreme = dd.extreme;
+		facets.assign(dd.facets.size(), IntegerVector(ambientDim));
+		for (size_t j = 0; j < dd.facets.size(); ++j) {
+			for (size_t c = 0; c < spanCoords.size(); ++c) {
+				convert(dd.facets[j][c], facets[j][spanCoords[c]]);
+			}
+		}
+	}
+
+}
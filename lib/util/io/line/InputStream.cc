@@ -26,11 +26,14 @@ namespace util { namespace io { namespace line {
 
 	InputStream::InputStream(std::istream& strm, const size_t bufferSize)
 		: strm(strm),
+		  bufferSize(bufferSize),
 		  buffer(bufferSize),
 		  pos(buffer.end()),
+		  bufferOffset(0),
 		  atEnd(false) {
 		// Fill buffer and initialize position to start
 		fillBuffer();
+		bufferOffset = 0;
 		pos = buffer.begin();
 
 		// Mark stream as processed if input stream was empty
@@ -47,8 +50,23 @@ namespace util { namespace io { namespace line {
 		return atEnd;
 	}
 	
+	std::streamoff InputStream::tell() const {
+		return bufferOffset + (pos - buffer.begin());
+	}
+
+	void InputStream::seek(std::streampos p) {
+		strm.clear();
+		strm.seekg(p);
+		buffer.resize(bufferSize);
+		fillBuffer();
+		bufferOffset = p;
+		pos = buffer.begin();
+		atEnd = (pos == buffer.end());
+	}
+	
 	void InputStream::fillBuffer() {
-		// Fill buffer
+		// Fill buffer, keeping track of the offset of its start
+		bufferOffset += buffer.size();
 		strm.read(&buffer[0], buffer.size());
 
 		// If buffer is not completely filled, resize to fit
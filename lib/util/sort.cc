@@ -0,0 +1,51 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+#include "util/sort.hh"
+
+namespace util { namespace sort {
+
+	TempFile::TempFile(const std::string& dir) {
+		std::string tempDir = dir;
+		if (tempDir.empty()) {
+			const char* env = std::getenv("TMPDIR");
+			tempDir = (env != NULL and *env != '\0') ? env : "/tmp";
+		}
+		std::string pattern = tempDir + "/cndsort.XXXXXX";
+		std::vector<char> name(pattern.begin(), pattern.end());
+		name.push_back('\0');
+		int fd = mkstemp(&name[0]);
+		if (fd == -1) {
+			throw std::runtime_error("Could not create temporary file in "
+									 + tempDir);
+		}
+		close(fd);
+		path = &name[0];
+	}
+
+	TempFile::~TempFile() {
+		unlink(path.c_str());
+	}
+
+} }
@@ -17,6 +17,8 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cstring>
+
 #include "util/string.hh"
 
 namespace util {
@@ -41,6 +43,31 @@ namespace util {
 			return *pos;
 		}
 	
+		size_t splitSpans(const char* begin,
+						  const char* end,
+						  char sep,
+						  Span* spans,
+						  size_t maxSpans) {
+			if (maxSpans == 0) {
+				return 0;
+			}
+			size_t n = 0;
+			while (n + 1 < maxSpans) {
+				const char* pos = static_cast<const char*>
+					(std::memchr(begin, sep, end - begin));
+				if (pos == NULL) {
+					break;
+				}
+				spans[n].begin = begin;
+				spans[n].end = pos;
+				++n;
+				begin = pos + 1;
+			}
+			spans[n].begin = begin;
+			spans[n].end = end;
+			return n + 1;
+		}
+
 		std::string capitalize(const std::string& s) {
 			std::string cs(s);
 			cs[0] = std::toupper(cs[0]);
@@ -160,7 +187,7 @@ namespace util {
 			std::string::size_type end = s.find_first_of(whitespaceChars, start);
 			return (end == std::string::npos ?
 					s.substr(start) :
-					s.substr(start, end));
+					s.substr(start, end - start));
 		}
 	
 		bool startsWith(const std::string& str,
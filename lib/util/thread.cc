@@ -0,0 +1,159 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <stdexcept>
+#include <unistd.h>
+
+#include "util/thread.hh"
+
+namespace util { namespace thread {
+
+	size_t numProcessors() {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		return n > 0 ? static_cast<size_t>(n) : 1;
+	}
+
+	Mutex::Mutex() {
+		pthread_mutex_init(&mutex, NULL);
+	}
+
+	Mutex::~Mutex() {
+		pthread_mutex_destroy(&mutex);
+	}
+
+	void Mutex::lock() {
+		pthread_mutex_lock(&mutex);
+	}
+
+	void Mutex::unlock() {
+		pthread_mutex_unlock(&mutex);
+	}
+
+	Condition::Condition() {
+		pthread_cond_init(&cond, NULL);
+	}
+
+	Condition::~Condition() {
+		pthread_cond_destroy(&cond);
+	}
+
+	void Condition::wait(Mutex& m) {
+		pthread_cond_wait(&cond, &m.mutex);
+	}
+
+	void Condition::signal() {
+		pthread_cond_signal(&cond);
+	}
+
+	void Condition::broadcast() {
+		pthread_cond_broadcast(&cond);
+	}
+
+	ThreadPool::ThreadPool(size_t numThreads)
+		: threads(), tasks(), numPending(0), stopping(false), error() {
+		if (numThreads == 0) {
+			numThreads = numProcessors();
+		}
+		threads.reserve(numThreads);
+		for (size_t i = 0; i < numThreads; ++i) {
+			pthread_t t;
+			if (pthread_create(&t, NULL, &ThreadPool::start, this) != 0) {
+				break;
+			}
+			threads.push_back(t);
+		}
+		if (threads.empty()) {
+			throw std::runtime_error("Could not create any worker threads");
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			Lock lock(m);
+			stopping = true;
+			taskAvailable.broadcast();
+		}
+		for (size_t i = 0; i < threads.size(); ++i) {
+			pthread_join(threads[i], NULL);
+		}
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			delete tasks[i];
+		}
+	}
+
+	void ThreadPool::add(Task* task) {
+		Lock lock(m);
+		tasks.push_back(task);
+		++numPending;
+		taskAvailable.signal();
+	}
+
+	void ThreadPool::wait() {
+		Lock lock(m);
+		while (numPending > 0) {
+			allDone.wait(m);
+		}
+		if (not error.empty()) {
+			std::string msg;
+			msg.swap(error);
+			throw std::runtime_error(msg);
+		}
+	}
+
+	void* ThreadPool::start(void* pool) {
+		static_cast<ThreadPool*>(pool)->work();
+		return NULL;
+	}
+
+	void ThreadPool::work() {
+		for (;;) {
+			Task* task;
+			{
+				Lock lock(m);
+				while (tasks.empty() and not stopping) {
+					taskAvailable.wait(m);
+				}
+				if (tasks.empty()) {
+					return;
+				}
+				task = tasks.front();
+				tasks.pop_front();
+			}
+
+			std::string taskError;
+			try {
+				task->run();
+			} catch (const std::exception& e) {
+				taskError = e.what();
+			} catch (...) {
+				taskError = "Unknown error in worker thread";
+			}
+			delete task;
+
+			Lock lock(m);
+			if (not taskError.empty() and error.empty()) {
+				error = taskError;
+			}
+			if (--numPending == 0) {
+				allDone.broadcast();
+			}
+		}
+	}
+
+} }
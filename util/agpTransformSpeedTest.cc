@@ -0,0 +1,169 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boost/random/mersenne_twister.hpp"
+#include "boost/random/uniform_int.hpp"
+#include "boost/random/variate_generator.hpp"
+#include "boost/timer.hpp"
+
+#include "bio/agp/AGPForwardMapper.hh"
+#include "bio/agp/AGPBackwardMapper.hh"
+#include "bio/genome/BasicInterval.hh"
+#include "util/options.hh"
+#include "util/string.hh"
+using util::string::toString;
+using bio::genome::BasicInterval;
+
+typedef boost::mt19937 base_generator_type;
+typedef boost::uniform_int<long> distribution_type;
+typedef boost::variate_generator<base_generator_type&,
+								 distribution_type> variate_generator_type;
+
+const std::string USAGE = "";
+
+const std::string DESCRIPTION =
+	"Times the transformation of random intervals through a synthetic "
+	"draft assembly AGP, forwards (contigs to scaffolds) and backwards";
+
+int main(int argc, const char* argv[]) {
+	// Increase speed of input/output to standard streams
+	std::ios::sync_with_stdio(false);
+
+	// Initialize options to defaults
+	size_t numScaffolds = 1000;
+	size_t contigsPerScaffold = 1000;
+	size_t contigLength = 5000;
+	size_t gapLength = 100;
+	size_t numIntervals = 1000000;
+	size_t intervalLength = 200;
+	base_generator_type::result_type seed = 1;
+
+	util::options::Parser parser(USAGE, DESCRIPTION);
+	parser.addStoreOpt(0, "scaffolds", "number of scaffolds", numScaffolds);
+	parser.addStoreOpt(0, "contigs", "number of contigs per scaffold",
+					   contigsPerScaffold);
+	parser.addStoreOpt(0, "contig-length", "length of each contig",
+					   contigLength);
+	parser.addStoreOpt(0, "intervals", "number of intervals to transform",
+					   numIntervals);
+	parser.addStoreOpt(0, "interval-length", "maximum interval length",
+					   intervalLength);
+	parser.addStoreOpt('s', "seed", "Seed for random number generator",
+					   seed, "INTEGER");
+	parser.parse(argv, argv + argc);
+
+	try {
+		// Build draft assembly: scaffolds of fixed-length contigs
+		// separated by gaps, every other contig reversed
+		std::ostringstream agp;
+		for (size_t s = 0; s < numScaffolds; ++s) {
+			size_t pos = 1;
+			size_t partNum = 1;
+			for (size_t c = 0; c < contigsPerScaffold; ++c) {
+				if (c > 0) {
+					agp << "scaffold" << s << '\t' << pos << '\t'
+						<< pos + gapLength - 1 << '\t' << partNum++
+						<< "\tN\t" << gapLength << "\tfragment\tyes\n";
+					pos += gapLength;
+				}
+				agp << "scaffold" << s << '\t' << pos << '\t'
+					<< pos + contigLength - 1 << '\t' << partNum++
+					<< "\tW\tcontig" << s << '_' << c << "\t1\t"
+					<< contigLength << '\t' << (c % 2 == 0 ? '+' : '-')
+					<< '\n';
+				pos += contigLength;
+			}
+		}
+
+		boost::timer timer;
+		std::istringstream forwardAGP(agp.str());
+		bio::agp::AGPForwardMapper forward(forwardAGP);
+		std::istringstream backwardAGP(agp.str());
+		bio::agp::AGPBackwardMapper backward(backwardAGP);
+		std::cerr << "index: " << timer.elapsed() << '\n';
+
+		// Random intervals within contigs
+		base_generator_type generator(seed);
+		variate_generator_type
+			randScaffold(generator, distribution_type(0, numScaffolds - 1));
+		variate_generator_type
+			randContig(generator, distribution_type(0, contigsPerScaffold - 1));
+		variate_generator_type
+			randStart(generator, distribution_type(0, contigLength - 1));
+		variate_generator_type
+			randLength(generator, distribution_type(1, intervalLength));
+		std::vector<BasicInterval> intervals;
+		intervals.reserve(numIntervals);
+		for (size_t i = 0; i < numIntervals; ++i) {
+			long start = randStart();
+			long end = std::min(start + randLength(),
+								static_cast<long>(contigLength));
+			intervals.push_back(BasicInterval("contig"
+											  + toString(randScaffold())
+											  + '_' + toString(randContig()),
+											  start, end, '+'));
+		}
+
+		std::vector<BasicInterval> mapped;
+		std::vector<BasicInterval> transformed;
+		transformed.reserve(numIntervals);
+		timer.restart();
+		for (size_t i = 0; i < intervals.size(); ++i) {
+			mapped.clear();
+			forward.map(intervals[i], mapped);
+			if (mapped.size() != 1) {
+				throw std::runtime_error("Interval not transformed: "
+										 + toString(intervals[i]));
+			}
+			transformed.push_back(mapped[0]);
+		}
+		std::cerr << "forward: " << timer.elapsed() << '\n';
+
+		timer.restart();
+		size_t numMismatches = 0;
+		for (size_t i = 0; i < transformed.size(); ++i) {
+			mapped.clear();
+			backward.map(transformed[i], mapped);
+			if (mapped.size() != 1
+				or mapped[0].getChrom() != intervals[i].getChrom()
+				or mapped[0].getStart() != intervals[i].getStart()
+				or mapped[0].getEnd() != intervals[i].getEnd()) {
+				++numMismatches;
+			}
+		}
+		std::cerr << "backward: " << timer.elapsed() << '\n';
+
+		if (numMismatches > 0) {
+			throw std::runtime_error(toString(numMismatches) +
+									 " intervals did not transform back to "
+									 "themselves");
+		}
+
+	} catch (const std::runtime_error& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -18,25 +18,56 @@
 */
 
 #include <iostream>
-#include <fstream>
-#include <map>
-#include <vector>
+#include <set>
+#include <stdexcept>
 
 #include "bio/formats/agp/Record.hh"
 #include "bio/formats/agp/InputStream.hh"
+#include "bio/formats/agp/Assembler.hh"
 #include "bio/formats/fasta/InputStream.hh"
-#include "bio/formats/fasta/OutputStream.hh"
+#include "bio/formats/fasta/IndexedFile.hh"
 #include "bio/alphabet/AmbiguousNucleotide.hh"
 #include "boost/unordered_map.hpp"
 #include "util/options.hh"
+#include "util/string.hh"
 #include "filesystem/InputFileStream.hh"
 using namespace bio::formats;
 
-struct AGPContigStartSorter {
-	bool operator()(const agp::Record* r1,
-					const agp::Record* r2) const {
-		return r1->getContigStart() < r2->getContigStart();
+// Serves components from the records of a FASTA stream that are used
+// by the assembly, read into memory up front.  Records are named by
+// the first word of their titles, as in fasta::IndexedFile.
+class StreamSource : public agp::Assembler::Source {
+public:
+	StreamSource(std::istream& strm, const std::set<std::string>& names) {
+		fasta::InputStream fastaStream(strm);
+		fasta::Record fastaRecord;
+		while (fastaStream >> fastaRecord) {
+			std::string name = util::string::firstWord(fastaRecord.title);
+			if (names.find(name) != names.end()) {
+				seqRecs[name].swap(fastaRecord.sequence);
+			}
+		}
+	}
+
+	std::string getSeq(const std::string& name,
+					   const size_t start,
+					   const size_t end,
+					   const char strand) {
+		SeqMap::const_iterator seqIt = seqRecs.find(name);
+		if (seqIt == seqRecs.end()) {
+			throw std::runtime_error("Source record not found in input: "
+									 + name);
+		}
+		std::string seq = seqIt->second.substr(start, end - start);
+		if (strand == '-') {
+			bio::alphabet::AmbiguousDNA.reverseComplementInPlace(seq);
+		}
+		return seq;
 	}
+
+private:
+	typedef boost::unordered_map<std::string, std::string> SeqMap;
+	SeqMap seqRecs;
 };
 
 int main(int argc, const char* argv[]) {
@@ -45,73 +76,52 @@ int main(int argc, const char* argv[]) {
 
 	// Initialize options to defaults
 	std::string agpFilename;
+	std::string fastaFilename;
+	size_t numThreads = 1;
 	
 	util::options::Parser parser("< fastaInput > fastaOutput",
 								 "Assemble sequences from input into larger "
 								 "sequences as specified by an AGP file");
+	parser.addStoreOpt('f', "fasta",
+					   "read sequences from this FASTA file as they are "
+					   "needed rather than loading them from standard input "
+					   "(indexed with FILE.fai if present)",
+					   fastaFilename, "FILE");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for assembly (0 for one per processor)",
+					   numThreads, "NUM");
 	parser.addStoreArg("apgFile",
 					   "AGP file specifying how the sequences in the input "
 					   "are assembled into sequences in the output",
 					   agpFilename);
 	parser.parse(argv, argv + argc);
 
-	// Read input sequences into a map
-	typedef boost::unordered_map<std::string, std::string> SeqMap;
-	SeqMap seqRecs;
-	bio::formats::fasta::InputStream fastaStream(std::cin);
-	bio::formats::fasta::Record fastaRecord;
-	while (fastaStream >> fastaRecord) {
-		seqRecs[fastaRecord.title] = fastaRecord.sequence;
-	}
-		
-	// Read AGP records into map
-	std::map<std::string, std::vector<agp::Record*> > chromRecs;
-	filesystem::InputFileStream agpFile(agpFilename);
-	//std::ifstream agpFile(agpFilename.c_str());
-	agp::InputStream agpStream(agpFile);
-	agp::Record rec;
-	while (agpStream >> rec) {
-		chromRecs[rec.getChrom()].push_back(new agp::Record(rec));
-	}
-
-	// Construct each chromosome separately and insert into output
-	bio::formats::fasta::OutputStream fastaOutStream(std::cout);
-	std::map<std::string, std::vector<agp::Record*> >::iterator it;
-	for (it = chromRecs.begin(); it != chromRecs.end(); ++it) {
-		const std::string& chrom = it->first;
-		std::vector<agp::Record*>& recs = it->second;
-
-		// Order the AGP records by contig start coordinate
-		std::sort(recs.begin(), recs.end(), AGPContigStartSorter());
-
-		// Determine the chrom length and make a new sequence
-		std::string chromSeq(recs.back()->getContigEnd(), 'N');
-		std::vector<agp::Record*>::iterator recIt;
-		for (recIt = recs.begin(); recIt != recs.end(); ++recIt) {
-			if ((*recIt)->isGap()) {
-				continue;
-			}
-
-			std::string sourceName = (*recIt)->getSourceAccession();
-			SeqMap::iterator seqIt = seqRecs.find(sourceName);
-			if (seqIt == seqRecs.end()) {
-				std::cerr << "Error: "
-						  << "Source record not found in input: "
-						  << sourceName << '\n';
-				exit(EXIT_FAILURE);
-			}
-			std::string seq =
-				seqIt->second.substr((*recIt)->getSourceStart() - 1,
-									 (*recIt)->getSourceEnd() -
-									 (*recIt)->getSourceStart() + 1);
-			if ((*recIt)->getSourceOrientation() == '-') {
-				bio::alphabet::AmbiguousDNA.reverseComplementInPlace(seq);
-			}
-
-			chromSeq.replace((*recIt)->getContigStart() - 1, seq.size(), seq);
+	try {
+		// Read AGP records
+		agp::Assembler assembler;
+		filesystem::InputFileStream agpFile(agpFilename);
+		agp::InputStream agpStream(agpFile);
+		agp::Record rec;
+		while (agpStream >> rec) {
+			assembler.addRecord(rec);
 		}
 
-		fastaOutStream << bio::formats::fasta::Record(chrom, chromSeq);
+		// Construct each chromosome and write it to the output
+		agp::Assembler::FastaSink sink(std::cout);
+		if (fastaFilename.empty()) {
+			std::set<std::string> names;
+			assembler.getSourceNames(names);
+			StreamSource source(std::cin, names);
+			assembler.assemble(source, sink, numThreads);
+		} else {
+			fasta::IndexedFile fastaFile;
+			fastaFile.open(fastaFilename);
+			agp::Assembler::FastaSource source(fastaFile);
+			assembler.assemble(source, sink, numThreads);
+		}
+	} catch (const std::runtime_error& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
 	}
 	
 	return EXIT_SUCCESS;
@@ -19,79 +19,59 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "bio/formats/fasta/InputStream.hh"
 #include "bio/gff/GFFRecord.hh"
 #include "bio/alphabet/AmbiguousNucleotide.hh"
-#include "bio/translation/Translator.hh"
+#include "bio/translation/OrfScanner.hh"
 #include "util/options.hh"
-using bio::translation::Translator;
+#include "util/thread.hh"
+using bio::translation::OrfScanner;
 
-void findOrfs(std::string& seq,
-			  const std::string& seqname,
-			  const Translator& translator,
-			  const unsigned int minLength,
-			  const bool mask,
-			  std::ostream& strm) {
-	if (mask) {
-		bio::alphabet::Nucleotide::hardMaskInPlace(seq);
+// Records are read in batches of about this many bases, whose ORFs are
+// found in parallel
+const size_t BATCH_SIZE = 1 << 24;
+
+class OrfTask : public util::thread::Task {
+public:
+	OrfTask(const OrfScanner& scanner,
+			std::string& seq,
+			const unsigned int minLength,
+			const bool mask,
+			OrfScanner::OrfList& orfs)
+		: scanner(scanner), seq(seq), minLength(minLength), mask(mask),
+		  orfs(orfs) {}
+
+	void run() {
+		if (mask) {
+			bio::alphabet::Nucleotide::hardMaskInPlace(seq);
+		}
+		scanner.findOrfs(seq, minLength, orfs);
 	}
 
+private:
+	const OrfScanner& scanner;
+	std::string& seq;
+	const unsigned int minLength;
+	const bool mask;
+	OrfScanner::OrfList& orfs;
+};
+
+void outputOrfs(const std::string& seqname,
+				const OrfScanner::OrfList& orfs,
+				std::ostream& strm) {
 	bio::gff::GFFRecord rec;
 	rec.setSeqname(seqname);
 	rec.setSource("faOrfs");
 	rec.setFeature("CDS");
 	rec.setFrame(0);
-	
-	rec.setStrand('+');
-	for (unsigned int phase = 0; phase < 3; ++phase) {
-		std::string protein = translator.translate(seq, phase);
-
-		std::string::size_type start = protein.find_first_not_of("X*");
-		while (start != std::string::npos) {
-			std::string::size_type end = protein.find_first_of("X*", start + 1);
-			unsigned int length = 
-				end == std::string::npos ?
-				(protein.length() - start) * 3:
-				(end - start) * 3;
-			if (length >= minLength) {
-				rec.setStart(start * 3 + phase + 1);
-				rec.setEnd(rec.getStart() + (length - 1));
-				strm << rec;
-			}
-			if (end == std::string::npos) {
-				break;
-			} else {
-				start = protein.find_first_not_of("X*", end + 1);
-			}
-		}
+	for (size_t i = 0; i < orfs.size(); ++i) {
+		rec.setStrand(orfs[i].strand);
+		rec.setStart(orfs[i].start + 1);
+		rec.setEnd(orfs[i].end);
+		strm << rec;
 	}
-
-	bio::alphabet::AmbiguousDNA.reverseComplementInPlace(seq);
-	
-	rec.setStrand('-');
-	for (unsigned int phase = 0; phase < 3; ++phase) {
-		std::string protein = translator.translate(seq, phase);
-		std::string::size_type start = protein.find_first_not_of("X*");	
-		while (start != std::string::npos) {
-			std::string::size_type end = protein.find_first_of("X*", start + 1);
-			unsigned int length = 
-				end == std::string::npos ?
-				(protein.length() - start) * 3:
-				(end - start) * 3;
-			if (length >= minLength) {
-				rec.setEnd(seq.length() - (start * 3 + phase));
-				rec.setStart(rec.getEnd() - (length - 1));
-				strm << rec;
-			}
-			if (end == std::string::npos) {
-				break;
-			} else {
-				start = protein.find_first_not_of("X*", end + 1);
-			}
-		}
-	}
-	
 }
 
 int main(int argc, const char* argv[]) {
@@ -102,6 +82,7 @@ int main(int argc, const char* argv[]) {
 	size_t tableNum = 1;
 	bool mask = false;
 	size_t minLength = 150;
+	size_t numThreads = 1;
 
 	util::options::Parser parser("< fastaInput > gffOutput",
 								 "Output all potential ORFs in FASTA input");
@@ -114,19 +95,41 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt('l', "minlength", 
 					   "only output ORFs of length at least LENGTH (bp)",
 					   minLength, "LENGTH");
+	parser.addStoreOpt(0, "threads",
+					   "number of threads for finding ORFs "
+					   "(0 for one per processor)",
+					   numThreads, "NUM");
 	parser.parse(argv, argv + argc);
 
 	try {
-		Translator translator(tableNum);
+		OrfScanner scanner(tableNum);
+		util::thread::ThreadPool pool(numThreads);
 
 		// Construct FASTA stream for fast reading
 		bio::formats::fasta::InputStream fastaStream(std::cin);
 		
-		// Step through records, output ORFs for each
+		// Step through batches of records, output ORFs for each record
+		// in input order
+		std::vector<bio::formats::fasta::Record> batch;
+		std::vector<OrfScanner::OrfList> orfs;
 		bio::formats::fasta::Record rec;
-		while (fastaStream >> rec) {
-			findOrfs(rec.sequence, rec.title,
-					 translator, minLength, mask, std::cout);
+		bool more = true;
+		while (more) {
+			batch.clear();
+			size_t numBases = 0;
+			while (numBases < BATCH_SIZE and (more = (fastaStream >> rec))) {
+				numBases += rec.sequence.size();
+				batch.push_back(rec);
+			}
+			orfs.assign(batch.size(), OrfScanner::OrfList());
+			for (size_t i = 0; i < batch.size(); ++i) {
+				pool.add(new OrfTask(scanner, batch[i].sequence,
+									 minLength, mask, orfs[i]));
+			}
+			pool.wait();
+			for (size_t i = 0; i < batch.size(); ++i) {
+				outputOrfs(batch[i].title, orfs[i], std::cout);
+			}
 		}
 	
 	} catch (const std::runtime_error& e) {
@@ -18,12 +18,10 @@
 */
 
 #include <iostream>
-#include <iterator>
-#include <vector>
-#include <algorithm>
+#include <string>
 
 #include "bio/formats/fasta.hh"
-#include "util/stl.hh"
+#include "util/sort.hh"
 #include "util/options.hh"
 
 // Functor for comparing FASTA records based on their titles
@@ -34,33 +32,70 @@ struct FASTATitleComparer {
 	}
 };
 
+// Writes FASTA records to temporary sort files as a title line followed
+// by the whole sequence on one line
+struct FASTARecordSerializer {
+	void write(std::ostream& strm,
+			   const bio::formats::fasta::Record& rec) const {
+		strm << rec.title << '\n' << rec.sequence << '\n';
+	}
+
+	bool read(std::istream& strm, bio::formats::fasta::Record& rec) const {
+		if (std::getline(strm, rec.title) and
+			std::getline(strm, rec.sequence)) {
+			return true;
+		}
+		return false;
+	}
+
+	size_t size(const bio::formats::fasta::Record& rec) const {
+		return sizeof(rec) + rec.title.capacity() + rec.sequence.capacity();
+	}
+};
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
 
+	// Initialize options to defaults
+	size_t bufferSize = util::sort::DEFAULT_BUFFER_SIZE / (1024 * 1024);
+	std::string tempDir;
+	size_t numThreads = 1;
+
 	// Parse command line
 	util::options::Parser parser("< fastaInput", "Sort FASTA records by title");
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use before spilling sorted "
+					   "runs to temporary files",
+					   bufferSize, "MB");
+	parser.addStoreOpt('T', "temp-dir",
+					   "directory for temporary files (default: $TMPDIR "
+					   "or /tmp)",
+					   tempDir, "DIR");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for sorting runs (0 for one "
+					   "per processor)",
+					   numThreads, "NUM");
 	parser.parse(argv, argv + argc);
 
 	try {
 		// Construct FASTA stream for fast reading
 		bio::formats::fasta::InputStream fastaInStream(std::cin);
 		
-		// Read FASTA records into a vector
-		std::vector<bio::formats::fasta::Record> recs;
+		// Read FASTA records into the sorter
+		util::sort::ExternalSorter<bio::formats::fasta::Record,
+								   FASTATitleComparer,
+								   FASTARecordSerializer>
+			sorter(bufferSize * 1024 * 1024, tempDir, numThreads);
 		bio::formats::fasta::Record rec;
 		while (fastaInStream >> rec) {
-			recs.push_back(rec);
+			sorter.push(rec);
 		}
 		
-		// Sort the records based on their titles
-		std::sort(recs.begin(), recs.end(), FASTATitleComparer());
-		
-		// Write the sorted records to stdout
+		// Write the records sorted by title to stdout
 		bio::formats::fasta::OutputStream fastaOutStream(std::cout);
-		typedef std::vector<bio::formats::fasta::Record>::const_iterator Iterator;
-		for (Iterator it = recs.begin(); it != recs.end(); ++it) {
-			fastaOutStream << *it;
+		while (sorter.next(rec)) {
+			fastaOutStream << rec;
 		}
 	} catch (const std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
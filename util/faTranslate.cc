@@ -20,7 +20,7 @@
 #include <iostream>
 
 #include "bio/formats/fasta.hh"
-#include "bio/translation/Translator.hh"
+#include "bio/translation/OrfScanner.hh"
 #include "bio/alphabet/Nucleotide.hh"
 #include "util/options.hh"
 
@@ -55,7 +55,7 @@ int main(int argc, const char* argv[]) {
 			throw std::runtime_error("Frame must be 0, 1, or 2");
 		}
 
-		bio::translation::Translator translator(tableNum);
+		bio::translation::OrfScanner translator(tableNum);
 
 		// Create FASTA stream for fast reading
 		bio::formats::fasta::InputStream fastaInStream(std::cin);
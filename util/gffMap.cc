@@ -23,12 +23,42 @@
 #include "bio/gff/GFFRecord.hh"
 #include "bio/gff/GFFInputStream.hh"
 #include "bio/homologymap/HomologyMapper.hh"
+#include "bio/homologymap/BatchHomologyMapper.hh"
 #include "util/string.hh"
 #include "util/options.hh"
 using util::string::toString;
 using bio::gff::GFFRecord;
 using bio::genome::BasicInterval;
 using bio::homologymap::HomologyMapper;
+using bio::homologymap::BatchHomologyMapper;
+
+void writeMapped(GFFRecord& rec,
+				 const std::vector<BasicInterval>& mapped,
+				 bool output_unmapped,
+				 const std::string& unmapped_attribute,
+				 const std::string& seg_attr) {
+	if (mapped.empty()) {
+		if (output_unmapped) {
+			rec.addAttribute(unmapped_attribute);
+			std::cout << rec;
+			return;
+		} else {
+			std::cerr << "Warning: Record not mapped: " << rec;
+		}
+	}
+			
+	if (not rec.hasAttribute(seg_attr)) {
+		rec.addAttribute(seg_attr);
+	}
+	GFFRecord::Attribute& attr = rec.getAttribute(seg_attr);
+	attr.values.push_back("0");
+	std::string& seg_num = attr.values.back();
+	for (size_t i = 0; i < mapped.size(); ++i) {
+		rec.setInterval(mapped[i]);
+		seg_num = toString(i + 1);
+		std::cout << rec;
+	}
+}
 
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
@@ -38,6 +68,8 @@ int main(int argc, const char* argv[]) {
 	bool output_unmapped = false;
 	std::string unmapped_attribute = "UNMAPPED";
 	std::string seg_attr = "segment";
+	bool batch = false;
+	size_t num_threads = 0;
 	std::string align_dir;	
 	std::string source;
 	std::string target;
@@ -54,6 +86,14 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt(0, "unmapped-attribute",
 					   "Attribute to add to unmapped records",
 					   unmapped_attribute);
+	parser.addStoreTrueOpt('b', "batch",
+						   "Read all records before mapping and map them "
+						   "segment by segment on several threads.  Records "
+						   "are output in their original order", batch);
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to use in batch mode "
+					   "(default: one per processor)",
+					   num_threads, "NUM");
 	parser.addStoreArg("align_dir", "", align_dir);
 	parser.addStoreArg("source_genome", "", source);
 	parser.addStoreArg("target_genome", "", target);
@@ -64,32 +104,38 @@ int main(int argc, const char* argv[]) {
 
 		bio::gff::GFFInputStream gffStream(std::cin);
 
-		GFFRecord rec;
-		std::vector<BasicInterval> mapped;
-		while (gffStream >> rec) {
-			mapped.clear();
-			mapper.map(rec.getInterval(), mapped);
+		if (batch) {
+			std::vector<GFFRecord> recs;
+			GFFRecord rec;
+			while (gffStream >> rec) {
+				recs.push_back(rec);
+			}
 
-			if (mapped.empty()) {
-				if (output_unmapped) {
-					rec.addAttribute(unmapped_attribute);
-					std::cout << rec;
-					continue;
-				} else {
-					std::cerr << "Warning: Record not mapped: " << rec;
-				}
+			std::vector<BasicInterval> intervals;
+			intervals.reserve(recs.size());
+			for (size_t i = 0; i < recs.size(); ++i) {
+				intervals.push_back(recs[i].getInterval());
 			}
-			
-			if (not rec.hasAttribute(seg_attr)) {
-				rec.addAttribute(seg_attr);
+			std::vector<const bio::genome::Interval*> sources;
+			for (size_t i = 0; i < intervals.size(); ++i) {
+				sources.push_back(&intervals[i]);
+			}
+
+			std::vector< std::vector<BasicInterval> > mapped;
+			BatchHomologyMapper(mapper, num_threads).map(sources, mapped);
+
+			for (size_t i = 0; i < recs.size(); ++i) {
+				writeMapped(recs[i], mapped[i], output_unmapped,
+							unmapped_attribute, seg_attr);
 			}
-			GFFRecord::Attribute& attr = rec.getAttribute(seg_attr);
-			attr.values.push_back("0");
-			std::string& seg_num = attr.values.back();
-			for (size_t i = 0; i < mapped.size(); ++i) {
-				rec.setInterval(mapped[i]);
-				seg_num = toString(i + 1);
-				std::cout << rec;
+		} else {
+			GFFRecord rec;
+			std::vector<BasicInterval> mapped;
+			while (gffStream >> rec) {
+				mapped.clear();
+				mapper.map(rec.getInterval(), mapped);
+				writeMapped(rec, mapped, output_unmapped,
+							unmapped_attribute, seg_attr);
 			}
 		}
 			
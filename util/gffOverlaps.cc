@@ -18,80 +18,156 @@
 */
 
 #include <iostream>
-#include <vector>
-#include <set>
-#include <algorithm>
+#include <deque>
 
 #include "boost/function_output_iterator.hpp"
+#include "boost/shared_ptr.hpp"
 
 #include "bio/gff/GFFRecord.hh"
 #include "bio/gff/GFFInputStream.hh"
+#include "bio/gff/GFFRecordSerializer.hh"
 #include "bio/genome/Coord.hh"
 #include "util/interval.hh"
+#include "util/sort.hh"
 #include "util/options.hh"
 #include "filesystem.hh"
 
 using namespace filesystem;
 using bio::gff::GFFRecord;
 using bio::gff::GFFInputStream;
+using bio::genome::Coord;
+
+// Order of GFF records required by the overlap sweep
+struct StartLessThan {
+	bool operator()(const GFFRecord& x, const GFFRecord& y) const {
+		int chromComp = x.getSeqname().compare(y.getSeqname());
+		return chromComp < 0
+			or (chromComp == 0 and x.getStart() < y.getStart());
+	}
+};
+
+typedef util::sort::SortedReader<GFFRecord,
+								 GFFInputStream,
+								 StartLessThan,
+								 bio::gff::GFFRecordSerializer> SortedGFFReader;
 
-template<typename T>
-struct DereferencedLessThan {
-	bool operator()(const T* x, const T* y) const { return *x < *y; }
+// A record taking part in the overlap sweep
+struct SweepRecord {
+	GFFRecord rec;
+	bool overlapped;
 };
 
-namespace util { namespace interval {
-	template<>
-	struct interval_traits<GFFRecord*> {
-		typedef bio::genome::Coord coord_type;
-		typedef bio::genome::Distance difference_type;
-		static coord_type start(const GFFRecord* i) {
-			return bio::genome::Coord(i->getSeqname(), i->getStart() - 1);
-		}
-		static coord_type end(const GFFRecord* i) {
-			return bio::genome::Coord(i->getSeqname(), i->getEnd());
-		}
-	};
-} }
-
-void readGFFRecords(const std::string& filename,
-					std::vector<GFFRecord*>& recs) {
-	InputFileStream file(filename);
-	GFFInputStream stream(file);
-	GFFRecord r;
-	while (stream >> r) {
-		recs.push_back(new GFFRecord(r));
-	}
-}
+typedef boost::shared_ptr<SweepRecord> SweepRecordPtr;
 
-void writeGFFRecords(const std::string& filename,
-					 const std::vector<GFFRecord*>& recs) {
-	OutputFileStream file(filename);
-	typedef std::vector<GFFRecord*>::const_iterator Iterator;
-	for (Iterator it = recs.begin(); it != recs.end(); ++it) {
-		file << **it;
+struct SweepRecordTraits {
+	typedef Coord coord_type;
+	typedef bio::genome::Distance difference_type;
+	static coord_type start(const SweepRecordPtr& r) {
+		return Coord(r->rec.getSeqname(), r->rec.getStart() - 1);
 	}
-}
-
-void sortGFFRecords(std::vector<GFFRecord*>& recs) {
-	std::sort(recs.begin(), recs.end(), DereferencedLessThan<GFFRecord>());
-}
+	static coord_type end(const SweepRecordPtr& r) {
+		return Coord(r->rec.getSeqname(), r->rec.getEnd());
+	}
+};
 
 // Functor for receiving the results of the overlap analysis of the
 // GFF intervals.
 struct OverlapRecorder {
-	OverlapRecorder(std::set<GFFRecord*>& overlapped1,
-					std::set<GFFRecord*>& overlapped2)
-		: overlapped1(&overlapped1), overlapped2(&overlapped2) {
+ 	void operator()(const std::pair<SweepRecordPtr, SweepRecordPtr>& overlap) {
+		overlap.first->overlapped = true;
+		overlap.second->overlapped = true;
 	}
+};
 
- 	void operator()(const std::pair<GFFRecord*, GFFRecord*>& overlap) {
-		overlapped1->insert(overlap.first);
-		overlapped2->insert(overlap.second);
+// Runs the overlap sweep over two sorted GFF inputs.  Records are
+// kept only until the sweep has passed their end, at which point they
+// are written to the output for their input if they overlapped a
+// record of the other input.  Records are written in input order.
+class OverlapSweep {
+public:
+	OverlapSweep(SortedGFFReader& reader1, SortedGFFReader& reader2,
+				 std::ostream& out1, std::ostream& out2) {
+		readers[0] = &reader1;
+		readers[1] = &reader2;
+		outs[0] = &out1;
+		outs[1] = &out2;
+		for (size_t s = 0; s < 2; ++s) {
+			started[s] = done[s] = false;
+			sides[s].sweep = this;
+			sides[s].side = s;
+		}
 	}
-	
-	std::set<GFFRecord*>* overlapped1;
-	std::set<GFFRecord*>* overlapped2;
+
+	void run() {
+		typedef util::sort::ReaderIterator<Side, SweepRecordPtr> Iterator;
+		Iterator first1(sides[0]);
+		Iterator first2(sides[1]);
+		util::interval::overlaps(first1, Iterator(), first2, Iterator(),
+								 boost::make_function_output_iterator(OverlapRecorder()),
+								 SweepRecordTraits(), SweepRecordTraits());
+		flush();
+	}
+
+private:
+	struct Side {
+		OverlapSweep* sweep;
+		size_t side;
+		bool next(SweepRecordPtr& r) { return sweep->read(side, r); }
+	};
+
+	bool read(size_t side, SweepRecordPtr& r) {
+		GFFRecord rec;
+		if (not readers[side]->next(rec)) {
+			done[side] = true;
+			current[side].reset();
+			flush();
+			return false;
+		}
+		r.reset(new SweepRecord);
+		r->rec = rec;
+		r->overlapped = false;
+		pending[side].push_back(r);
+		current[side] = r;
+		started[side] = true;
+		flush();
+		return true;
+	}
+
+	// Writes out pending records that can no longer overlap any record
+	// that the sweep has not yet processed
+	void flush() {
+		if (not (started[0] or done[0]) or not (started[1] or done[1])) {
+			return;
+		}
+
+		bool all = done[0] and done[1];
+		Coord frontier;
+		if (not all) {
+			frontier = SweepRecordTraits::start(done[0] ? current[1] : current[0]);
+			if (not done[0] and not done[1]) {
+				frontier = std::min(frontier,
+									SweepRecordTraits::start(current[1]));
+			}
+		}
+
+		for (size_t s = 0; s < 2; ++s) {
+			while (not pending[s].empty()
+				   and (all or SweepRecordTraits::end(pending[s].front()) <= frontier)) {
+				if (pending[s].front()->overlapped) {
+					*outs[s] << pending[s].front()->rec;
+				}
+				pending[s].pop_front();
+			}
+		}
+	}
+
+	SortedGFFReader* readers[2];
+	std::ostream* outs[2];
+	Side sides[2];
+	std::deque<SweepRecordPtr> pending[2];
+	SweepRecordPtr current[2];
+	bool started[2];
+	bool done[2];
 };
 
 int main(int argc, const char* argv[]) {
@@ -99,12 +175,27 @@ int main(int argc, const char* argv[]) {
 	std::ios::sync_with_stdio(false);
 
 	// Options and defaults
+	bool sorted = false;
+	size_t bufferSize = util::sort::DEFAULT_BUFFER_SIZE / (1024 * 1024);
+	std::string tempDir;
 	std::string gffInFilename1;
 	std::string gffInFilename2;
 	std::string gffOutFilename1;
 	std::string gffOutFilename2;
 	
 	util::options::Parser parser("", "");
+	parser.addStoreTrueOpt('s', "sorted",
+						   "input files are already sorted by seqname and "
+						   "start, so they are streamed without sorting",
+						   sorted);
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use for sorting unsorted "
+					   "input before spilling to temporary files",
+					   bufferSize, "MB");
+	parser.addStoreOpt('T', "temp-dir",
+					   "directory for temporary files (default: $TMPDIR "
+					   "or /tmp)",
+					   tempDir, "DIR");
 	parser.addStoreArg("gffFile1", "First GFF File", gffInFilename1);
 	parser.addStoreArg("gffFile2", "Second GFF File", gffInFilename2);
 	parser.addStoreArg("outGFFFile1", "First output GFF File", gffOutFilename1);
@@ -112,29 +203,19 @@ int main(int argc, const char* argv[]) {
 	parser.parse(argv, argv + argc);
 
 	try {
-		std::vector<GFFRecord*> gffRecs1, gffRecs2;
-		readGFFRecords(gffInFilename1, gffRecs1);
-		readGFFRecords(gffInFilename2, gffRecs2);
-
-		sortGFFRecords(gffRecs1);
-		sortGFFRecords(gffRecs2);
-
-		std::set<GFFRecord*> overlapped1, overlapped2;
-		util::interval::overlaps(gffRecs1.begin(), gffRecs1.end(),
-								 gffRecs2.begin(), gffRecs2.end(),
-								 boost::make_function_output_iterator(OverlapRecorder(overlapped1, overlapped2)));
-
-
-		std::vector<GFFRecord*> overlappedList1(overlapped1.begin(),
-												overlapped1.end());
-		std::vector<GFFRecord*> overlappedList2(overlapped2.begin(),
-												overlapped2.end());
-
-		sortGFFRecords(overlappedList1);
-		sortGFFRecords(overlappedList2);
-		
-		writeGFFRecords(gffOutFilename1, overlappedList1);
-		writeGFFRecords(gffOutFilename2, overlappedList2);
+		InputFileStream gffInFile1(gffInFilename1);
+		InputFileStream gffInFile2(gffInFilename2);
+		GFFInputStream gffStream1(gffInFile1);
+		GFFInputStream gffStream2(gffInFile2);
+		SortedGFFReader reader1(gffStream1, sorted,
+								bufferSize * 1024 * 1024, tempDir);
+		SortedGFFReader reader2(gffStream2, sorted,
+								bufferSize * 1024 * 1024, tempDir);
+
+		OutputFileStream gffOutFile1(gffOutFilename1);
+		OutputFileStream gffOutFile2(gffOutFilename2);
+
+		OverlapSweep(reader1, reader2, gffOutFile1, gffOutFile2).run();
 
 	} catch (const std::exception& e) {
 		std::cerr << "Error: " << e.what();
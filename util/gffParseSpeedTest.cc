@@ -0,0 +1,263 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <cstdlib>
+
+#include "boost/tokenizer.hpp"
+#include "boost/random/mersenne_twister.hpp"
+#include "boost/random/uniform_int.hpp"
+#include "boost/random/variate_generator.hpp"
+#include "boost/timer.hpp"
+
+#include "bio/gff/GFFRecord.hh"
+#include "util/options.hh"
+#include "util/parser.hh"
+
+typedef boost::mt19937 base_generator_type;
+typedef boost::uniform_int<long> distribution_type;
+typedef boost::variate_generator<base_generator_type&,
+								 distribution_type> variate_generator_type;
+
+const std::string USAGE = "";
+
+const std::string DESCRIPTION =
+	"Times parsing of GTF lines with GFFRecord against the previous "
+	"tokenizer-based parser, with and without an attribute lookup";
+
+// The previous GFF line parser: every field is copied into a string
+// and attributes are tokenized into lists of strings
+struct LegacyRecord {
+	struct Attribute {
+		std::string tag;
+		std::list<std::string> values;
+	};
+
+	std::string seqname, source, feature;
+	long start, end;
+	float score;
+	char strand, frame;
+	std::string attributeString;
+	std::list<Attribute> attributes;
+
+	void parse(const std::string& line) {
+		typedef boost::char_separator<char> CharSep;
+		typedef boost::tokenizer<CharSep> CharTok;
+		CharTok tabtok(line, CharSep("\t", "", boost::keep_empty_tokens));
+		std::vector<std::string> fields(tabtok.begin(), tabtok.end());
+		if (fields.size() < 9) {
+			throw util::parser::FormatError(line, "invalid number of fields");
+		}
+		seqname = fields[0];
+		source = fields[1];
+		feature = fields[2];
+		start = std::atoi(fields[3].c_str());
+		end = std::atoi(fields[4].c_str());
+		score = (fields[5] == "." ? 0 : std::atof(fields[5].c_str()));
+		strand = fields[6].at(0);
+		frame = fields[7].at(0);
+		std::string s = fields[8];
+		for (size_t i = 9; i < fields.size(); ++i) {
+			s += " " + fields[i];
+		}
+		attributes.clear();
+		attributeString = s.substr(0, s.find('#'));
+	}
+
+	const Attribute& getAttribute(const std::string& tag) {
+		typedef boost::tokenizer<boost::char_separator<char> > CharTok;
+		typedef boost::tokenizer<boost::escaped_list_separator<char> > EscListTok;
+		if (not attributeString.empty()) {
+			CharTok ctok(attributeString, boost::char_separator<char>(";"));
+			for (CharTok::iterator pos = ctok.begin();
+				 pos != ctok.end(); ++pos) {
+				EscListTok ltok(*pos,
+								boost::escaped_list_separator<char>('\\', ' ',
+																	'\"'));
+				Attribute a;
+				for (EscListTok::iterator sub = ltok.begin();
+					 sub != ltok.end(); ++sub) {
+					if (sub->empty()) {
+						continue;
+					} else if (a.tag.empty()) {
+						a.tag = *sub;
+					} else {
+						a.values.push_back(*sub);
+					}
+				}
+				if (not a.tag.empty()) {
+					attributes.push_back(a);
+				}
+			}
+			attributeString.clear();
+		}
+		std::list<Attribute>::const_iterator a;
+		for (a = attributes.begin(); a != attributes.end(); ++a) {
+			if (a->tag == tag) {
+				return *a;
+			}
+		}
+		throw std::runtime_error("Attribute not found: " + tag);
+	}
+};
+
+// Generates lines in the style of an Ensembl GTF: transcripts of
+// several exons, each exon with CDS and codon features
+void generateLines(size_t numLines,
+				   base_generator_type::result_type seed,
+				   std::vector<std::string>& lines) {
+	static const char* FEATURES[] = { "exon", "CDS", "start_codon",
+									  "stop_codon" };
+	base_generator_type generator(seed);
+	variate_generator_type randChrom(generator, distribution_type(1, 22));
+	variate_generator_type randLength(generator, distribution_type(50, 500));
+	variate_generator_type randExons(generator, distribution_type(1, 12));
+
+	size_t gene = 0;
+	while (lines.size() < numLines) {
+		long chrom = randChrom();
+		long pos = randLength() * 1000;
+		long numExons = randExons();
+		std::ostringstream ids;
+		ids << "gene_id \"ENSG" << 10000000 + gene << "\"; "
+			<< "transcript_id \"ENST" << 10000000 + gene << "\"; "
+			<< "gene_name \"GENE" << gene << "\"; "
+			<< "gene_biotype \"protein_coding\";";
+		for (long e = 0; e < numExons and lines.size() < numLines; ++e) {
+			long length = randLength();
+			for (size_t f = 0; f < 4 and lines.size() < numLines; ++f) {
+				std::ostringstream line;
+				line << chrom << "\tensembl\t" << FEATURES[f] << '\t'
+					 << pos << '\t' << pos + length - 1 << "\t.\t+\t"
+					 << (f == 0 ? '.' : '0') << '\t' << ids.str()
+					 << " exon_number \"" << e + 1 << "\";";
+				lines.push_back(line.str());
+			}
+			pos += length + randLength();
+		}
+		++gene;
+	}
+}
+
+void report(const std::string& name, size_t numLines, double seconds) {
+	std::cerr << name << ": " << seconds << " s, "
+			  << (seconds > 0 ? numLines / seconds : 0) << " records/s\n";
+}
+
+int main(int argc, const char* argv[]) {
+	// Increase speed of input/output to standard streams
+	std::ios::sync_with_stdio(false);
+
+	// Initialize options to defaults
+	size_t numLines = 5000000;
+	size_t numDistinct = 100000;
+	std::string inputFile;
+	base_generator_type::result_type seed = 1;
+
+	util::options::Parser parser(USAGE, DESCRIPTION);
+	parser.addStoreOpt('n', "lines", "number of lines to parse", numLines);
+	parser.addStoreOpt(0, "distinct",
+					   "number of distinct synthetic lines, which are "
+					   "parsed repeatedly",
+					   numDistinct);
+	parser.addStoreOpt('i', "input",
+					   "GTF file whose lines are parsed instead of "
+					   "synthetic lines",
+					   inputFile, "FILE");
+	parser.addStoreOpt('s', "seed", "Seed for random number generator",
+					   seed, "INTEGER");
+	parser.parse(argv, argv + argc);
+
+	try {
+		std::vector<std::string> lines;
+		if (inputFile.empty()) {
+			generateLines(std::min(numLines, numDistinct), seed, lines);
+		} else {
+			std::ifstream in(inputFile.c_str());
+			if (not in) {
+				throw std::runtime_error("Could not open " + inputFile);
+			}
+			std::string line;
+			while (std::getline(in, line)) {
+				if (not line.empty() and line[0] != '#') {
+					lines.push_back(line);
+				}
+			}
+			numLines = lines.size();
+		}
+		if (lines.empty()) {
+			throw std::runtime_error("No lines to parse");
+		}
+
+		// Checksums keep the parsing from being optimized away and
+		// check that both parsers agree
+		boost::timer timer;
+		long legacySum = 0;
+		LegacyRecord legacy;
+		for (size_t i = 0; i < numLines; ++i) {
+			legacy.parse(lines[i % lines.size()]);
+			legacySum += legacy.end - legacy.start + legacy.seqname.size();
+		}
+		report("legacy parse", numLines, timer.elapsed());
+
+		timer.restart();
+		long sum = 0;
+		bio::gff::GFFRecord rec;
+		for (size_t i = 0; i < numLines; ++i) {
+			lines[i % lines.size()] >> rec;
+			sum += rec.getEnd() - rec.getStart() + rec.getSeqname().size();
+		}
+		report("parse", numLines, timer.elapsed());
+
+		timer.restart();
+		long legacyAttrSum = 0;
+		for (size_t i = 0; i < numLines; ++i) {
+			legacy.parse(lines[i % lines.size()]);
+			legacyAttrSum +=
+				legacy.getAttribute("gene_id").values.front().size();
+		}
+		report("legacy parse + gene_id", numLines, timer.elapsed());
+
+		timer.restart();
+		long attrSum = 0;
+		for (size_t i = 0; i < numLines; ++i) {
+			lines[i % lines.size()] >> rec;
+			attrSum += rec.getAttribute("gene_id").values.front().size();
+		}
+		report("parse + gene_id", numLines, timer.elapsed());
+
+		if (sum != legacySum or attrSum != legacyAttrSum) {
+			throw std::runtime_error("Parsers disagree");
+		}
+	} catch (const std::runtime_error& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	} catch (const util::parser::FormatError& e) {
+		std::cerr << "Error: " << e.getProblem() << " for line:\n"
+				  << e.getLine() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -27,8 +27,10 @@
 
 #include "bio/gff/GFFRecord.hh"
 #include "bio/gff/GFFInputStream.hh"
+#include "bio/gff/GFFRecordSerializer.hh"
 #include "util/interval.hh"
 #include "util/parser.hh"
+#include "util/sort.hh"
 #include "util/options.hh"
 
 // A coordinate within a Genome
@@ -157,6 +159,54 @@ struct SorterPtr : public Sorter {
 	}
 };
 
+// Order of GFF records required by the overlap algorithm
+struct StartLessThan {
+	bool operator()(const bio::gff::GFFRecord& x,
+					const bio::gff::GFFRecord& y) const {
+		int chromComp = x.getSeqname().compare(y.getSeqname());
+		return chromComp < 0
+			or (chromComp == 0 and x.getStart() < y.getStart());
+	}
+};
+
+typedef std::vector<GFFVertex*> VertexList;
+
+// Selects the set of non-overlapping records from a cluster of
+// vertices sorted by start coordinate, and writes them in that order.
+// Returns the number of records written.
+unsigned int processCluster(const VertexList& cluster, Sorter* sorter) {
+	// Calculate the overlaps between GFF intervals and make edges in
+	// the graph corresponding to the overlaps
+	util::interval::overlaps(cluster.begin(), cluster.end(),
+							 boost::make_function_output_iterator(OverlapRecorder()));
+
+	// Sort vertices by priority
+	VertexList byPriority(cluster);
+	std::stable_sort(byPriority.begin(), byPriority.end(), SorterPtr(sorter));
+
+	// Select the set of non-overlapping records by traversing
+	// priority-ordered vertex list
+	VertexList::iterator it;
+	for (it = byPriority.begin(); it != byPriority.end(); ++it) {
+		if (!(*it)->isProcessed()) {
+			(*it)->select();
+			(*it)->markProcessed();
+		}
+	}
+
+	// Write selected records to output in start order
+	unsigned int counter = 0;
+	VertexList::const_iterator cit;
+	for (cit = cluster.begin(); cit != cluster.end(); ++cit) {
+		if ((*cit)->isSelected()) {
+			std::cout << (*cit)->rec;
+			++counter;
+		}
+		delete *cit;
+	}
+	return counter;
+}
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
@@ -166,6 +216,8 @@ int main(int argc, const char* argv[]) {
 	bool verbose = false;
 	std::vector<char> sortList;
 	std::vector<std::string> sources;
+	size_t bufferSize = util::sort::DEFAULT_BUFFER_SIZE / (1024 * 1024);
+	std::string tempDir;
 	
 	util::options::Parser parser("< gffInput", "");
 	parser.addStoreOpt('f', "feature",
@@ -186,6 +238,14 @@ int main(int argc, const char* argv[]) {
 							 "source, as specified by the order of the "
 							 "source arguments",
 							 sortList, 's');
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use before spilling sorted "
+					   "runs to temporary files",
+					   bufferSize, "MB");
+	parser.addStoreOpt('T', "temp-dir",
+					   "directory for temporary files (default: $TMPDIR "
+					   "or /tmp)",
+					   tempDir, "DIR");
 	parser.addAppendArg("source", "", sources);
 	parser.parse(argv, argv + argc);
 
@@ -216,20 +276,25 @@ int main(int argc, const char* argv[]) {
 		}
 	}
 
-	// Read in the GFF records, creating GFF vertices only for those
-	// records that have the specified feature type
+	// Read in the GFF records of the specified feature type and sort
+	// them by start coordinate (necessary precondition for the overlap
+	// algorithm).  Records that do not fit in memory are sorted in
+	// temporary files.
 	if (verbose) {
-		std::cerr << "Reading GFF...\n";
+		std::cerr << "Reading and sorting GFF...\n";
 	}
-	typedef std::vector<GFFVertex*> VertexList;
-	VertexList vertices;
+	util::sort::ExternalSorter<bio::gff::GFFRecord, StartLessThan,
+							   bio::gff::GFFRecordSerializer>
+		recs(bufferSize * 1024 * 1024, tempDir);
+	unsigned int numRecs = 0;
 	try {
 		// Construct GFF stream for fast reading		
 		bio::gff::GFFInputStream gffStream(std::cin);
 		bio::gff::GFFRecord rec;
 		while (gffStream >> rec) {
 			if (feature.empty() || rec.getFeature() == feature) {
-				vertices.push_back(new GFFVertex(rec));
+				recs.push(rec);
+				++numRecs;
 			}
 		}
 	} catch (util::parser::FormatError& err) {
@@ -242,62 +307,35 @@ int main(int argc, const char* argv[]) {
 	// found
 	if (verbose) {
 		std::cerr << "Found "
-				  << vertices.size()
+				  << numRecs
 				  << (feature.empty() ? "" : " ")
 				  << (feature.empty() ? "" : feature)
 				  << " records\n";
 	}
 
-	// Sort the vertices by start coordinate (necessary precondition
-	// for the overlap algorithm)
-	if (verbose) {
-		std::cerr << "Sorting by start coordinate...\n";
-	}
-	std::sort(vertices.begin(), vertices.end(), StartSorter(nonsorter));
-
-	// Calculate the overlaps between GFF intervals and make edges in
-	// the graph corresponding to the overlaps
-	if (verbose) {
-		std::cerr << "Calculating overlaps...\n";
-	}
-	util::interval::overlaps(vertices.begin(), vertices.end(),
-							 boost::make_function_output_iterator(OverlapRecorder()));
-
-	// Sort vertices by priority
-	if (verbose) {
-		std::cerr << "Sorting by specified priorities...\n";
-	}
-	std::sort(vertices.begin(), vertices.end(), SorterPtr(sorter));
-
-	// Select the set of non-overlapping records by traversing
-	// priority-ordered vertex list
+	// Records can only overlap within a cluster of records whose
+	// intervals chain together, so select the non-overlapping records
+	// one cluster at a time, holding only the current cluster in memory
 	if (verbose) {
 		std::cerr << "Selecting set of non-overlapping records...\n";
 	}
-	VertexList::iterator it;
-	for (it = vertices.begin(); it != vertices.end(); ++it) {
-		if (!(*it)->isProcessed()) {
-			(*it)->select();
-			(*it)->markProcessed();
-		}
-	}
-
-	// Sort vertices by start coordinate before output
-	if (verbose) {
-		std::cerr << "Sorting by start coordinate...\n";
-	}
-	std::sort(vertices.begin(), vertices.end(), StartSorter(nonsorter));
-
-	// Write selected records to output
-	if (verbose) {
-		std::cerr << "Writing GFF...\n";
-	}
 	unsigned int counter = 0;
-	for (it = vertices.begin(); it != vertices.end(); ++it) {
-		if ((*it)->isSelected()) {
-			std::cout << (*it)->rec;
-			++counter;
+	VertexList cluster;
+	GenomicCoord clusterEnd("", 0);
+	bio::gff::GFFRecord rec;
+	while (recs.next(rec)) {
+		GFFVertex* v = new GFFVertex(rec);
+		if (!cluster.empty() && !(v->start() < clusterEnd)) {
+			counter += processCluster(cluster, sorter);
+			cluster.clear();
+		}
+		if (cluster.empty() || clusterEnd < v->end()) {
+			clusterEnd = v->end();
 		}
+		cluster.push_back(v);
+	}
+	if (!cluster.empty()) {
+		counter += processCluster(cluster, sorter);
 	}
 
 	// Note how many records were output
@@ -22,11 +22,49 @@
 
 #include "bio/gff/GFFRecord.hh"
 #include "bio/gff/GFFInputStream.hh"
+#include "bio/gff/GFFTable.hh"
 #include "util/parser.hh"
-#include "boost/unordered_map.hpp"
+#include "boost/unordered_set.hpp"
 #include "util/options.hh"
 #include "filesystem/Path.hh"
 
+using bio::gff::GFFTable;
+
+// Writes a batch of records to the files for their field values, one
+// file at a time.  Files written by an earlier batch are appended to.
+void writeBatch(const GFFTable& table,
+				GFFTable::Column column,
+				const filesystem::Path& outDir,
+				boost::unordered_set<std::string>& written) {
+	GFFTable::RowList rows;
+	std::vector<size_t> groupStarts;
+	table.getRows(rows);
+	table.groupBy(rows, column, groupStarts);
+
+	for (size_t g = 0; g + 1 < groupStarts.size(); ++g) {
+		GFFTable::Row first = rows[groupStarts[g]];
+		const std::string& field = table.getName(column,
+												 table.getId(column, first));
+
+		// Output records that do not have the field on standard out
+		std::ofstream outFile;
+		std::ostream* out = &std::cout;
+		if (field != ".") {
+			filesystem::Path path = outDir / (field + ".gff");
+			if (written.insert(field).second) {
+				path.openForOutput(outFile);
+			} else {
+				path.openForOutput(outFile, std::ios::app);
+			}
+			out = &outFile;
+		}
+
+		for (size_t i = groupStarts[g]; i < groupStarts[g + 1]; ++i) {
+			table.write(*out, rows[i]);
+		}
+	}
+}
+
 int main(int argc, const char** argv) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
@@ -36,6 +74,7 @@ int main(int argc, const char** argv) {
 	bool bySource = false;
 	bool byFeature = false;
 	std::string outdir = ".";
+	size_t bufferSize = 256;
 	
 	// Set up options
 	util::options::Parser parser("< gffInput", "");
@@ -51,6 +90,10 @@ int main(int argc, const char** argv) {
 	parser.addStoreOpt('o', "outdir", 
 					   "directory to output split gff files",
 					   outdir, "DIR");
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use for buffering records "
+					   "before writing them out",
+					   bufferSize, "MB");
 	parser.parse(argv, argv + argc);
 
 	// Use source as default field on which to split
@@ -70,9 +113,14 @@ int main(int argc, const char** argv) {
 		return EXIT_FAILURE;
 	}
 	
-	// Make a map from field values to files for records with that field value
-	typedef boost::unordered_map<std::string, std::ofstream*> FileMap;
-	FileMap files;
+	GFFTable::Column column = (bySeqname ? GFFTable::SEQNAME :
+							   bySource ? GFFTable::SOURCE :
+							   GFFTable::FEATURE);
+
+	// Buffer records in a table and write them out grouped by field
+	// value, so that only one output file is open at a time
+	GFFTable table;
+	boost::unordered_set<std::string> written;
 	
 	try {
 		// Construct GFF stream for fast reading
@@ -80,44 +128,15 @@ int main(int argc, const char** argv) {
 
 		bio::gff::GFFRecord rec;
 		while (gffStream >> rec) {
-
-			// Extract the appropriate field
-			std::string field;
-			if (bySeqname) {
-				field = rec.getSeqname();
-			} else if (bySource) {
-				field = rec.getSource();
-			} else { // byFeature
-				field = rec.getFeature();
-			}
-
-			// Output records that do not have the field on standard out
-			if (field == ".") {
-				std::cout << rec;
-				continue;
+			table.push_back(rec);
+			if (table.memoryUsage() >= bufferSize * 1024 * 1024) {
+				writeBatch(table, column, outDir, written);
+				table.clear();
 			}
-
-			// Get the file for this field.  Create a new file if no
-			// file has been opened for this field value
-			std::ofstream* outFile;			
-			FileMap::iterator pos = files.find(field);
-			if (pos == files.end()) {
-				outFile = new std::ofstream();
-				(outDir / (field + ".gff")).openForOutput(*outFile);
-				pos = files.insert(std::make_pair(field, outFile)).first;
-			} else {
-				outFile = pos->second;
-			}
-
-			// Send this record to the appropriate file
-			(*outFile) << rec;
 		}
 	} catch (util::parser::FormatError& e) {
 		std::cerr << e.getProblem() << '\n' << e.getLine() << '\n';
 	}
 
-	// Close all of the opened files
-	for (FileMap::iterator pos = files.begin(); pos != files.end(); ++pos) {
-		delete pos->second;
-	}
+	writeBatch(table, column, outDir, written);
 }
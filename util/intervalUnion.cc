@@ -20,64 +20,98 @@
 #include <iostream>
 
 #include "util/options.hh"
+#include "util/sort.hh"
 #include "bio/genome/BasicInterval.hh"
 using namespace bio::genome;
 
-typedef std::vector<BasicInterval> IntervalList;
+// Writes intervals to temporary sort files in the input format
+struct IntervalSerializer {
+	void write(std::ostream& stream, const BasicInterval& i) const {
+		writeInterval(stream, i);
+	}
 
-void readIntervals(std::istream& stream,
-				   IntervalList& fIntervals,
-				   IntervalList& rIntervals) {
-	std::string chrom;
-	Position start, end;
-	Strand strand;
-	while (stream >> chrom >> start >> end >> strand) {
-		BasicInterval i(chrom, start, end, strand);
-		if (strand.isForward()) {
-			fIntervals.push_back(i);
-		} else {
-			rIntervals.push_back(i);
+	bool read(std::istream& stream, BasicInterval& i) const {
+		std::string chrom;
+		Position start, end;
+		Strand strand;
+		if (stream >> chrom >> start >> end >> strand) {
+			i = BasicInterval(chrom, start, end, strand);
+			return true;
 		}
+		return false;
 	}
-}
 
-void writeIntervals(std::ostream& stream,
-					IntervalList& intervals) {
-	for (size_t i = 0; i < intervals.size(); ++i) {
-		BasicInterval& in = intervals[i];
-		stream << in.getChrom() << '\t'
-			   << in.getStart() << '\t'
-			   << in.getEnd() << '\t'
-			   << in.getStrand() << '\n';
+	size_t size(const BasicInterval& i) const {
+		return sizeof(i) + i.getChrom().size();
 	}
-}
 
-void unionIntervals(IntervalList& intervals) {
-	sort(intervals.begin(), intervals.end());
-	
-	IntervalList::iterator prev(intervals.begin()), next(intervals.begin());
-	while (next != intervals.end()) {
-		if (prev->overlaps(*next)) {
-			*prev |= *next;
+	static void writeInterval(std::ostream& stream, const BasicInterval& i) {
+		stream << i.getChrom() << '\t'
+			   << i.getStart() << '\t'
+			   << i.getEnd() << '\t'
+			   << i.getStrand() << '\n';
+	}
+};
+
+typedef util::sort::ExternalSorter<BasicInterval,
+								   std::less<BasicInterval>,
+								   IntervalSerializer> IntervalSorter;
+
+void readIntervals(std::istream& stream,
+				   IntervalSorter& fIntervals,
+				   IntervalSorter& rIntervals) {
+	IntervalSerializer serializer;
+	BasicInterval i;
+	while (serializer.read(stream, i)) {
+		if (i.getStrand().isForward()) {
+			fIntervals.push(i);
 		} else {
-			++prev;
-			*prev = *next;
+			rIntervals.push(i);
 		}
-		++next;
 	}
+}
+
+// Returns the union of the sorted intervals of a sorter, one maximal
+// interval at a time
+class UnionReader {
+public:
+	UnionReader(IntervalSorter& sorter)
+		: sorter(sorter), hasPending(sorter.next(pending)) {}
 
-	if (prev != intervals.end()) {
-		++prev;
-		intervals.erase(prev, intervals.end());
+	bool next(BasicInterval& i) {
+		if (not hasPending) {
+			return false;
+		}
+		i = pending;
+		while ((hasPending = sorter.next(pending)) and i.overlaps(pending)) {
+			i |= pending;
+		}
+		return true;
 	}
-}
 
-void mergeIntervals(IntervalList& fIntervals,
-					IntervalList& rIntervals,
-					IntervalList& intervals) {
-	std::merge(fIntervals.begin(), fIntervals.end(),
-			   rIntervals.begin(), rIntervals.end(),
-			   std::back_inserter(intervals));
+private:
+	IntervalSorter& sorter;
+	BasicInterval pending;
+	bool hasPending;
+};
+
+// Merges the unions of the forward and reverse strand intervals into
+// one sorted stream
+void writeUnion(std::ostream& stream,
+				IntervalSorter& fIntervals,
+				IntervalSorter& rIntervals) {
+	UnionReader fUnion(fIntervals), rUnion(rIntervals);
+	BasicInterval f, r;
+	bool hasF = fUnion.next(f), hasR = rUnion.next(r);
+	while (hasF or hasR) {
+		if (hasR and (not hasF or r < f)) {
+			IntervalSerializer::writeInterval(stream, r);
+			hasR = rUnion.next(r);
+		} else {
+			IntervalSerializer::writeInterval(stream, f);
+			hasF = fUnion.next(f);
+		}
+	}
 }
 
 int main(int argc, const char* argv[]) {
@@ -85,21 +119,28 @@ int main(int argc, const char* argv[]) {
 	std::ios::sync_with_stdio(false);
 
 	// Initialize options to defaults
+	size_t bufferSize = util::sort::DEFAULT_BUFFER_SIZE / (1024 * 1024);
+	std::string tempDir;
 
 	util::options::Parser parser("< intervals", "> union_intervals");
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use before spilling sorted "
+					   "runs to temporary files",
+					   bufferSize, "MB");
+	parser.addStoreOpt('T', "temp-dir",
+					   "directory for temporary files (default: $TMPDIR "
+					   "or /tmp)",
+					   tempDir, "DIR");
 	parser.parse(argv, argv + argc);
 
 	try {
-		IntervalList fIntervals, rIntervals, intervals;
+		// Each strand gets half of the buffer
+		IntervalSorter fIntervals(bufferSize * 1024 * 1024 / 2, tempDir);
+		IntervalSorter rIntervals(bufferSize * 1024 * 1024 / 2, tempDir);
 
 		readIntervals(std::cin, fIntervals, rIntervals);
-		
-		unionIntervals(fIntervals);
-		unionIntervals(rIntervals);
-
-		mergeIntervals(fIntervals, rIntervals, intervals);
 
-		writeIntervals(std::cout, intervals);
+		writeUnion(std::cout, fIntervals, rIntervals);
 
 	} catch (const std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
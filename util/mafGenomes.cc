@@ -35,7 +35,8 @@ int main(int argc, const char* argv[]) {
 	parser.parse(argv, argv + argc);
 
 	try {
-		maf::InputStream input_stream(std::cin);
+		// Only sequence names are needed, so alignment text is read lazily
+		maf::InputStream input_stream(std::cin, true);
         boost::unordered_set<std::string> genomes;
 		
 		maf::Record rec;
@@ -0,0 +1,186 @@
+/* Copyright (c) 2006
+   Colin Dewey (University of Wisconsin-Madison)
+   cdewey@biostat.wisc.edu
+   
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boost/random/mersenne_twister.hpp"
+#include "boost/random/uniform_int.hpp"
+#include "boost/random/variate_generator.hpp"
+#include "boost/timer.hpp"
+
+#include "bio/formats/maf.hh"
+#include "util/io/line/InputStream.hh"
+#include "util/options.hh"
+#include "util/string.hh"
+
+typedef boost::mt19937 base_generator_type;
+typedef boost::uniform_int<long> distribution_type;
+typedef boost::variate_generator<base_generator_type&,
+								 distribution_type> variate_generator_type;
+
+const std::string USAGE = "";
+
+const std::string DESCRIPTION =
+	"Times reading MAF records with the eager and lazy InputStream modes "
+	"against the previous istringstream-based sequence line parser";
+
+// The previous way of parsing sequence lines: a new Sequence and an
+// istringstream for every line
+size_t legacyRead(const std::string& maf) {
+	std::istringstream in(maf);
+	util::io::line::InputStream strm(in);
+	std::string line;
+	size_t numBlocks = 0;
+	std::vector<bio::formats::maf::Sequence> sequences;
+	while (strm >> line) {
+		if (not util::string::startsWith(line, "a")) {
+			continue;
+		}
+		sequences.clear();
+		while (strm >> line) {
+			if (line.empty()) { break; }
+			if (not util::string::startsWith(line, "s")) { continue; }
+			sequences.push_back(bio::formats::maf::Sequence());
+			bio::formats::maf::Sequence& seq = sequences.back();
+			std::istringstream seqStream(line.substr(1));
+			seqStream >> seq.src >> seq.start >> seq.size >> seq.strand
+					  >> seq.srcSize >> seq.getText();
+			if (not seqStream) {
+				throw std::runtime_error("Invalid MAF sequence line:\n" + line);
+			}
+		}
+		++numBlocks;
+	}
+	return numBlocks;
+}
+
+size_t read(const std::string& maf, bool lazyText) {
+	std::istringstream in(maf);
+	bio::formats::maf::InputStream strm(in, lazyText);
+	bio::formats::maf::Record rec;
+	size_t numBlocks = 0;
+	while (strm >> rec) {
+		++numBlocks;
+	}
+	return numBlocks;
+}
+
+// Generates blocks of random alignment columns between numSpecies
+// genomes, with occasional gaps
+void generateMAF(size_t numBlocks,
+				 size_t numSpecies,
+				 size_t blockLength,
+				 base_generator_type::result_type seed,
+				 std::ostream& maf) {
+	static const char CHARS[] = "ACGTACGTACGT-";
+	base_generator_type generator(seed);
+	variate_generator_type randChar(generator, distribution_type(0, 12));
+	variate_generator_type randGap(generator, distribution_type(1, 100));
+
+	maf << "##maf version=1 scoring=none\n# synthetic\n";
+	std::vector<long> positions(numSpecies, 0);
+	std::string text;
+	for (size_t b = 0; b < numBlocks; ++b) {
+		maf << "\na score=0\n";
+		for (size_t s = 0; s < numSpecies; ++s) {
+			text.clear();
+			size_t size = 0;
+			for (size_t c = 0; c < blockLength; ++c) {
+				char ch = CHARS[randChar()];
+				text += ch;
+				size += (ch != '-');
+			}
+			maf << "s species" << s << ".chr1 " << positions[s] << ' '
+				<< size << " + 1000000000 " << text << '\n';
+			positions[s] += size + randGap();
+		}
+	}
+}
+
+void report(const std::string& name, size_t numBlocks, size_t numBytes,
+			double seconds) {
+	std::cerr << name << ": " << seconds << " s, "
+			  << (seconds > 0 ? numBlocks / seconds : 0) << " blocks/s, "
+			  << (seconds > 0 ? numBytes / seconds / (1024 * 1024) : 0)
+			  << " MB/s\n";
+}
+
+int main(int argc, const char* argv[]) {
+	// Increase speed of input/output to standard streams
+	std::ios::sync_with_stdio(false);
+
+	// Initialize options to defaults
+	size_t numBlocks = 100000;
+	size_t numSpecies = 10;
+	size_t blockLength = 100;
+	std::string inputFile;
+	base_generator_type::result_type seed = 1;
+
+	util::options::Parser parser(USAGE, DESCRIPTION);
+	parser.addStoreOpt(0, "blocks", "number of alignment blocks", numBlocks);
+	parser.addStoreOpt(0, "species", "number of sequences per block",
+					   numSpecies);
+	parser.addStoreOpt(0, "length", "number of columns per block",
+					   blockLength);
+	parser.addStoreOpt('i', "input",
+					   "MAF file to read instead of a synthetic one",
+					   inputFile, "FILE");
+	parser.addStoreOpt('s', "seed", "Seed for random number generator",
+					   seed, "INTEGER");
+	parser.parse(argv, argv + argc);
+
+	try {
+		std::ostringstream maf;
+		if (inputFile.empty()) {
+			generateMAF(numBlocks, numSpecies, blockLength, seed, maf);
+		} else {
+			std::ifstream in(inputFile.c_str());
+			if (not in) {
+				throw std::runtime_error("Could not open " + inputFile);
+			}
+			maf << in.rdbuf();
+		}
+		const std::string mafText = maf.str();
+
+		boost::timer timer;
+		size_t legacyBlocks = legacyRead(mafText);
+		report("legacy", legacyBlocks, mafText.size(), timer.elapsed());
+
+		timer.restart();
+		size_t eagerBlocks = read(mafText, false);
+		report("eager", eagerBlocks, mafText.size(), timer.elapsed());
+
+		timer.restart();
+		size_t lazyBlocks = read(mafText, true);
+		report("lazy", lazyBlocks, mafText.size(), timer.elapsed());
+
+		if (eagerBlocks != legacyBlocks or lazyBlocks != legacyBlocks) {
+			throw std::runtime_error("Readers disagree on number of blocks");
+		}
+	} catch (const std::runtime_error& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
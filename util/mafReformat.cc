@@ -33,7 +33,7 @@ int main(int argc, const char* argv[]) {
 	util::options::Parser parser("< mafInput", "Reformat MAF input");
 	parser.parse(argv, argv + argc);
 
-	bio::formats::maf::InputStream inputStream(std::cin);
+	bio::formats::maf::InputStream inputStream(std::cin, true);
 	bio::formats::maf::OutputStream outputStream(std::cout,
 												 inputStream.getHeader());
 
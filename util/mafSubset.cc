@@ -20,9 +20,12 @@
 #include <iostream>
 
 #include "bio/formats/maf.hh"
+#include "bio/genome/BasicInterval.hh"
 #include "boost/unordered_set.hpp"
 #include "util/options.hh"
+#include "filesystem.hh"
 using namespace bio::formats;
+using namespace filesystem;
 
 struct SequenceSelector {
 	SequenceSelector(std::vector<std::string>& keep)
@@ -37,7 +40,7 @@ struct SequenceSelector {
 
 bool is_all_gap_column(std::vector<maf::Sequence>& seqs, size_t col) {
 	for (size_t i = 0; i < seqs.size(); ++i) {
-		if (seqs[i].text[col] != '-') { return false; }
+		if (seqs[i].getText()[col] != '-') { return false; }
 	}
 	return true;
 }
@@ -45,14 +48,15 @@ bool is_all_gap_column(std::vector<maf::Sequence>& seqs, size_t col) {
 void copy_column(std::vector<maf::Sequence>& seqs,
 				 size_t source, size_t target) {
 	for (size_t i = 0; i < seqs.size(); ++i) {
-		seqs[i].text[target] = seqs[i].text[source];
+		std::string& s = seqs[i].getText();
+		s[target] = s[source];
 	}
 }
 
 void erase_columns(std::vector<maf::Sequence>& seqs,
 				   size_t start, size_t end) {
 	for (size_t i = 0; i < seqs.size(); ++i) {
-		std::string& s = seqs[i].text;
+		std::string& s = seqs[i].getText();
 		s.erase(s.begin() + start, s.begin() + end);
 	}
 }
@@ -61,43 +65,121 @@ void remove_gap_columns(std::vector<maf::Sequence>& seqs) {
 	if (seqs.empty()) { return; }
 	size_t next = 0;
 	size_t curr = 0;
-	while (curr < seqs.front().text.size()) {
+	while (curr < seqs.front().getTextSize()) {
 		if (not is_all_gap_column(seqs, curr)) {
 			copy_column(seqs, curr, next);
 			++next;
 		}
 		++curr;
 	}
-	erase_columns(seqs, next, seqs.front().text.size());
+	erase_columns(seqs, next, seqs.front().getTextSize());
 }
 
+// Keeps the sequences of the selected genomes in each block, dropping
+// blocks left with fewer than two sequences.  Alignment text is read
+// lazily, so that only the text of kept sequences is copied.
+class SubsetTransform : public maf::Pipeline::Transform {
+public:
+	SubsetTransform(std::vector<std::string>& genomes) : selector(genomes) {}
+
+	bool operator()(maf::Record& rec) const {
+		rec.sequences.erase(std::remove_if(rec.sequences.begin(),
+										   rec.sequences.end(),
+										   selector),
+							rec.sequences.end());
+		if (rec.sequences.size() < 2) {
+			return false;
+		}
+		remove_gap_columns(rec.sequences);
+		return true;
+	}
+
+private:
+	SequenceSelector selector;
+};
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
 
 	// Initialize options to defaults
 	std::vector<std::string> genomes;
+	std::string mafFilename;
+	std::string regionsFilename;
+	std::string indexFilename;
+	size_t numThreads = 1;
 	
 	// Parse command line
 	util::options::Parser parser("< mafInput", "Extract subset of MAF "
 								 "containing specified genomes");
+	parser.addStoreOpt('m', "maf",
+					   "read MAF from FILE instead of standard input",
+					   mafFilename, "FILE");
+	parser.addStoreOpt('r', "regions",
+					   "only extract blocks overlapping the regions in FILE, "
+					   "given as \"src start end\" lines with zero-based, "
+					   "half-open coordinates (requires --maf)",
+					   regionsFilename, "FILE");
+	parser.addStoreOpt('i', "index",
+					   "index of the --maf file made by mafIndex (default: "
+					   "the MAF filename with .idx appended, or an index "
+					   "built by reading the MAF if there is none)",
+					   indexFilename, "FILE");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to process blocks with when not "
+					   "extracting regions (0 for one per processor)",
+					   numThreads, "NUM");
 	parser.addAppendArg("genome", "Name of genome to keep in MAF", genomes);
 	parser.parse(argv, argv + argc);
 
 	try {
-		maf::InputStream input_stream(std::cin);
-		maf::OutputStream output_stream(std::cout, input_stream.getHeader());
+		if (not regionsFilename.empty() and mafFilename.empty()) {
+			throw std::runtime_error("--regions requires --maf");
+		}
+
+		InputFileStream mafFile;
+		std::istream* mafStream = &std::cin;
+		if (not mafFilename.empty()) {
+			mafFile.open(mafFilename);
+			mafStream = &mafFile;
+		}
+
+		SubsetTransform transform(genomes);
+
+		if (regionsFilename.empty()) {
+			maf::Pipeline pipeline(numThreads, true);
+			pipeline.run(*mafStream, std::cout, transform);
+			return EXIT_SUCCESS;
+		}
+
+		// Load or build the index for region extraction
+		if (indexFilename.empty() and Path(mafFilename + ".idx").exists()) {
+			indexFilename = mafFilename + ".idx";
+		}
+		maf::Index index;
+		if (indexFilename.empty()) {
+			index.build(mafFile);
+			mafFile.clear();
+			mafFile.seekg(0);
+		} else {
+			InputFileStream indexFile(indexFilename);
+			index.read(indexFile);
+		}
+
+		maf::IndexedReader reader(mafFile, index, true);
+
+		InputFileStream regionsFile(regionsFilename);
+		std::string src;
+		bio::genome::Position start, end;
+		while (regionsFile >> src >> start >> end) {
+			reader.addRegion(bio::genome::BasicInterval(src, start, end));
+		}
+
+		maf::OutputStream output_stream(std::cout, reader.getHeader());
 
-		SequenceSelector selector(genomes);
-		
 		maf::Record rec;
-		while (input_stream >> rec) {
-			rec.sequences.erase(std::remove_if(rec.sequences.begin(),
-											   rec.sequences.end(),
-											   selector),
-								rec.sequences.end());
-			if (rec.sequences.size() >= 2) {
-				remove_gap_columns(rec.sequences);
+		while (reader.next(rec)) {
+			if (transform(rec)) {
 				output_stream << rec;
 			}
 		}
@@ -27,15 +27,46 @@
 using namespace filesystem;
 using util::string::toString;
 
+// Lifts the sequences of each block through an AGP.  The mapper is
+// only read, so one mapper is shared by all threads.
+class LiftTransform : public bio::formats::maf::Pipeline::Transform {
+public:
+	LiftTransform(bio::agp::AGPForwardMapper& mapper) : mapper(mapper) {}
+
+	bool operator()(bio::formats::maf::Record& rec) const {
+		std::vector<bio::genome::BasicInterval> mapping;
+		for (size_t i = 0; i < rec.sequences.size(); ++i) {
+			bio::formats::maf::Sequence& seq = rec.sequences[i];
+			mapping.clear();
+			mapper.map(seq, mapping);
+			if (mapping.size() != 1) {
+				throw std::runtime_error("Could not map interval: " +
+										 toString(seq));
+			}
+			seq.srcSize = mapper.getChromSize(mapping.front().getChrom());
+			seq.setInterval(mapping.front());
+		}
+		return true;
+	}
+
+private:
+	bio::agp::AGPForwardMapper& mapper;
+};
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
 
 	// Initialize options to defaults
 	std::string agpFilename;
+	size_t numThreads = 1;
 	
 	// Parse command line
 	util::options::Parser parser("< mafInput", "Transform MAF input");
+	parser.addStoreOpt('t', "threads",
+					   "number of threads to process blocks with "
+					   "(0 for one per processor)",
+					   numThreads, "NUM");
 	parser.addStoreArg("agpFile", "", agpFilename);
 	parser.parse(argv, argv + argc);
 
@@ -43,29 +74,9 @@ int main(int argc, const char* argv[]) {
 		InputFileStream agpFile(agpFilename);
 		bio::agp::AGPForwardMapper mapper(agpFile);
 
-		bio::formats::maf::InputStream inputStream(std::cin);
-		bio::formats::maf::OutputStream outputStream(std::cout,
-													 inputStream.getHeader());
-		
-		std::vector<bio::genome::BasicInterval> mapping;
-
-		bio::formats::maf::Record rec;
-		while (inputStream >> rec) {
-			for (size_t i = 0; i < rec.sequences.size(); ++i) {
-				bio::formats::maf::Sequence& seq = rec.sequences[i];
-				mapping.clear();
-				mapper.map(seq, mapping);
-				if (mapping.size() != 1) {
-					throw std::runtime_error("Could not map interval: " +
-											 toString(seq));
-				}
-				seq.srcSize = mapper.getChromSize(mapping.front().getChrom());
-				seq.setInterval(mapping.front());
-			}
-
-			outputStream << rec;
-		}
-
+		// Alignment text is passed through unchanged, so it is read lazily
+		bio::formats::maf::Pipeline pipeline(numThreads, true);
+		pipeline.run(std::cin, std::cout, LiftTransform(mapper));
 	} catch (const std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
 		return EXIT_FAILURE;
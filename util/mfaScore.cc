@@ -20,7 +20,6 @@
 #include <iostream>
 
 #include "bio/alignment/BasicNamedMultipleAlignment.hh"
-#include "bio/alignment/AffineGapPairwiseAlignmentScorer.hh"
 #include "bio/alignment/SumOfPairsScorer.hh"
 #include "bio/alignment/AlphabetScoringMatrix.hh"
 #include "bio/alignment/AmbiguousDNAScoringMatrix.hh"
@@ -30,6 +29,7 @@
 #include "bio/formats/fasta.hh"
 #include "filesystem.hh"
 #include "util/options.hh"
+#include "util/thread.hh"
 
 using namespace bio::alignment;
 using namespace bio::formats;
@@ -37,6 +37,29 @@ using namespace filesystem;
 
 typedef long long Score;
 
+// Reads and scores one multiple alignment file
+class ScoreTask : public util::thread::Task {
+public:
+	ScoreTask(const SumOfPairsScorer<Score>& scorer,
+			  const std::string& filename,
+			  Score& score)
+		: scorer(scorer), filename(filename), score(score) {
+	}
+
+	void run() {
+		InputFileStream file(filename);
+		fasta::InputStream fastaStream(file);
+		BasicNamedMultipleAlignment ma;
+		fastaStream >> ma;
+		score = scorer.score(ma);
+	}
+
+private:
+	const SumOfPairsScorer<Score>& scorer;
+	std::string filename;
+	Score& score;
+};
+
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
@@ -51,6 +74,7 @@ int main(int argc, const char* argv[]) {
 	Score gap = -400;
 	bool protein = false;
 	std::string scoringMatrixFilename;
+	size_t numThreads = 1;
 	std::vector<std::string> filenames;
 
 	// Parse command line
@@ -70,6 +94,10 @@ int main(int argc, const char* argv[]) {
 						   "show the total score as the last line", showTotal);
 	parser.addStoreTrueOpt(0, "only-total",
 						   "only show the total score", onlyTotal);
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for scoring alignment files "
+					   "(0 for one per processor)",
+					   numThreads, "NUM");
 	parser.addAppendArg("mfaFile",
 						"multiple alignment file",
 						filenames);
@@ -101,23 +129,24 @@ int main(int argc, const char* argv[]) {
 			matrix = new AmbiguousDNAScoringMatrix<Score>(dnaMatrix);
 		}
 
-		AffineGapPairwiseAlignmentScorer<Score> pairwiseScorer(*matrix,
-															   space, gap);
-		SumOfPairsScorer<Score> scorer(pairwiseScorer);
+		SumOfPairsScorer<Score> scorer(*matrix, space, gap);
+
+		// Score the files in parallel and report them in their given order
+		std::vector<Score> scores(filenames.size());
+		util::thread::ThreadPool pool(numThreads);
+		for (size_t i = 0; i < filenames.size(); ++i) {
+			pool.add(new ScoreTask(scorer, filenames[i], scores[i]));
+		}
+		pool.wait();
 
 		Score totalScore = 0;
 		for (size_t i = 0; i < filenames.size(); ++i) {
-			InputFileStream file(filenames[i]);
-			fasta::InputStream fastaStream(file);
-			BasicNamedMultipleAlignment ma;
-			fastaStream >> ma;
-			Score score = scorer.score(ma);
-			totalScore += score;
+			totalScore += scores[i];
 			if (not onlyTotal) {
 				if (showFilenames) {
 					std::cout << filenames[i] << '\t';
 				}
-				std::cout << score << std::endl;
+				std::cout << scores[i] << '\n';
 			}
 		}
 
@@ -24,9 +24,9 @@
 #include "bio/genome/Interval.hh"
 #include "util/io/line/InputStream.hh"
 #include "util/interval.hh"
+#include "util/sort.hh"
 #include "filesystem.hh"
 #include "boost/function_output_iterator.hpp"
-#include "boost/shared_ptr.hpp"
 
 using namespace bio;
 using namespace filesystem;
@@ -43,68 +43,89 @@ struct IntervalLineTraits {
 	static coord_type end(const IntervalLine& x) { return x.end; }
 };
 
-class IntervalLineIterator {
-public:
-	typedef IntervalLine value_type;
-		
-	IntervalLineIterator() :
-		lineStream(),
-		valid(false) {
+struct IntervalLineLessThan {
+	bool operator()(const IntervalLine& x, const IntervalLine& y) const {
+		return x.start < y.start;
 	}
+};
 
-	IntervalLineIterator(std::istream& stream,
-						 const std::vector<size_t>& indices) :
-		lineStream(new util::io::line::InputStream(stream)),
+// Parses the interval fields of a tab-delimited line
+class IntervalLineParser {
+public:
+	IntervalLineParser(const std::vector<size_t>& indices) :
 		contigIndex(indices[0]),
 		startIndex(indices[1]),
-		endIndex(indices[2]),
-		valid(true) {
-		++(*this);
+		endIndex(indices[2]) {
 	}
 
-	IntervalLine& operator*() {
-		return intervalLine;
+	void parse(const std::string& line, IntervalLine& intervalLine) {
+		intervalLine.line = line;
+		fields.clear();
+		util::string::split(line, std::back_inserter(fields), "\t");
+		util::string::Converter<genome::Position> toGenomePosition;
+		intervalLine.start = genome::Coord(fields[contigIndex],
+										   toGenomePosition(fields[startIndex]));
+		intervalLine.end = genome::Coord(fields[contigIndex],
+										 toGenomePosition(fields[endIndex]));
 	}
 
-	IntervalLineIterator& operator++() {
-		assert(lineStream != NULL);
-		(*lineStream) >> line;
-		valid = (*lineStream);
-		if (valid) {
-			intervalLine.line = line;
-			fields.clear();
-			util::string::split(line, std::back_inserter(fields), "\t");
-			util::string::Converter<genome::Position> toGenomePosition;
-			intervalLine.start = genome::Coord(fields[contigIndex],
-											   toGenomePosition(fields[startIndex]));
-			intervalLine.end = genome::Coord(fields[contigIndex],
-											 toGenomePosition(fields[endIndex]));
-		}
-		return *this;
+	// Serializer interface for sorting interval lines externally
+	void write(std::ostream& strm, const IntervalLine& x) const {
+		strm << x.line << '\n';
 	}
 
-	bool operator==(const IntervalLineIterator& x) const {
-		return ((not valid and not x.valid) or
-				(valid and x.valid and lineStream == x.lineStream));
+	bool read(std::istream& strm, IntervalLine& x) {
+		if (not std::getline(strm, line)) {
+			return false;
+		}
+		parse(line, x);
+		return true;
 	}
 
-	bool operator!=(const IntervalLineIterator& x) const {
-		return not (*this == x);
+	size_t size(const IntervalLine& x) const {
+		return sizeof(IntervalLine) + x.line.capacity()
+			+ x.start.chrom.capacity() + x.end.chrom.capacity();
 	}
-	
+
 private:
-	typedef boost::shared_ptr<util::io::line::InputStream> LineStreamPtr;
-	
-	LineStreamPtr lineStream;
 	size_t contigIndex;
 	size_t startIndex;
 	size_t endIndex;
-	IntervalLine intervalLine;
-	bool valid;
 	std::string line;
 	std::vector<std::string> fields;
 };
 
+class IntervalLineInputStream {
+public:
+	IntervalLineInputStream(std::istream& stream,
+							const std::vector<size_t>& indices) :
+		lineStream(stream),
+		parser(indices) {
+	}
+
+	IntervalLineInputStream& operator>>(IntervalLine& intervalLine) {
+		if (lineStream >> line) {
+			parser.parse(line, intervalLine);
+		}
+		return *this;
+	}
+
+	operator bool() { return lineStream; }
+	bool operator!() { return !lineStream; }
+	
+private:
+	util::io::line::InputStream lineStream;
+	IntervalLineParser parser;
+	std::string line;
+};
+
+typedef util::sort::SortedReader<IntervalLine,
+								 IntervalLineInputStream,
+								 IntervalLineLessThan,
+								 IntervalLineParser> SortedIntervalLineReader;
+typedef util::sort::ReaderIterator<SortedIntervalLineReader,
+								   IntervalLine> IntervalLineIterator;
+
 std::vector<size_t> parse_field_indices(const std::string& s) {
 	std::vector<std::string> string_indices;
 	util::string::split(s, std::back_inserter(string_indices), ",");
@@ -127,6 +148,9 @@ int main(int argc, const char* argv[]) {
 	std::ios::sync_with_stdio(false);
 
 	// Initialize options to defaults
+	bool sorted = false;
+	size_t bufferSize = util::sort::DEFAULT_BUFFER_SIZE / (1024 * 1024);
+	std::string tempDir;
 	std::string fields1 = "1,2,3";
 	std::string fields2 = "1,2,3";
 	std::string filename1;
@@ -140,6 +164,18 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreOpt('2', "",
 					   "Interval fields for the second file",
 					   fields2);
+	parser.addStoreTrueOpt('s', "sorted",
+						   "input files are already sorted by interval "
+						   "start, so they are streamed without sorting",
+						   sorted);
+	parser.addStoreOpt('S', "buffer-size",
+					   "approximate memory to use for sorting unsorted "
+					   "input before spilling to temporary files",
+					   bufferSize, "MB");
+	parser.addStoreOpt('T', "temp-dir",
+					   "directory for temporary files (default: $TMPDIR "
+					   "or /tmp)",
+					   tempDir, "DIR");
 	parser.addStoreArg("file1", "File 1", filename1);
 	parser.addStoreArg("file1", "File 2", filename2);
 	parser.parse(argv, argv + argc);
@@ -151,8 +187,19 @@ int main(int argc, const char* argv[]) {
 		InputFileStream file1(filename1);
 		InputFileStream file2(filename2);
 		
-		IntervalLineIterator lineIterator1(file1, indices1);
-		IntervalLineIterator lineIterator2(file2, indices2);
+		IntervalLineInputStream lineStream1(file1, indices1);
+		IntervalLineInputStream lineStream2(file2, indices2);
+		SortedIntervalLineReader reader1(lineStream1, sorted,
+										 bufferSize * 1024 * 1024, tempDir, 1,
+										 IntervalLineLessThan(),
+										 IntervalLineParser(indices1));
+		SortedIntervalLineReader reader2(lineStream2, sorted,
+										 bufferSize * 1024 * 1024, tempDir, 1,
+										 IntervalLineLessThan(),
+										 IntervalLineParser(indices2));
+
+		IntervalLineIterator lineIterator1(reader1);
+		IntervalLineIterator lineIterator2(reader2);
 		IntervalLineIterator endLineIterator;
 		
 		util::interval::overlaps(lineIterator1, endLineIterator,
@@ -19,28 +19,21 @@
 
 #include <iostream>
 #include <stdexcept>
-#include <map>
-#include <vector>
 
 #include "bio/formats/agp/Record.hh"
 #include "bio/formats/agp/InputStream.hh"
-#include "bio/alphabet/Nucleotide.hh"
+#include "bio/formats/agp/Assembler.hh"
 #include "bio/sdb.hh"
 #include "util/options.hh"
 using namespace bio::formats;
 
-struct AGPContigStartSorter {
-	bool operator()(const agp::Record* r1, const agp::Record* r2) const {
-		return r1->getContigStart() < r2->getContigStart();
-	}
-};
-
 int main(int argc, const char* argv[]) {
 	// Increase speed of input/output to standard streams
 	std::ios::sync_with_stdio(false);
 
 	// Initialize options to defaults
 	bool compressed = false;
+	size_t numThreads = 1;
 	std::string sourceDBFilename;
 	std::string outDBFilename;
 	
@@ -48,57 +41,34 @@ int main(int argc, const char* argv[]) {
 	parser.addStoreTrueOpt('c', "compressed",
 						   "use nib compression (DNA only) for assembled DB",
 						   compressed);
+	parser.addStoreOpt('t', "threads",
+					   "number of threads for assembly (0 for one per processor)",
+					   numThreads, "NUM");
 	parser.addStoreArg("sourceDB", "", sourceDBFilename);
 	parser.addStoreArg("assembledDB", "", outDBFilename);	
 	parser.parse(argv, argv + argc);
 
 	try {
 		// Attempt to open source database
-		bio::SDB::DB sourceDB;
-		sourceDB.open(sourceDBFilename, true);
+		bio::SDB::SharedDB sourceDB;
+		sourceDB.open(sourceDBFilename);
 	
 		// Attempt to open output database
 		bio::SDB::DB outputDB;
 		outputDB.open(outDBFilename, false, true);
 
-		typedef std::vector<agp::Record*> RecList;
-		typedef std::map<std::string, RecList> ChromRecsMap;
-		ChromRecsMap chromRecs;
-		
-		// Read AGP records into map
+		// Read AGP records
+		agp::Assembler assembler;
 		agp::InputStream agpStream(std::cin);
 		agp::Record rec;
 		while (agpStream >> rec) {
-			chromRecs[rec.getChrom()].push_back(new agp::Record(rec));
+			assembler.addRecord(rec);
 		}
 		
-		// Construct each chromosome separately and insert into output DB
-		ChromRecsMap::iterator it;
-		for (it = chromRecs.begin(); it != chromRecs.end(); ++it) {
-			const std::string& chrom = it->first;
-			RecList& recs = it->second;
-			
-			// Order the AGP records by contig start coordinate
-			std::sort(recs.begin(), recs.end(), AGPContigStartSorter());
-			
-			// Determine the chrom length and make a new sequence
-			std::string chromSeq(recs.back()->getContigEnd(), 'N');
-			RecList::iterator recIt;
-			for (recIt = recs.begin(); recIt != recs.end(); ++recIt) {
-				if ((*recIt)->isGap()) {
-					continue;
-				}
-
-				std::string seq;
-				seq = sourceDB.getSeq((*recIt)->getSourceAccession(),
-									  (*recIt)->getSourceStart() - 1,
-									  (*recIt)->getSourceEnd(),
-									  (*recIt)->getSourceOrientation());
-
-				chromSeq.replace((*recIt)->getContigStart() - 1, seq.size(), seq);
-			}
-			outputDB.putRec(chrom, chromSeq, compressed);
-		}
+		// Construct each chromosome and write it to the output DB
+		agp::Assembler::SDBSource source(sourceDB);
+		agp::Assembler::SDBSink sink(outputDB, compressed);
+		assembler.assemble(source, sink, numThreads);
 	} catch (std::runtime_error& e) {
 		std::cerr << "Error: " << e.what() << '\n';
 		exit(EXIT_FAILURE);